@@ -0,0 +1,63 @@
+#include <cstdio>
+#include <cstdlib>
+
+#include "HalideBuffer.h"
+#include "halide_benchmark.h"
+#include "simd_ops_c.h"
+#include "simd_ops_native.h"
+
+using namespace Halide::Runtime;
+using namespace Halide::Tools;
+
+template<typename T>
+bool check(const char *name, const Buffer<T, 2> &native, const Buffer<T, 2> &c) {
+    for (int y = 0; y < native.height(); y++) {
+        for (int x = 0; x < native.width(); x++) {
+            if (native(x, y) != c(x, y)) {
+                printf("%s_native(%d, %d) = %d, but %s_c(%d, %d) = %d\n",
+                       name, x, y, (int)native(x, y),
+                       name, x, y, (int)c(x, y));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const int width = 1024, height = 1024;
+
+    Buffer<uint8_t, 2> a(width, height), b(width, height);
+    Buffer<int16_t, 2> c(width, height), d(width, height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            a(x, y) = (uint8_t)rand();
+            b(x, y) = (uint8_t)rand();
+            c(x, y) = (int16_t)rand();
+            d(x, y) = (int16_t)rand();
+        }
+    }
+
+    Buffer<uint8_t, 2> blend_native(width, height), blend_c(width, height);
+    Buffer<int16_t, 2> scaled_native(width, height), scaled_c(width, height);
+    Buffer<int32_t, 2> dot_native(width / 2, height), dot_c(width / 2, height);
+
+    double native_time = benchmark([&]() {
+        simd_ops_native(a, b, c, d, blend_native, scaled_native, dot_native);
+    });
+    double c_time = benchmark([&]() {
+        simd_ops_c(a, b, c, d, blend_c, scaled_c, dot_c);
+    });
+
+    if (!check("blend", blend_native, blend_c) ||
+        !check("scaled", scaled_native, scaled_c) ||
+        !check("dot", dot_native, dot_c)) {
+        return 1;
+    }
+
+    printf("LLVM backend: %f ms\n", native_time * 1e3);
+    printf("C backend:    %f ms (%.2fx)\n", c_time * 1e3, c_time / native_time);
+
+    printf("Success!\n");
+    return 0;
+}
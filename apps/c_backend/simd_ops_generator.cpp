@@ -0,0 +1,39 @@
+#include "Halide.h"
+
+namespace {
+
+// Integer ops that SSE2 and NEON have single instructions for, so that the
+// C backend's output can be compared against the LLVM backend's.
+class SimdOps : public Halide::Generator<SimdOps> {
+public:
+    Input<Buffer<uint8_t, 2>> a{"a"};
+    Input<Buffer<uint8_t, 2>> b{"b"};
+    Input<Buffer<int16_t, 2>> c{"c"};
+    Input<Buffer<int16_t, 2>> d{"d"};
+    Output<Buffer<uint8_t, 2>> blend{"blend"};
+    Output<Buffer<int16_t, 2>> scaled{"scaled"};
+    Output<Buffer<int32_t, 2>> dot{"dot"};
+
+    void generate() {
+        Var x("x"), y("y");
+
+        blend(x, y) = saturating_add(rounding_halving_add(a(x, y), b(x, y)),
+                                     saturating_sub(a(x, y), b(x, y)));
+
+        scaled(x, y) = saturating_add(mul_shift_right(c(x, y), d(x, y), 16), c(x, y));
+
+        RDom r(0, 2);
+        dot(x, y) = 0;
+        dot(x, y) += cast<int32_t>(c(2 * x + r, y)) * d(2 * x + r, y);
+
+        // Use 128-bit vectors, which the host C++ compiler can use
+        // without any extra flags on x86-64 and aarch64.
+        blend.vectorize(x, 16);
+        scaled.vectorize(x, 8);
+        dot.update().atomic().vectorize(r).vectorize(x, 4);
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(SimdOps, simd_ops)
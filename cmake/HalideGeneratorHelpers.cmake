@@ -2,6 +2,11 @@ cmake_minimum_required(VERSION 3.28)
 
 option(Halide_NO_DEFAULT_FLAGS "When enabled, suppresses recommended flags in add_halide_generator" OFF)
 
+set(Halide_GENERATOR_CACHE_DIR "" CACHE PATH
+    "When set, generators reuse identical earlier outputs from this directory (HL_GENERATOR_CACHE_DIR)")
+set(Halide_GENERATOR_CACHE_SIZE "" CACHE STRING
+    "Maximum size in megabytes of Halide_GENERATOR_CACHE_DIR (HL_GENERATOR_CACHE_SIZE)")
+
 include(${CMAKE_CURRENT_LIST_DIR}/HalideTargetHelpers.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/TargetExportScript.cmake)
 
@@ -400,9 +405,21 @@ function(_Halide_compute_generator_cmd)
         set(ARG_FROM "${FQ_ARG_FROM}")
     endif ()
 
+    set(cache_env "")
+    if (Halide_GENERATOR_CACHE_DIR)
+        list(APPEND cache_env "HL_GENERATOR_CACHE_DIR=${Halide_GENERATOR_CACHE_DIR}")
+        if (Halide_GENERATOR_CACHE_SIZE)
+            list(APPEND cache_env "HL_GENERATOR_CACHE_SIZE=${Halide_GENERATOR_CACHE_SIZE}")
+        endif ()
+    endif ()
+
     get_property(py_src TARGET "${ARG_FROM}" PROPERTY Halide_PYTHON_GENERATOR_SOURCE)
     if (NOT py_src)
-        set("${ARG_OUT_COMMAND}" "${ARG_FROM}" PARENT_SCOPE)
+        if (cache_env)
+            set("${ARG_OUT_COMMAND}" ${CMAKE_COMMAND} -E env ${cache_env} -- "$<TARGET_FILE:${ARG_FROM}>" PARENT_SCOPE)
+        else ()
+            set("${ARG_OUT_COMMAND}" "${ARG_FROM}" PARENT_SCOPE)
+        endif ()
         set("${ARG_OUT_DEPENDS}" "${ARG_FROM}" PARENT_SCOPE)
         return()
     endif ()
@@ -418,7 +435,7 @@ function(_Halide_compute_generator_cmd)
     endif ()
 
     set("${ARG_OUT_COMMAND}"
-        ${CMAKE_COMMAND} -E env "PYTHONPATH=$<PATH:NORMAL_PATH,$<TARGET_FILE_DIR:Halide::Python>/..>" --
+        ${CMAKE_COMMAND} -E env "PYTHONPATH=$<PATH:NORMAL_PATH,$<TARGET_FILE_DIR:Halide::Python>/..>" ${cache_env} --
         ${Halide_PYTHON_LAUNCHER} "$<TARGET_FILE:Python::Interpreter>" $<SHELL_PATH:${py_src}>
         PARENT_SCOPE)
     set("${ARG_OUT_DEPENDS}" ${ARG_FROM} Halide::Python ${py_src} PARENT_SCOPE)
@@ -40,6 +40,11 @@ void define_enums(py::module &m) {
         .value("NoAlign", LoopAlignStrategy::NoAlign)
         .value("Auto", LoopAlignStrategy::Auto);
 
+    py::enum_<FuseOrder>(m, "FuseOrder")
+        .value("Lexicographic", FuseOrder::Lexicographic)
+        .value("Morton", FuseOrder::Morton)
+        .value("Hilbert", FuseOrder::Hilbert);
+
     py::enum_<MemoryType>(m, "MemoryType")
         .value("Auto", MemoryType::Auto)
         .value("Heap", MemoryType::Heap)
@@ -208,6 +213,13 @@ void define_enums(py::module &m) {
         .value("Semihosting", Target::Feature::Semihosting)
         .value("AVX10_1", Target::Feature::AVX10_1)
         .value("X86APX", Target::Feature::X86APX)
+        .value("ArenaAllocations", Target::Feature::ArenaAllocations)
+        .value("Workspace", Target::Feature::Workspace)
+        .value("LazyJIT", Target::Feature::LazyJIT)
+        .value("AlignedFastPath", Target::Feature::AlignedFastPath)
+        .value("WidenFloat16Math", Target::Feature::WidenFloat16Math)
+        .value("ProfileTimeline", Target::Feature::ProfileTimeline)
+        .value("ProfileMemoryTraffic", Target::Feature::ProfileMemoryTraffic)
         .value("FeatureEnd", Target::Feature::FeatureEnd);
 
     py::enum_<halide_type_code_t>(m, "TypeCode")
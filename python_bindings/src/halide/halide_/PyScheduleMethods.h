@@ -31,7 +31,7 @@ HALIDE_NEVER_INLINE void add_schedule_methods(PythonClass &class_instance) {
              py::arg("old"), py::arg("outer"), py::arg("inner"), py::arg("factor"), py::arg("tail") = TailStrategy::Auto)
 
         .def("fuse", &T::fuse,
-             py::arg("inner"), py::arg("outer"), py::arg("fused"))
+             py::arg("inner"), py::arg("outer"), py::arg("fused"), py::arg("order") = FuseOrder::Lexicographic)
 
         .def("partition", (T & (T::*)(const VarOrRVar &var, Partition partition_policy)) & T::partition,
              py::arg("var"), py::arg("partition_policy"))
@@ -18,6 +18,8 @@ void define_stage(py::module &m) {
                  py::arg("preserved"))
             .def("rfactor", (Func(Stage::*)(const RVar &, const Var &))&Stage::rfactor,
                  py::arg("r"), py::arg("v"))
+            .def("privatize", &Stage::privatize,
+                 py::arg("r"), py::arg("num_tasks"), py::arg("vector_width") = 1)
 
             .def("unscheduled", &Stage::unscheduled);
 
@@ -0,0 +1,207 @@
+#include "AddAlignedFastPath.h"
+#include "Debug.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Substitute.h"
+#include "Target.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+
+namespace {
+
+// Pipelines bigger than this many IR nodes are not duplicated.
+const int max_fast_path_nodes = 100000;
+
+class FindBufferUses : public IRVisitor {
+    using IRVisitor::visit;
+
+    bool in_device_loop = false;
+
+    void visit_param(const Parameter &param) {
+        if (!param.defined() || !param.is_buffer()) {
+            return;
+        }
+        if (in_device_loop) {
+            device_params.insert(param.name());
+        } else {
+            host_params.emplace(param.name(), param);
+        }
+    }
+
+    void visit(const For *op) override {
+        ScopedValue<bool> old_in_device_loop(in_device_loop,
+                                             in_device_loop ||
+                                                 (op->device_api != DeviceAPI::None &&
+                                                  op->device_api != DeviceAPI::Host));
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Load *op) override {
+        visit_param(op->param);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Store *op) override {
+        visit_param(op->param);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Variable *op) override {
+        vars.insert(op->name);
+    }
+
+public:
+    map<string, Parameter> host_params;
+    set<string> device_params;
+    set<string> vars;
+};
+
+// Count the distinct IR nodes, as a proxy for code size.
+class CountNodes : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void include(const Expr &e) override {
+        nodes.insert(e.get());
+        IRGraphVisitor::include(e);
+    }
+
+    void include(const Stmt &s) override {
+        nodes.insert(s.get());
+        IRGraphVisitor::include(s);
+    }
+
+public:
+    set<const IRNode *> nodes;
+};
+
+// Point the loads and stores of the fast path at copies of the
+// buffer parameters with a larger host alignment, which is what
+// codegen consults to pick the alignment of vector loads and stores.
+class UseAlignedParams : public IRMutator {
+    using IRMutator::visit;
+
+    const map<string, Parameter> &aligned;
+
+    const Parameter &replacement(const Parameter &p) const {
+        if (p.defined()) {
+            auto it = aligned.find(p.name());
+            if (it != aligned.end()) {
+                return it->second;
+            }
+        }
+        return p;
+    }
+
+    Expr visit(const Load *op) override {
+        Expr predicate = mutate(op->predicate);
+        Expr index = mutate(op->index);
+        return Load::make(op->type, op->name, index, op->image,
+                          replacement(op->param), predicate, op->alignment);
+    }
+
+    Stmt visit(const Store *op) override {
+        Expr predicate = mutate(op->predicate);
+        Expr value = mutate(op->value);
+        Expr index = mutate(op->index);
+        return Store::make(op->name, value, index, replacement(op->param),
+                           predicate, op->alignment);
+    }
+
+public:
+    UseAlignedParams(const map<string, Parameter> &aligned)
+        : aligned(aligned) {
+    }
+};
+
+}  // namespace
+
+Stmt add_aligned_fast_path(const Stmt &s, const Target &t) {
+    CountNodes counter;
+    s.accept(&counter);
+    if ((int)counter.nodes.size() > max_fast_path_nodes) {
+        debug(1) << "Not adding an aligned fast path, because the pipeline has "
+                 << counter.nodes.size() << " IR nodes\n";
+        return s;
+    }
+
+    FindBufferUses uses;
+    s.accept(&uses);
+
+    const int vector_bytes = t.natural_vector_size(UInt(8));
+
+    Expr condition;
+    map<string, Expr> replacements;
+    map<string, Parameter> aligned;
+    for (const auto &[name, param] : uses.host_params) {
+        if (uses.device_params.count(name)) {
+            // The buffer is also accessed from device code, and the
+            // host alignment says nothing about the device allocation.
+            continue;
+        }
+
+        const int elem_bytes = param.type().bytes();
+        if (vector_bytes % elem_bytes) {
+            continue;
+        }
+        const int lanes = vector_bytes / elem_bytes;
+
+        auto add_check = [&](const Expr &c) {
+            condition = condition.defined() ? (condition && c) : c;
+        };
+
+        if (param.host_alignment() < vector_bytes) {
+            Expr host = Variable::make(Handle(), name, param);
+            add_check((reinterpret<uint64_t>(host) % vector_bytes) == 0);
+            Parameter p(param.type(), true, param.dimensions(), name);
+            p.set_host_alignment(vector_bytes);
+            for (int i = 0; i < param.dimensions(); i++) {
+                p.set_min_constraint(i, param.min_constraint(i));
+                p.set_extent_constraint(i, param.extent_constraint(i));
+                p.set_stride_constraint(i, param.stride_constraint(i));
+            }
+            aligned.emplace(name, p);
+        }
+
+        // The constraints have already been substituted into the
+        // pipeline, so any of these that still appear are free.
+        for (int i = 0; i < param.dimensions(); i++) {
+            string stride_name = name + ".stride." + std::to_string(i);
+            string min_name = name + ".min." + std::to_string(i);
+            Expr stride = Variable::make(Int(32), stride_name, param);
+            Expr min = Variable::make(Int(32), min_name, param);
+            if (uses.vars.count(stride_name)) {
+                if (i == 0) {
+                    add_check(stride == 1);
+                    replacements[stride_name] = 1;
+                } else if (lanes > 1) {
+                    add_check(stride % lanes == 0);
+                    replacements[stride_name] = (stride / lanes) * lanes;
+                }
+            }
+            if (i == 0 && lanes > 1 && uses.vars.count(min_name)) {
+                add_check(min % lanes == 0);
+                replacements[min_name] = (min / lanes) * lanes;
+            }
+        }
+    }
+
+    if (!condition.defined()) {
+        return s;
+    }
+
+    debug(2) << "Adding aligned fast path with condition: " << condition << "\n";
+
+    Stmt fast = substitute(replacements, s);
+    fast = UseAlignedParams(aligned).mutate(fast);
+    return IfThenElse::make(condition, fast, s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
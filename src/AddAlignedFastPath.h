@@ -0,0 +1,32 @@
+#ifndef HALIDE_ADD_ALIGNED_FAST_PATH_H
+#define HALIDE_ADD_ALIGNED_FAST_PATH_H
+
+/** \file
+ * Defines the lowering pass that specializes a pipeline for dense,
+ * vector-aligned buffer arguments.
+ */
+
+#include "Expr.h"
+
+namespace Halide {
+
+struct Target;
+
+namespace Internal {
+
+/** Duplicate the pipeline into a fast path and the generic path, and
+ * dispatch between them at entry. The fast path assumes that every
+ * buffer argument accessed on the host has a dense innermost
+ * dimension, a host pointer aligned to the native vector width, and a
+ * min coordinate and outer strides that are multiples of the vector
+ * width, so loads and stores of whole vectors can be aligned. Only the
+ * assumptions that the buffer constraints don't already guarantee are
+ * checked. The pipeline is left alone if it is larger than a fixed
+ * budget, to bound the growth in code size. Must run after storage
+ * flattening and before the buffer arguments are unpacked. */
+Stmt add_aligned_fast_path(const Stmt &s, const Target &t);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -3,14 +3,86 @@
 #include "IROperator.h"
 #include "Simplify.h"
 #include "Substitute.h"
+#include "Util.h"
 
 namespace Halide {
 namespace Internal {
 
 using std::map;
+using std::pair;
 using std::string;
 using std::vector;
 
+namespace {
+
+// The largest block a space-filling curve fuse can be laid out over
+// has a side of 2^15, because the fused extent, which is at least the
+// square of the side, must fit in an int32.
+const int max_curve_levels = 15;
+
+// Binds the intermediate values of a curve decoding to names, so that
+// values that are used more than once don't make the expression grow
+// exponentially.
+class CurveLets {
+    vector<pair<string, Expr>> lets;
+
+public:
+    Expr bind(const Expr &e) {
+        string name = unique_name('t');
+        lets.emplace_back(name, e);
+        return Variable::make(e.type(), name);
+    }
+
+    Expr wrap(Expr e) const {
+        for (auto it = lets.rbegin(); it != lets.rend(); it++) {
+            e = Let::make(it->first, it->second, e);
+        }
+        return e;
+    }
+};
+
+// Gather the even bits of v into its low half.
+Expr compact_even_bits(Expr v, CurveLets &lets) {
+    v = lets.bind(v & 0x55555555);
+    v = lets.bind((v | (v >> 1)) & 0x33333333);
+    v = lets.bind((v | (v >> 2)) & 0x0f0f0f0f);
+    v = lets.bind((v | (v >> 4)) & 0x00ff00ff);
+    return (v | (v >> 8)) & 0x0000ffff;
+}
+
+// Decode a position along a space-filling curve over a square of side
+// 2^max_curve_levels into the two coordinates of the square, packed
+// into one int as x + (y << 16).
+Expr decode_curve(FuseOrder order, const Expr &d) {
+    CurveLets lets;
+    Expr x, y;
+    if (order == FuseOrder::Morton) {
+        x = lets.bind(compact_even_bits(d, lets));
+        y = lets.bind(compact_even_bits(d >> 1, lets));
+    } else {
+        internal_assert(order == FuseOrder::Hilbert);
+        // The iterative form of the classic Hilbert curve decoding,
+        // unrolled. Levels past the top bit of d only transpose the
+        // result, which is still a Hilbert curve over the square.
+        x = 0;
+        y = 0;
+        for (int level = 0; level < max_curve_levels; level++) {
+            int side = 1 << level;
+            Expr t = lets.bind(d >> (2 * level));
+            Expr rx = lets.bind((t >> 1) & 1);
+            Expr ry = lets.bind((t ^ rx) & 1);
+            Expr flip = rx == 1 && ry == 0;
+            Expr fx = lets.bind(select(flip, side - 1 - x, x));
+            Expr fy = lets.bind(select(flip, side - 1 - y, y));
+            x = lets.bind(select(ry == 0, fy, fx) + rx * side);
+            y = lets.bind(select(ry == 0, fx, fy) + ry * side);
+        }
+    }
+    return lets.wrap(x + (y << 16));
+}
+
+}  // namespace
+
 vector<ApplySplitResult> apply_split(const Split &split, const string &prefix,
                                      map<string, Expr> &dim_extent_alignment) {
     vector<ApplySplitResult> result;
@@ -138,6 +210,53 @@ vector<ApplySplitResult> apply_split(const Split &split, const string &prefix,
         Expr outer_min = Variable::make(Int(32), prefix + split.outer + ".loop_min");
         Expr inner_extent = Variable::make(Int(32), prefix + split.inner + ".loop_extent");
 
+        if (split.fuse_order != FuseOrder::Lexicographic) {
+            // The fused dimension walks a sequence of square blocks
+            // along the longer of the two dimensions, and walks a
+            // space-filling curve within each block. The low bits of
+            // the fused var are the position along the curve, and the
+            // high bits are the block.
+            Expr inner_max = Variable::make(Int(32), prefix + split.inner + ".loop_max");
+            Expr outer_max = Variable::make(Int(32), prefix + split.outer + ".loop_max");
+            Expr outer_extent = Variable::make(Int(32), prefix + split.outer + ".loop_extent");
+            Expr bits = Variable::make(Int(32), prefix + split.old_var + ".curve_bits");
+
+            string curve_name = prefix + split.old_var + ".curve";
+            Expr curve = Variable::make(Int(32), curve_name);
+            Expr position = fused & ((1 << (bits * 2)) - 1);
+            Expr block = (fused >> (bits * 2)) << bits;
+
+            Expr a = curve & 0xffff, b = curve >> 16;
+            Expr blocks_along_outer = inner_extent <= outer_extent;
+            Expr inner_offset = select(blocks_along_outer, a, a + block);
+            Expr outer_offset = select(blocks_along_outer, b + block, b);
+
+            string inner_offset_name = prefix + split.inner + ".curve_offset";
+            string outer_offset_name = prefix + split.outer + ".curve_offset";
+            Expr inner_offset_var = Variable::make(Int(32), inner_offset_name);
+            Expr outer_offset_var = Variable::make(Int(32), outer_offset_name);
+
+            // The padding of the blocks out to a power of two is
+            // skipped, so tell bounds inference the coordinates stay
+            // within the original loop bounds.
+            Expr inner = promise_clamped(inner_offset_var + inner_min, inner_min, inner_max);
+            Expr outer = promise_clamped(outer_offset_var + outer_min, outer_min, outer_max);
+
+            result.emplace_back(prefix + split.inner, inner, ApplySplitResult::Substitution);
+            result.emplace_back(prefix + split.outer, outer, ApplySplitResult::Substitution);
+            result.emplace_back(prefix + split.inner, inner, ApplySplitResult::LetStmt);
+            result.emplace_back(prefix + split.outer, outer, ApplySplitResult::LetStmt);
+            result.emplace_back(likely(inner_offset_var < inner_extent &&
+                                       outer_offset_var < outer_extent),
+                                ApplySplitResult::Predicate);
+            result.emplace_back(inner_offset_name, inner_offset, ApplySplitResult::LetStmt);
+            result.emplace_back(outer_offset_name, outer_offset, ApplySplitResult::LetStmt);
+            result.emplace_back(curve_name, decode_curve(split.fuse_order, position), ApplySplitResult::LetStmt);
+            // The fused extent is padded, so nothing is known about
+            // its alignment.
+            break;
+        }
+
         const Expr &factor = inner_extent;
         Expr inner = fused % factor + inner_min;
         Expr outer = fused / factor + outer_min;
@@ -188,6 +307,32 @@ vector<std::pair<string, Expr>> compute_loop_bounds_after_split(const Split &spl
         Expr inner_extent = Variable::make(Int(32), prefix + split.inner + ".loop_extent");
         Expr outer_extent = Variable::make(Int(32), prefix + split.outer + ".loop_extent");
         Expr fused_extent = inner_extent * outer_extent;
+        if (split.fuse_order != FuseOrder::Lexicographic) {
+            // Cover the domain with square blocks whose side is the
+            // smaller of the two extents rounded up to a power of two.
+            Expr bits = Variable::make(Int(32), prefix + split.old_var + ".curve_bits");
+            Expr side = max(min(inner_extent, outer_extent), 1);
+            // Clamp the shifts so that they stay well-defined even when
+            // the check below fails.
+            Expr safe_bits = min(bits, max_curve_levels);
+            Expr num_blocks = (max(inner_extent, outer_extent) + (1 << safe_bits) - 1) >> safe_bits;
+            // The curve can't address blocks larger than
+            // 2^max_curve_levels on a side, and the padded extent of
+            // the fused loop must fit in an int32.
+            Expr fits = (bits <= max_curve_levels &&
+                         num_blocks <= (make_const(Int(32), 0x7fffffff) >> (safe_bits * 2)));
+            fused_extent = require(fits, num_blocks << (safe_bits * 2),
+                                   "The loops fused into", split.old_var,
+                                   "with a space-filling curve are too large. The smaller extent must be at most",
+                                   1 << max_curve_levels, "and the padded fused extent must fit in an int32.");
+            Expr fused_extent_var = Variable::make(Int(32), prefix + split.old_var + ".loop_extent");
+            let_stmts.emplace_back(prefix + split.old_var + ".loop_min", 0);
+            let_stmts.emplace_back(prefix + split.old_var + ".loop_max", fused_extent_var - 1);
+            let_stmts.emplace_back(prefix + split.old_var + ".loop_extent", fused_extent);
+            let_stmts.emplace_back(prefix + split.old_var + ".curve_bits",
+                                   32 - count_leading_zeros(side - 1));
+            break;
+        }
         let_stmts.emplace_back(prefix + split.old_var + ".loop_min", 0);
         let_stmts.emplace_back(prefix + split.old_var + ".loop_max", fused_extent - 1);
         let_stmts.emplace_back(prefix + split.old_var + ".loop_extent", fused_extent);
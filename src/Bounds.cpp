@@ -2329,6 +2329,109 @@ private:
     bool in_producer{false}, in_unreachable{false};
     map<std::string, Expr> buffer_lets;
 
+    // Inlined Exprs often call the same Func at the same coordinates
+    // many times over, in nodes that aren't shared. We memoize the box
+    // each call touches, keyed on the call and on the bounds in scope of
+    // the variables its args use, so lets and loops that rebind those
+    // variables only invalidate the calls that depend on them. Repeated
+    // calls get back identical Exprs, which merge_boxes handles without
+    // simplifying, and we don't merge a box again at all if nothing else
+    // has changed the box of that Func since we last merged it.
+    struct CachedCallBox {
+        vector<Expr> scope_bounds;
+        Box box;
+        int id;
+    };
+    map<Expr, vector<CachedCallBox>, IRGraphDeepCompare> call_boxes;
+    int next_call_box_id = 0;
+
+    struct MergedCallBoxes {
+        // The box of the Func after the last merge of a cached box.
+        vector<Expr> state;
+        // The cached boxes merged into it since it last changed otherwise.
+        set<int> ids;
+    };
+    map<string, MergedCallBoxes> merged_call_boxes;
+
+    vector<Expr> scope_bounds_of_args(const Call *op) {
+        class CollectVarNames : public IRGraphVisitor {
+            using IRGraphVisitor::visit;
+            void visit(const Variable *op) override {
+                names.insert(op->name);
+            }
+
+        public:
+            set<string> names;
+        } collect;
+        for (const Expr &e : op->args) {
+            e.accept(&collect);
+        }
+        vector<Expr> result;
+        for (const string &name : collect.names) {
+            if (const Interval *in = scope.find(name)) {
+                result.push_back(in->min);
+                result.push_back(in->max);
+            } else {
+                result.emplace_back();
+                result.emplace_back();
+            }
+        }
+        return result;
+    }
+
+    static vector<Expr> box_state(const Box &b) {
+        vector<Expr> result{b.used};
+        for (const Interval &i : b.bounds) {
+            result.push_back(i.min);
+            result.push_back(i.max);
+        }
+        return result;
+    }
+
+    static bool all_same(const vector<Expr> &a, const vector<Expr> &b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (!a[i].same_as(b[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void merge_call_box(const Call *op) {
+        vector<Expr> scope_bounds = scope_bounds_of_args(op);
+        vector<CachedCallBox> &cached = call_boxes[op];
+        const CachedCallBox *entry = nullptr;
+        for (const CachedCallBox &c : cached) {
+            if (all_same(c.scope_bounds, scope_bounds)) {
+                entry = &c;
+                break;
+            }
+        }
+        if (!entry) {
+            Box b(op->args.size());
+            b.used = const_true();
+            for (size_t i = 0; i < op->args.size(); i++) {
+                b[i] = bounds_of_expr_in_scope(op->args[i], scope, func_bounds);
+            }
+            cached.push_back({std::move(scope_bounds), std::move(b), next_call_box_id++});
+            entry = &cached.back();
+        }
+
+        Box &box = boxes[op->name];
+        MergedCallBoxes &merged = merged_call_boxes[op->name];
+        if (!all_same(merged.state, box_state(box))) {
+            merged.ids.clear();
+        } else if (merged.ids.count(entry->id)) {
+            return;
+        }
+        merge_boxes(box, entry->box);
+        merged.ids.insert(entry->id);
+        merged.state = box_state(box);
+    }
+
     using IRGraphVisitor::visit;
 
     bool box_from_extended_crop(const Expr &e, Box &b) {
@@ -2412,12 +2515,7 @@ private:
                     e.accept(this);
                 }
                 if (op->name == func || func.empty()) {
-                    Box b(op->args.size());
-                    b.used = const_true();
-                    for (size_t i = 0; i < op->args.size(); i++) {
-                        b[i] = bounds_of_expr_in_scope(op->args[i], scope, func_bounds);
-                    }
-                    merge_boxes(boxes[op->name], b);
+                    merge_call_box(op);
                 }
             }
         }
@@ -3602,6 +3700,19 @@ void boxes_touched_test() {
                            << "Should have been: " << correct.max << "\n";
         }
     }
+
+    // Repeated calls to the same Func at the same coordinates share a
+    // cached box, but only while the variables they use keep the same
+    // bounds. Rebinding x must give the second call a different box.
+    Expr f_x = Call::make(t, "f", {x + 1}, Call::Halide);
+    Expr g = f_x + Let::make("x", x * 2, Call::make(t, "f", {x + 1}, Call::Halide)) + f_x;
+    scope.push("x", Interval(Expr(0), Expr(10)));
+    Box g_box = box_required(g, "f", scope);
+    scope.pop("x");
+    internal_assert(g_box.size() == 1 &&
+                    equal(simplify(g_box[0].min), Expr(1)) &&
+                    equal(simplify(g_box[0].max), Expr(21)))
+        << "Incorrect box required of f: " << g_box << "\n";
 }
 
 }  // anonymous namespace
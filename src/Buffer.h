@@ -6,6 +6,8 @@
 #include "IntrusivePtr.h"
 #include "runtime/HalideBuffer.h"
 
+#include <memory>
+
 namespace Halide {
 
 constexpr int AnyDims = Halide::Runtime::AnyDims;  // -1
@@ -21,6 +23,8 @@ struct BufferContents {
     mutable RefCount ref_count;
     std::string name;
     Runtime::Buffer<> buf;
+    // Whatever owns the host memory, if buf just wraps it. See Buffer::set_host_owner.
+    std::shared_ptr<void> host_owner;
 };
 
 Expr buffer_accessor(const Buffer<> &buf, const std::vector<Expr> &args);
@@ -382,6 +386,16 @@ public:
         return contents.defined();
     }
 
+    /** Keep the given object alive for as long as this Buffer, for
+     * Buffers that wrap host memory owned by something else, such as a
+     * memory-mapped file. Copies of this Buffer (including the handles
+     * held by Funcs and compiled pipelines that use it) share it, but
+     * Runtime::Buffers made from it with cropped(), sliced(), etc. do
+     * not. */
+    void set_host_owner(std::shared_ptr<void> owner) {
+        contents->host_owner = std::move(owner);
+    }
+
     /** Get a pointer to the underlying Runtime::Buffer */
     // @{
     Runtime::Buffer<T, Dims> *get() {
@@ -1,4 +1,6 @@
+#include <cmath>
 #include <map>
+#include <unordered_map>
 
 #include "CSE.h"
 #include "IREquality.h"
@@ -68,6 +70,89 @@ bool should_extract(const Expr &e, bool lift_all) {
     return true;
 }
 
+// Hashes an Expr using its own fields and the identities of its
+// children. Within a global value numbering, children are in canonical
+// form, so two children are structurally equal exactly when they are the
+// same node. This makes the hash structural without recursing into the
+// children. It only considers fields that graph_equal considers.
+class ShallowHash : public IRGraphVisitor {
+    size_t h = 0;
+
+    void mix(size_t x) {
+        h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+
+    using IRGraphVisitor::visit;
+
+    void include(const Expr &e) override {
+        mix(std::hash<const IRNode *>()(e.get()));
+    }
+
+    void visit(const IntImm *op) override {
+        mix(std::hash<int64_t>()(op->value));
+    }
+
+    void visit(const UIntImm *op) override {
+        mix(std::hash<uint64_t>()(op->value));
+    }
+
+    void visit(const FloatImm *op) override {
+        // graph_equal treats all NaNs as equal, and -0 as equal to 0.
+        if (std::isnan(op->value)) {
+            mix(1);
+        } else if (op->value != 0) {
+            mix(std::hash<double>()(op->value));
+        }
+    }
+
+    void visit(const StringImm *op) override {
+        mix(std::hash<string>()(op->value));
+    }
+
+    void visit(const Variable *op) override {
+        mix(std::hash<string>()(op->name));
+    }
+
+    void visit(const Load *op) override {
+        mix(std::hash<string>()(op->name));
+        mix(std::hash<int64_t>()(op->alignment.modulus));
+        mix(std::hash<int64_t>()(op->alignment.remainder));
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Call *op) override {
+        mix(std::hash<string>()(op->name));
+        mix((size_t)op->call_type);
+        mix((size_t)op->value_index);
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Let *op) override {
+        mix(std::hash<string>()(op->name));
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Shuffle *op) override {
+        for (int i : op->indices) {
+            mix((size_t)i);
+        }
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const VectorReduce *op) override {
+        mix((size_t)op->op);
+        IRGraphVisitor::visit(op);
+    }
+
+public:
+    size_t operator()(const Expr &e) {
+        h = (size_t)e->node_type;
+        mix(((halide_type_t)e.type()).as_u32());
+        e.accept(this);
+        return h;
+    }
+};
+
 // A global-value-numbering of expressions. Returns canonical form of
 // the Expr and writes out a global value numbering as a side-effect.
 class GVN : public IRMutator {
@@ -75,16 +160,45 @@ public:
     struct Entry {
         Expr expr;
         int use_count = 0;
-        // All consumer Exprs for which this is the last child Expr.
-        map<Expr, int, IRGraphDeepCompare> uses;
         Entry(const Expr &e)
             : expr(e) {
         }
     };
     vector<std::unique_ptr<Entry>> entries;
 
-    map<Expr, int, ExprCompare> shallow_numbering, output_numbering;
-    map<Expr, int, IRGraphDeepCompare> leaves;
+    struct PointerHash {
+        size_t operator()(const Expr &e) const {
+            return std::hash<const IRNode *>()(e.get());
+        }
+    };
+
+    struct PointerEqual {
+        bool operator()(const Expr &a, const Expr &b) const {
+            return a.same_as(b);
+        }
+    };
+
+    std::unordered_map<Expr, int, PointerHash, PointerEqual> shallow_numbering, output_numbering;
+
+    // Canonical Exprs, keyed by structure. The keys all have canonical
+    // children, so their hashes are cheap to compute, and nodes that
+    // hash equally almost always are equal, and compare equal after
+    // looking only at their own fields.
+    struct StructuralHash {
+        size_t operator()(const std::pair<size_t, Expr> &p) const {
+            return p.first;
+        }
+    };
+
+    struct StructuralEqual {
+        bool operator()(const std::pair<size_t, Expr> &a, const std::pair<size_t, Expr> &b) const {
+            return a.first == b.first && graph_equal(a.second, b.second);
+        }
+    };
+
+    std::unordered_map<std::pair<size_t, Expr>, int, StructuralHash, StructuralEqual> numbering;
+
+    ShallowHash shallow_hash;
 
     int number = 0;
 
@@ -105,24 +219,19 @@ public:
 
         // We haven't seen this exact Expr before. Rebuild it using
         // things already in the numbering.
-        number = -1;
         Expr new_e = IRMutator::mutate(e);
 
-        // 'number' is now set to the numbering for the last child of
-        // this Expr (or -1 if there are no children). Next we see if
-        // that child has an identical parent to this one.
-
-        auto &use_map = number == -1 ? leaves : entries[number]->uses;
-        auto p = use_map.emplace(new_e, (int)entries.size());
+        // All the children of new_e are now canonical, so we can look
+        // it up by its shallow hash.
+        auto p = numbering.emplace(std::make_pair(shallow_hash(new_e), new_e), (int)entries.size());
         auto iter = p.first;
         bool novel = p.second;
         if (novel) {
             // This is a never-before-seen Expr
             number = (int)entries.size();
-            iter->second = number;
             entries.emplace_back(new Entry(new_e));
         } else {
-            // This child already has a syntactically-equal parent
+            // We already have a syntactically-equal Expr
             number = iter->second;
             new_e = entries[number]->expr;
         }
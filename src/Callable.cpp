@@ -1,4 +1,5 @@
 #include <map>
+#include <vector>
 
 #include "Argument.h"
 #include "Callable.h"
@@ -214,4 +215,152 @@ int Callable::call_argv_checked(size_t argc, const void *const *argv, const Quic
     return call_argv_fast(argc, argv);
 }
 
+namespace {
+
+struct BatchClosure {
+    JITCache *jit_cache;
+    const void *const *const *argvs;
+    int *exit_statuses;
+};
+
+int batch_task(JITUserContext *context, int idx, uint8_t *closure) {
+    const BatchClosure *c = (const BatchClosure *)closure;
+    c->exit_statuses[idx] = c->jit_cache->call_jit_code(c->argvs[idx]);
+    // Always report success to the thread pool, so that one failing
+    // entry doesn't cancel the rest of the batch.
+    return 0;
+}
+
+}  // namespace
+
+Callable::FailureFn Callable::check_batch_qcci(size_t argc, const QuickCallCheckInfo *actual_qcci) const {
+    user_assert(defined()) << "Cannot call_batch() a default-constructed Callable.";
+    return check_qcci(argc, actual_qcci);
+}
+
+Callable::FailureFn Callable::check_bound_args(size_t argc, const void *const *argv, const QuickCallCheckInfo *actual_qcci) const {
+    user_assert(defined()) << "Cannot bind() a default-constructed Callable.";
+
+    FailureFn failure_fn = check_qcci(argc, actual_qcci);
+    if (!failure_fn) {
+        // Since the buffers are fixed from here on, we can afford a full
+        // check of their types and dimensionality up front.
+        const auto &args = contents->jit_cache.arguments;
+        for (size_t i = 0; i < argc; i++) {
+            const halide_buffer_t *buf = (const halide_buffer_t *)argv[i];
+            if (!args[i].is_buffer() || buf == nullptr) {
+                continue;
+            }
+            if (buf->type != (halide_type_t)args[i].type || buf->dimensions != args[i].dimensions) {
+                failure_fn = do_check_fail(i, argc, "binding");
+                break;
+            }
+        }
+    }
+    if (failure_fn) {
+        // Report the failure now, rather than waiting until the first call.
+        JITUserContext *context = *(JITUserContext **)const_cast<void *>(argv[0]);
+        (void)failure_fn(context);
+    }
+    return failure_fn;
+}
+
+const JITHandlers &Callable::saved_jit_handlers() const {
+    user_assert(defined()) << "Cannot bind() a default-constructed Callable.";
+    return contents->saved_jit_handlers;
+}
+
+int Callable::call_argv_prebound(const void *const *argv, JITFuncCallContext *call_context) const {
+    // Anything left over from a previous failing call has already been reported.
+    call_context->error_buffer.end = 0;
+
+    int exit_status = contents->jit_cache.call_jit_code(argv);
+
+    // If we're profiling, report runtimes and reset profiler stats.
+    contents->jit_cache.finish_profiling(call_context->context);
+
+    call_context->finalize(exit_status);
+
+    return exit_status;
+}
+
+halide_workspace_t *Callable::create_workspace(JITUserContext *context, uint64_t initial_bytes) const {
+    user_assert(defined()) << "Cannot create a workspace for a default-constructed Callable.";
+    user_assert(contents->jit_cache.jit_target.has_feature(Target::Workspace))
+        << "Cannot create a workspace for '" << contents->name
+        << "' because it was not compiled with Target::Workspace.\n";
+    user_assert(context != nullptr) << "Workspaces require a JITUserContext.\n";
+    // Memory for the workspace must come from the same handlers as
+    // the calls that use it.
+    JITSharedRuntime::populate_jit_handlers(context, contents->saved_jit_handlers);
+    halide_workspace_t *workspace = JITSharedRuntime::workspace_create(context, contents->name, initial_bytes);
+    user_assert(workspace != nullptr)
+        << "Failed to allocate a workspace of " << initial_bytes << " bytes for '" << contents->name << "'\n";
+    return workspace;
+}
+
+void Callable::destroy_workspace(JITUserContext *context, halide_workspace_t *workspace) const {
+    user_assert(defined()) << "Cannot destroy a workspace for a default-constructed Callable.";
+    JITSharedRuntime::populate_jit_handlers(context, contents->saved_jit_handlers);
+    JITSharedRuntime::workspace_destroy(context, workspace);
+}
+
+uint64_t Callable::workspace_high_water_mark(const halide_workspace_t *workspace) {
+    return JITSharedRuntime::workspace_high_water_mark(workspace);
+}
+
+int Callable::call_argv_batch(size_t argc, size_t batch_size,
+                              const void *const *const *argvs, int *exit_statuses) const {
+    user_assert(defined()) << "Cannot call_batch() a default-constructed Callable.";
+    if (batch_size == 0) {
+        return 0;
+    }
+    assert(contents->jit_cache.jit_target.has_feature(Target::UserContext));
+    assert(contents->jit_cache.arguments[0].name == "__user_context");
+    assert(argc == contents->jit_cache.arguments.size());
+
+    JITUserContext *context = *(JITUserContext **)const_cast<void *>(argvs[0][0]);
+    assert(context != nullptr);
+    for (size_t i = 1; i < batch_size; i++) {
+        user_assert(*(JITUserContext **)const_cast<void *>(argvs[i][0]) == context)
+            << "All entries in a batch passed to '" << contents->name << "' must use the same JITUserContext.\n";
+    }
+
+    // The context is shared by every call in the batch, so the handlers
+    // only need to be set up once. The error buffer is safe to append to
+    // concurrently, which a single multithreaded call relies on anyway.
+    JITFuncCallContext jit_call_context(context, contents->saved_jit_handlers);
+
+    std::vector<int> local_exit_statuses;
+    if (!exit_statuses) {
+        local_exit_statuses.resize(batch_size);
+        exit_statuses = local_exit_statuses.data();
+    }
+
+    BatchClosure closure{&contents->jit_cache, argvs, exit_statuses};
+    if (contents->jit_cache.jit_target.arch == Target::WebAssembly) {
+        // The wasm executor is not safe to reenter from multiple threads.
+        for (size_t i = 0; i < batch_size; i++) {
+            (void)batch_task(context, (int)i, (uint8_t *)&closure);
+        }
+    } else {
+        (void)JITSharedRuntime::do_par_for(context, batch_task, 0, (int)batch_size, (uint8_t *)&closure);
+    }
+
+    int exit_status = 0;
+    for (size_t i = 0; i < batch_size; i++) {
+        if (exit_statuses[i] != 0) {
+            exit_status = exit_statuses[i];
+            break;
+        }
+    }
+
+    // If we're profiling, report runtimes and reset profiler stats.
+    contents->jit_cache.finish_profiling(context);
+
+    jit_call_context.finalize(exit_status);
+
+    return exit_status;
+}
+
 }  // namespace Halide
@@ -8,6 +8,9 @@
 
 #include <array>
 #include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include "Buffer.h"
 #include "IntrusivePtr.h"
@@ -18,6 +21,9 @@ namespace Halide {
 struct Argument;
 struct CallableContents;
 
+template<typename... Args>
+class BoundCallable;
+
 namespace PythonBindings {
 class PyCallable;
 }
@@ -84,6 +90,8 @@ private:
     friend class Pipeline;
     friend struct CallableContents;
     friend class PythonBindings::PyCallable;
+    template<typename...>
+    friend class BoundCallable;
 
     Internal::IntrusivePtr<CallableContents> contents;
 
@@ -222,6 +230,11 @@ private:
             fill_slots(0, std::forward<Args>(args)...);
         }
 
+        template<typename T>
+        HALIDE_ALWAYS_INLINE void set_slot(size_t idx, const T &value) {
+            fill_slot(idx, value);
+        }
+
     private:
         template<typename T, int Dims>
         HALIDE_ALWAYS_INLINE void fill_slot(size_t idx, const ::Halide::Buffer<T, Dims> &value) {
@@ -297,6 +310,44 @@ private:
         return call_argv_checked(count, &argv.argv[0], actual_arg_types.data());
     }
 
+    template<typename... Args>
+    int call_batch_impl(JITUserContext *context, const std::vector<std::tuple<Args...>> &batch, std::vector<int> *exit_statuses) const {
+        // This is built at compile time!
+        static constexpr auto actual_arg_types = make_qcci_array<JITUserContext *, Args...>();
+        constexpr size_t count = sizeof...(Args) + 1;
+
+        if (exit_statuses) {
+            exit_statuses->assign(batch.size(), halide_error_code_success);
+        }
+
+        // Every entry in the batch has the same static signature, so one check covers them all.
+        const auto failure_fn = check_batch_qcci(count, actual_arg_types.data());
+        if (failure_fn) {
+            const int exit_status = failure_fn(context);
+            if (exit_statuses) {
+                exit_statuses->assign(batch.size(), exit_status);
+            }
+            return exit_status;
+        }
+
+        // ArgvStorage points into itself, so it must be constructed in place and never moved.
+        std::vector<ArgvStorage<count>> storage;
+        storage.reserve(batch.size());
+        std::vector<const void *const *> argvs;
+        argvs.reserve(batch.size());
+        for (const auto &args : batch) {
+            std::apply([&](const auto &...a) { storage.emplace_back(context, a...); }, args);
+            argvs.push_back(&storage.back().argv[0]);
+        }
+        return call_argv_batch(count, batch.size(), argvs.data(),
+                               exit_statuses ? exit_statuses->data() : nullptr);
+    }
+
+    FailureFn check_batch_qcci(size_t argc, const QuickCallCheckInfo *actual_cci) const;
+    FailureFn check_bound_args(size_t argc, const void *const *argv, const QuickCallCheckInfo *actual_cci) const;
+    const JITHandlers &saved_jit_handlers() const;
+    int call_argv_prebound(const void *const *argv, Internal::JITFuncCallContext *call_context) const;
+
     /** Return the expected Arguments for this Callable, in the order they must be specified, including all outputs.
      * Note that the first entry will *always* specify a JITUserContext. */
     const std::vector<Argument> &arguments() const;
@@ -403,6 +454,151 @@ public:
      *
      */
     int call_argv_fast(size_t argc, const void *const *argv) const;
+
+    /** Invoke the Callable once for each of a batch of argument sets,
+     * distributing the batch across the Halide thread pool as a single
+     * parallel loop. Each tuple in the batch holds the arguments for one
+     * call, in the same order you would pass them to operator(). The
+     * argument types are checked once for the whole batch, and the
+     * handlers are set up once, so the per-call overhead is much lower
+     * than calling the Callable in a loop. A failing entry does not stop
+     * the others from running. If exit_statuses is non-null, it is
+     * resized to the batch size and filled with the result of each call.
+     * Returns zero if every call succeeded, or the exit status of the
+     * first failing entry otherwise. */
+    // @{
+    template<typename... Args>
+    int call_batch(JITUserContext *context, const std::vector<std::tuple<Args...>> &batch,
+                   std::vector<int> *exit_statuses = nullptr) const {
+        return call_batch_impl(context, batch, exit_statuses);
+    }
+
+    template<typename... Args>
+    int call_batch(const std::vector<std::tuple<Args...>> &batch,
+                   std::vector<int> *exit_statuses = nullptr) const {
+        JITUserContext empty;
+        return call_batch_impl(&empty, batch, exit_statuses);
+    }
+    // @}
+
+    /** Bind a fixed set of arguments to this Callable, returning an
+     * object that can be called repeatedly with minimal overhead. See
+     * BoundCallable. */
+    template<typename... Args>
+    BoundCallable<std::decay_t<Args>...> bind(Args &&...args) const {
+        return BoundCallable<std::decay_t<Args>...>(*this, std::index_sequence_for<Args...>(), std::forward<Args>(args)...);
+    }
+
+    /** Unsafe low-overhead way of invoking the Callable on a batch of
+     * argument sets. argvs points to batch_size argv arrays, each of
+     * which has argc entries and follows the calling convention
+     * described for call_argv_fast(). All of the argv arrays must refer
+     * to the same JITUserContext in their first entry. If exit_statuses
+     * is non-null, it must have room for batch_size entries. Like
+     * call_argv_fast(), no checking of the argument types is done. */
+    int call_argv_batch(size_t argc, size_t batch_size,
+                        const void *const *const *argvs, int *exit_statuses) const;
+
+    /** Create a persistent workspace for calls to this Callable that
+     * pass the given context. The Callable must have been compiled for
+     * a target with Target::Workspace. While the workspace exists, the
+     * heap allocations made outside of parallel loops by such calls
+     * are kept after each call and reused by the next one, so repeated
+     * calls on inputs of the same or smaller size do not allocate at
+     * all. initial_bytes of memory are reserved up front; pass the
+     * workspace_high_water_mark() of an earlier workspace to avoid
+     * allocating even on the first call. A workspace must only be used
+     * by one thread at a time. */
+    halide_workspace_t *create_workspace(JITUserContext *context, uint64_t initial_bytes = 0) const;
+
+    /** Release a workspace made by create_workspace(), along with all
+     * of the memory it holds. */
+    void destroy_workspace(JITUserContext *context, halide_workspace_t *workspace) const;
+
+    /** Get the largest number of bytes a workspace has held at once. */
+    static uint64_t workspace_high_water_mark(const halide_workspace_t *workspace);
+};
+
+/** A Callable with a fixed set of arguments bound to it, made by
+ * Callable::bind(). The argument types, and the types and
+ * dimensionality of any buffers, are checked once when it is
+ * created, and the argv array and JIT handlers are set up once.
+ * Calling it afterwards does no heap allocation and no checking
+ * beyond what the pipeline itself does. Individual arguments can be
+ * replaced between calls with set<I>(), and the host pointer of a
+ * bound buffer can be swapped with set_host<I>(), where I is the
+ * position of the argument in the call to bind(). Those are
+ * statically typed, so they need no runtime checks either.
+ *
+ * Buffers are held by value, so a bound Halide::Buffer shares its
+ * storage with the one passed in. Raw halide_buffer_t pointers must
+ * outlive the BoundCallable. The first set_host() on an argument makes
+ * a private copy of its halide_buffer_t (sharing the shape), so the
+ * buffer that was passed in is never modified; later calls read and
+ * write through that copy until the argument is replaced with set().
+ * Swapping host pointers is only meaningful for buffers that do not
+ * have a device allocation. A BoundCallable is not thread-safe; use
+ * one per thread. */
+template<typename... Args>
+class BoundCallable {
+    friend class Callable;
+
+    static constexpr size_t count = sizeof...(Args) + 1;
+
+    Callable callable;
+    JITUserContext context;
+    Internal::JITFuncCallContext call_context;
+    std::tuple<Args...> held_args;
+    Callable::ArgvStorage<count> argv;
+    Callable::FailureFn failure_fn;
+    // Copies of the bound buffers whose host pointers have been swapped.
+    halide_buffer_t private_buffers[count];
+
+    template<size_t... Is, typename... InArgs>
+    BoundCallable(const Callable &c, std::index_sequence<Is...>, InArgs &&...in_args)
+        : callable(c),
+          call_context(&context, c.saved_jit_handlers()),
+          held_args(std::forward<InArgs>(in_args)...),
+          argv(&context, std::get<Is>(held_args)...) {
+        // This is built at compile time!
+        static constexpr auto actual_arg_types = Callable::make_qcci_array<JITUserContext *, Args...>();
+        failure_fn = callable.check_bound_args(count, &argv.argv[0], actual_arg_types.data());
+    }
+
+public:
+    BoundCallable(const BoundCallable &) = delete;
+    BoundCallable &operator=(const BoundCallable &) = delete;
+    BoundCallable(BoundCallable &&) = delete;
+    BoundCallable &operator=(BoundCallable &&) = delete;
+
+    /** Replace the value of the I'th bound argument. */
+    template<size_t I>
+    HALIDE_ALWAYS_INLINE void set(const std::tuple_element_t<I, std::tuple<Args...>> &value) {
+        std::get<I>(held_args) = value;
+        argv.set_slot(I + 1, std::get<I>(held_args));
+    }
+
+    /** Point the I'th bound argument, which must be a buffer, at new
+     * host memory of the same shape. */
+    template<size_t I>
+    HALIDE_ALWAYS_INLINE void set_host(void *host) {
+        static_assert(Internal::IsHalideBuffer<std::tuple_element_t<I, std::tuple<Args...>>>::value,
+                      "set_host() may only be used on buffer arguments.");
+        halide_buffer_t *buf = &private_buffers[I];
+        if (argv.argv[I + 1] != buf) {
+            *buf = *(const halide_buffer_t *)argv.argv[I + 1];
+            argv.argv[I + 1] = buf;
+        }
+        buf->host = (uint8_t *)host;
+    }
+
+    HALIDE_FUNCTION_ATTRS
+    int operator()() {
+        if (failure_fn) {
+            return failure_fn(&context);
+        }
+        return callable.call_argv_prebound(&argv.argv[0], &call_context);
+    }
 };
 
 }  // namespace Halide
@@ -185,6 +185,53 @@ public:
     std::set<Type> vector_types_used;
 };
 
+// Whether the vector ops in CodeGen_C_vectors.template.cpp map the given
+// integer intrinsic to a native instruction on this target. Those get
+// emitted as calls to the ops, so that the host compiler doesn't have to
+// rediscover them in the lowered arithmetic. The rest are lowered as
+// usual. If the generated code is compiled without the instruction set
+// (e.g. without -mavx2, or without HALIDE_CPP_ENABLE_NEON_INTRINSICS on
+// arm), the ops fall back to the same kind of vector arithmetic that
+// lowering them would have produced.
+bool has_native_vector_op(const Target &target, const string &op, const Type &t) {
+    if (!t.is_vector() || !t.is_int_or_uint()) {
+        return false;
+    }
+    const int bits = t.bits() * t.lanes();
+    if (target.arch == Target::X86) {
+        const bool avx512 = target.features_any_of({Target::AVX512_Skylake,
+                                                    Target::AVX512_Cannonlake,
+                                                    Target::AVX512_SapphireRapids,
+                                                    Target::AVX512_Zen4,
+                                                    Target::AVX512_Zen5});
+        const bool avx2 = avx512 || target.has_feature(Target::AVX2);
+        if (!(bits == 128 || (bits == 256 && avx2) || (bits == 512 && avx512))) {
+            return false;
+        }
+        if (op == "saturating_add" || op == "saturating_sub") {
+            return t.bits() <= 16;
+        } else if (op == "rounding_halving_add") {
+            return t.is_uint() && t.bits() <= 16;
+        } else if (op == "mul_high") {
+            return t.bits() == 16;
+        } else if (op == "pairwise_dot_product") {
+            return t.is_int() && t.bits() == 32;
+        }
+    } else if (target.arch == Target::ARM) {
+        if (bits != 128) {
+            return false;
+        }
+        if (op == "saturating_add" || op == "saturating_sub" ||
+            op == "halving_add" || op == "halving_sub" ||
+            op == "rounding_halving_add") {
+            return t.bits() <= 32;
+        } else if (op == "pairwise_dot_product") {
+            return target.bits == 64 && t.bits() == 32;
+        }
+    }
+    return false;
+}
+
 }  // namespace
 
 CodeGen_C::CodeGen_C(ostream &s, const Target &t, OutputKind output_kind, const std::string &guard)
@@ -621,6 +668,54 @@ void CodeGen_C::emit_argv_wrapper(const std::string &function_name,
     stream << "}";
 }
 
+void CodeGen_C::emit_batch_wrapper(const std::string &function_name) {
+    const std::string signature = "int " + function_name +
+                                  "_batch(void *user_context, int batch_size, void ***argvs, int *exit_statuses)";
+    if (is_header_or_extern_decl()) {
+        stream << "\nHALIDE_FUNCTION_ATTRS\n"
+               << signature << ";\n";
+        return;
+    }
+
+    stream << "\nHALIDE_FUNCTION_ATTRS\n"
+           << signature << " {\n";
+    indent += 1;
+    stream << get_indent() << "return halide_do_argv_batch(user_context, " << function_name
+           << "_argv, batch_size, argvs, exit_statuses);\n";
+    indent -= 1;
+    stream << "}";
+}
+
+void CodeGen_C::emit_workspace_wrappers(const std::string &function_name,
+                                        const std::string &pipeline_name) {
+    const std::string create_signature = "struct halide_workspace_t *" + function_name +
+                                         "_workspace_create(void *user_context, uint64_t initial_bytes)";
+    const std::string destroy_signature = "void " + function_name +
+                                          "_workspace_destroy(void *user_context, struct halide_workspace_t *workspace)";
+    if (is_header_or_extern_decl()) {
+        stream << "\nHALIDE_FUNCTION_ATTRS\n"
+               << create_signature << ";\n"
+               << "\nHALIDE_FUNCTION_ATTRS\n"
+               << destroy_signature << ";\n";
+        return;
+    }
+
+    stream << "\nHALIDE_FUNCTION_ATTRS\n"
+           << create_signature << " {\n";
+    indent += 1;
+    stream << get_indent() << "return halide_workspace_create(user_context, \"" << pipeline_name
+           << "\", initial_bytes);\n";
+    indent -= 1;
+    stream << "}\n";
+
+    stream << "\nHALIDE_FUNCTION_ATTRS\n"
+           << destroy_signature << " {\n";
+    indent += 1;
+    stream << get_indent() << "halide_workspace_destroy(user_context, workspace);\n";
+    indent -= 1;
+    stream << "}";
+}
+
 void CodeGen_C::emit_metadata_getter(const std::string &function_name,
                                      const std::vector<LoweredArgument> &args,
                                      const MetadataNameMap &metadata_name_map) {
@@ -1117,6 +1212,12 @@ void CodeGen_C::compile(const LoweredFunc &f, const MetadataNameMap &metadata_na
         if (f.linkage == LinkageType::ExternalPlusArgv || f.linkage == LinkageType::ExternalPlusMetadata) {
             // Emit the argv version
             emit_argv_wrapper(simple_name, args);
+            emit_batch_wrapper(simple_name);
+        }
+
+        if (f.linkage != LinkageType::Internal && target.has_feature(Target::Workspace)) {
+            // Emit the functions that create and destroy a persistent workspace
+            emit_workspace_wrappers(simple_name, f.name);
         }
 
         if (f.linkage == LinkageType::ExternalPlusMetadata) {
@@ -1841,12 +1942,31 @@ void CodeGen_C::visit(const Call *op) {
         rhs << "(__builtin_prefetch("
             << "((" << print_type(op->type) << " *)" << print_name(base->name)
             << " + " << print_expr(base_offset) << "), /*rw*/0, /*locality*/0), 0)";
+    } else if (op->is_intrinsic(Call::nontemporal_store)) {
+        // The C backend emits regular stores, so the hint is dropped,
+        // and the matching store_fence has nothing to order.
+        rhs << print_expr(op->args[0]);
+    } else if (op->is_intrinsic(Call::store_fence)) {
+        rhs << "0";
     } else if (op->is_intrinsic(Call::size_of_halide_buffer_t)) {
         rhs << "(sizeof(halide_buffer_t))";
     } else if (op->is_strict_float_intrinsic()) {
         // This depends on the generated C++ being compiled without -ffast-math
         Expr equiv = unstrictify_float(op);
         rhs << print_expr(equiv);
+    } else if (using_vector_typedefs &&
+               op->is_intrinsic({Call::saturating_add, Call::saturating_sub,
+                                 Call::halving_add, Call::halving_sub,
+                                 Call::rounding_halving_add}) &&
+               has_native_vector_op(target, op->name, op->type)) {
+        rhs << print_type(op->type) << "_ops::" << op->name << "("
+            << print_expr(op->args[0]) << ", " << print_expr(op->args[1]) << ")";
+    } else if (using_vector_typedefs &&
+               op->is_intrinsic(Call::mul_shift_right) &&
+               is_const(op->args[2], op->type.bits()) &&
+               has_native_vector_op(target, "mul_high", op->type)) {
+        rhs << print_type(op->type) << "_ops::mul_high("
+            << print_expr(op->args[0]) << ", " << print_expr(op->args[1]) << ")";
     } else if (op->is_intrinsic()) {
         Expr lowered = lower_intrinsic(op);
         if (lowered.defined()) {
@@ -2111,6 +2231,20 @@ Expr CodeGen_C::scalarize_vector_reduce(const VectorReduce *op) {
 void CodeGen_C::visit(const VectorReduce *op) {
     stream << get_indent() << "// Vector reduce: " << op->op << "\n";
 
+    // A sum of adjacent pairs of widening multiplies is a dot product
+    // instruction on most targets.
+    const Call *mul = Call::as_intrinsic(op->value, {Call::widening_mul});
+    if (using_vector_typedefs &&
+        op->op == VectorReduce::Add &&
+        op->value.type().lanes() == op->type.lanes() * 2 &&
+        mul && mul->args[0].type() == mul->args[1].type() &&
+        has_native_vector_op(target, "pairwise_dot_product", op->type)) {
+        string a = print_expr(mul->args[0]);
+        string b = print_expr(mul->args[1]);
+        print_assignment(op->type, print_type(op->type) + "_ops::pairwise_dot_product(" + a + ", " + b + ")");
+        return;
+    }
+
     Expr scalarized = scalarize_vector_reduce(op);
     if (scalarized.type().is_scalar()) {
         print_assignment(op->type, print_expr(scalarized));
@@ -2176,34 +2310,17 @@ void CodeGen_C::visit(const ProducerConsumer *op) {
 }
 
 void CodeGen_C::visit(const Fork *op) {
-    // TODO: This doesn't actually work with nested tasks
-    stream << get_indent() << "#pragma omp parallel\n";
-    open_scope();
-    stream << get_indent() << "#pragma omp single\n";
-    open_scope();
-    stream << get_indent() << "#pragma omp task\n";
-    open_scope();
-    print_stmt(op->first);
-    close_scope("");
-    stream << get_indent() << "#pragma omp task\n";
-    open_scope();
-    print_stmt(op->rest);
-    close_scope("");
-    stream << get_indent() << "#pragma omp taskwait\n";
-    close_scope("");
-    close_scope("");
+    // lower_parallel_tasks turns every Fork, including ones nested inside
+    // parallel loops or other tasks, into a closure and a call to
+    // halide_do_parallel_tasks, so the generated C++ uses the same task
+    // system as the LLVM backends.
+    internal_error << "Fork should have been lowered to halide_do_parallel_tasks\n";
 }
 
 void CodeGen_C::visit(const Acquire *op) {
-    string id_sem = print_expr(op->semaphore);
-    string id_count = print_expr(op->count);
-    open_scope();
-    stream << get_indent() << "while (!halide_semaphore_try_acquire(" << id_sem << ", " << id_count << "))\n";
-    open_scope();
-    stream << get_indent() << "#pragma omp taskyield\n";
-    close_scope("");
-    op->body.accept(this);
-    close_scope("");
+    // Similarly, the semaphores of async producers become the
+    // halide_semaphore_acquire_t list of a parallel task.
+    internal_error << "Acquire should have been lowered to halide_do_parallel_tasks\n";
 }
 
 void CodeGen_C::visit(const Atomic *op) {
@@ -2223,12 +2340,10 @@ void CodeGen_C::visit(const For *op) {
     string id_min = print_expr(op->min);
     string id_extent = print_expr(op->extent);
 
-    if (op->for_type == ForType::Parallel) {
-        stream << get_indent() << "#pragma omp parallel for\n";
-    } else {
-        internal_assert(op->for_type == ForType::Serial)
-            << "Can only emit serial or parallel for loops to C\n";
-    }
+    // Parallel loops have been lowered to halide_do_par_for or
+    // halide_do_parallel_tasks calls by lower_parallel_tasks.
+    internal_assert(op->for_type == ForType::Serial)
+        << "Can only emit serial for loops to C\n";
 
     stream << get_indent() << "for (int "
            << print_name(op->name)
@@ -298,6 +298,9 @@ protected:
 
     void emit_argv_wrapper(const std::string &function_name,
                            const std::vector<LoweredArgument> &args);
+    void emit_batch_wrapper(const std::string &function_name);
+    void emit_workspace_wrappers(const std::string &function_name,
+                                 const std::string &pipeline_name);
     void emit_metadata_getter(const std::string &function_name,
                               const std::vector<LoweredArgument> &args,
                               const MetadataNameMap &metadata_name_map);
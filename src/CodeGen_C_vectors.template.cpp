@@ -6,8 +6,163 @@
 #define __has_builtin(x) 0
 #endif
 
+#if !HALIDE_CPP_DISABLE_SIMD_INTRINSICS
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && HALIDE_CPP_ENABLE_NEON_INTRINSICS
+// The NEON specializations below are opt-in until they have been exercised
+// on arm targets. The NEON vector types have the same names as the vector
+// typedefs we emit (e.g. uint8x16_t), so rename them while the header is
+// being included.
+#define int8x8_t halide_cpp_neon_int8x8_t
+#define uint8x8_t halide_cpp_neon_uint8x8_t
+#define int8x16_t halide_cpp_neon_int8x16_t
+#define uint8x16_t halide_cpp_neon_uint8x16_t
+#define int16x4_t halide_cpp_neon_int16x4_t
+#define uint16x4_t halide_cpp_neon_uint16x4_t
+#define int16x8_t halide_cpp_neon_int16x8_t
+#define uint16x8_t halide_cpp_neon_uint16x8_t
+#define int32x2_t halide_cpp_neon_int32x2_t
+#define uint32x2_t halide_cpp_neon_uint32x2_t
+#define int32x4_t halide_cpp_neon_int32x4_t
+#define uint32x4_t halide_cpp_neon_uint32x4_t
+#define int64x1_t halide_cpp_neon_int64x1_t
+#define uint64x1_t halide_cpp_neon_uint64x1_t
+#define int64x2_t halide_cpp_neon_int64x2_t
+#define uint64x2_t halide_cpp_neon_uint64x2_t
+#include <arm_neon.h>
+#undef int8x8_t
+#undef uint8x8_t
+#undef int8x16_t
+#undef uint8x16_t
+#undef int16x4_t
+#undef uint16x4_t
+#undef int16x8_t
+#undef uint16x8_t
+#undef int32x2_t
+#undef uint32x2_t
+#undef int32x4_t
+#undef uint32x4_t
+#undef int64x1_t
+#undef uint64x1_t
+#undef int64x2_t
+#undef uint64x2_t
+#define HALIDE_CPP_USE_NEON_INTRINSICS 1
+#endif
+#endif
+
 namespace {
 
+// Scalar versions of the integer intrinsics that the vector ops below can
+// map to native instructions. They are only used for 8, 16, and 32-bit
+// types, so the 64-bit intermediates can't overflow.
+template<typename T>
+T halide_cpp_saturate(int64_t v) {
+    return v < (int64_t)std::numeric_limits<T>::min() ? std::numeric_limits<T>::min() :
+           v > (int64_t)std::numeric_limits<T>::max() ? std::numeric_limits<T>::max() :
+                                                        (T)v;
+}
+
+template<typename T>
+T halide_cpp_saturating_add(T a, T b) {
+    return halide_cpp_saturate<T>((int64_t)a + (int64_t)b);
+}
+
+template<typename T>
+T halide_cpp_saturating_sub(T a, T b) {
+    return halide_cpp_saturate<T>((int64_t)a - (int64_t)b);
+}
+
+template<typename T>
+T halide_cpp_halving_add(T a, T b) {
+    return (T)(((int64_t)a + (int64_t)b) >> 1);
+}
+
+template<typename T>
+T halide_cpp_halving_sub(T a, T b) {
+    return (T)(((int64_t)a - (int64_t)b) >> 1);
+}
+
+template<typename T>
+T halide_cpp_rounding_halving_add(T a, T b) {
+    return (T)(((int64_t)a + (int64_t)b + 1) >> 1);
+}
+
+// The high half of the full-width product, i.e. mul_shift_right(a, b, bits).
+template<typename T>
+T halide_cpp_mul_high(T a, T b) {
+    using Wide = typename std::conditional<std::is_signed<T>::value, int64_t, uint64_t>::type;
+    return (T)(((Wide)a * (Wide)b) >> (sizeof(T) * 8));
+}
+
+// The sum of adjacent pairs of full-width products, wrapping to Wide.
+template<typename Wide, typename T>
+Wide halide_cpp_pairwise_dot_product(T a0, T b0, T a1, T b1) {
+    return (Wide)((int64_t)a0 * (int64_t)b0 + (int64_t)a1 * (int64_t)b1);
+}
+
+// The element type a pairwise_dot_product() into T reads from.
+template<typename T>
+struct HalideCppNarrowType {
+    using type = T;
+};
+
+template<>
+struct HalideCppNarrowType<int16_t> {
+    using type = int8_t;
+};
+
+template<>
+struct HalideCppNarrowType<uint16_t> {
+    using type = uint8_t;
+};
+
+template<>
+struct HalideCppNarrowType<int32_t> {
+    using type = int16_t;
+};
+
+template<>
+struct HalideCppNarrowType<uint32_t> {
+    using type = uint16_t;
+};
+
+// The element type a mul_high() of T widens to.
+template<typename T>
+struct HalideCppWideType {
+    using type = T;
+};
+
+template<>
+struct HalideCppWideType<int8_t> {
+    using type = int16_t;
+};
+
+template<>
+struct HalideCppWideType<uint8_t> {
+    using type = uint16_t;
+};
+
+template<>
+struct HalideCppWideType<int16_t> {
+    using type = int32_t;
+};
+
+template<>
+struct HalideCppWideType<uint16_t> {
+    using type = uint32_t;
+};
+
+template<>
+struct HalideCppWideType<int32_t> {
+    using type = int64_t;
+};
+
+template<>
+struct HalideCppWideType<uint32_t> {
+    using type = uint64_t;
+};
+
 // We can't use std::array because that has its own overload of operator<, etc,
 // which will interfere with ours.
 template<typename ElementType, size_t Lanes>
@@ -213,6 +368,64 @@ public:
         }
         return r;
     }
+
+    static Vec saturating_add(const Vec &a, const Vec &b) {
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = ::halide_cpp_saturating_add(a[i], b[i]);
+        }
+        return r;
+    }
+
+    static Vec saturating_sub(const Vec &a, const Vec &b) {
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = ::halide_cpp_saturating_sub(a[i], b[i]);
+        }
+        return r;
+    }
+
+    static Vec halving_add(const Vec &a, const Vec &b) {
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = ::halide_cpp_halving_add(a[i], b[i]);
+        }
+        return r;
+    }
+
+    static Vec halving_sub(const Vec &a, const Vec &b) {
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = ::halide_cpp_halving_sub(a[i], b[i]);
+        }
+        return r;
+    }
+
+    static Vec rounding_halving_add(const Vec &a, const Vec &b) {
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = ::halide_cpp_rounding_halving_add(a[i], b[i]);
+        }
+        return r;
+    }
+
+    static Vec mul_high(const Vec &a, const Vec &b) {
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = ::halide_cpp_mul_high(a[i], b[i]);
+        }
+        return r;
+    }
+
+    using NarrowVec = CppVector<typename HalideCppNarrowType<ElementType>::type, Lanes * 2>;
+
+    static Vec pairwise_dot_product(const NarrowVec &a, const NarrowVec &b) {
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = ::halide_cpp_pairwise_dot_product<ElementType>(a[2 * i], b[2 * i], a[2 * i + 1], b[2 * i + 1]);
+        }
+        return r;
+    }
 };
 
 template<typename ElementType, size_t Lanes>
@@ -782,8 +995,199 @@ public:
         const NativeVector<T, Lanes> r = a != b;
         return NativeVectorOps<uint8_t, Lanes>::convert_from(r);
     }
+
+    // These are specialized below for the vector types with native
+    // instructions. The generic versions are for compilers or targets that
+    // don't provide them (e.g. when the generated code isn't compiled with
+    // -mavx2 for 256-bit vectors). They stay in the element type, so the
+    // compiler still sees vector arithmetic rather than a loop over lanes.
+    // Signed wraparound is done in the unsigned type to keep it defined.
+    static Vec saturating_add(const Vec a, const Vec b) {
+        using UVec = NativeVector<typename std::make_unsigned<ElementType>::type, Lanes>;
+        const Vec sum = (Vec)((UVec)a + (UVec)b);
+        if constexpr (std::is_signed<ElementType>::value) {
+            // Overflow iff a and b have the same sign and the sum doesn't.
+            constexpr int sign_bit = sizeof(ElementType) * 8 - 1;
+            const Vec overflow = ((sum ^ a) & (sum ^ b)) >> sign_bit;
+            const Vec limit = (a >> sign_bit) ^ std::numeric_limits<ElementType>::max();
+            return (sum & ~overflow) | (limit & overflow);
+        } else {
+            return sum | (Vec)(sum < a);
+        }
+    }
+
+    static Vec saturating_sub(const Vec a, const Vec b) {
+        using UVec = NativeVector<typename std::make_unsigned<ElementType>::type, Lanes>;
+        const Vec diff = (Vec)((UVec)a - (UVec)b);
+        if constexpr (std::is_signed<ElementType>::value) {
+            // Overflow iff a and b have different signs and the difference
+            // doesn't have the sign of a.
+            constexpr int sign_bit = sizeof(ElementType) * 8 - 1;
+            const Vec overflow = ((a ^ b) & (a ^ diff)) >> sign_bit;
+            const Vec limit = (a >> sign_bit) ^ std::numeric_limits<ElementType>::max();
+            return (diff & ~overflow) | (limit & overflow);
+        } else {
+            return diff & (Vec)(a >= b);
+        }
+    }
+
+    static Vec halving_add(const Vec a, const Vec b) {
+        const ElementType one = 1;
+        return (a >> 1) + (b >> 1) + (a & b & one);
+    }
+
+    static Vec halving_sub(const Vec a, const Vec b) {
+        const ElementType one = 1;
+        return (a >> 1) - (b >> 1) - (~a & b & one);
+    }
+
+    static Vec rounding_halving_add(const Vec a, const Vec b) {
+        const ElementType one = 1;
+        return (a >> 1) + (b >> 1) + ((a | b) & one);
+    }
+
+    static Vec mul_high(const Vec a, const Vec b) {
+        // The product of two Ts always fits in the wide type.
+        using WideOps = NativeVectorOps<typename HalideCppWideType<ElementType>::type, Lanes>;
+        const typename WideOps::Vec product = WideOps::convert_from(a) * WideOps::convert_from(b);
+        return convert_from(product >> (sizeof(ElementType) * 8));
+    }
+
+    using NarrowVec = NativeVector<typename HalideCppNarrowType<ElementType>::type, Lanes * 2>;
+
+    static Vec pairwise_dot_product(const NarrowVec a, const NarrowVec b) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        // Each lane of a NarrowVec reinterpreted as a Vec holds an adjacent
+        // pair of narrow lanes, with the even one in the low half. Shifts
+        // extract them, sign- or zero-extended as appropriate.
+        using UVec = NativeVector<typename std::make_unsigned<ElementType>::type, Lanes>;
+        constexpr int half = sizeof(ElementType) * 4;
+        const Vec wa = (Vec)a, wb = (Vec)b;
+        const UVec even_a = (UVec)((Vec)((UVec)wa << half) >> half);
+        const UVec even_b = (UVec)((Vec)((UVec)wb << half) >> half);
+        const UVec odd_a = (UVec)(wa >> half);
+        const UVec odd_b = (UVec)(wb >> half);
+        return (Vec)(even_a * even_b + odd_a * odd_b);
+#else
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = ::halide_cpp_pairwise_dot_product<ElementType>(a[2 * i], b[2 * i], a[2 * i + 1], b[2 * i + 1]);
+        }
+        return r;
+#endif
+    }
 };
 
+// Map the intrinsics above to native instructions for the vector types
+// Halide emits calls for (see CodeGen_C::visit(const Call *)). The
+// generic versions remain as a fallback when the generated code is compiled
+// without the corresponding instruction set enabled.
+#if !HALIDE_CPP_DISABLE_SIMD_INTRINSICS
+
+#define HALIDE_CPP_NATIVE_BINOP(T, N, OP, NT, INTRIN)                                                             \
+    template<>                                                                                                    \
+    inline NativeVector<T, N> NativeVectorOps<T, N>::OP(const NativeVector<T, N> a, const NativeVector<T, N> b) { \
+        return (NativeVector<T, N>)INTRIN((NT)a, (NT)b);                                                          \
+    }
+
+#if defined(__SSE2__)
+HALIDE_CPP_NATIVE_BINOP(uint8_t, 16, saturating_add, __m128i, _mm_adds_epu8)
+HALIDE_CPP_NATIVE_BINOP(uint8_t, 16, saturating_sub, __m128i, _mm_subs_epu8)
+HALIDE_CPP_NATIVE_BINOP(uint8_t, 16, rounding_halving_add, __m128i, _mm_avg_epu8)
+HALIDE_CPP_NATIVE_BINOP(int8_t, 16, saturating_add, __m128i, _mm_adds_epi8)
+HALIDE_CPP_NATIVE_BINOP(int8_t, 16, saturating_sub, __m128i, _mm_subs_epi8)
+HALIDE_CPP_NATIVE_BINOP(uint16_t, 8, saturating_add, __m128i, _mm_adds_epu16)
+HALIDE_CPP_NATIVE_BINOP(uint16_t, 8, saturating_sub, __m128i, _mm_subs_epu16)
+HALIDE_CPP_NATIVE_BINOP(uint16_t, 8, rounding_halving_add, __m128i, _mm_avg_epu16)
+HALIDE_CPP_NATIVE_BINOP(uint16_t, 8, mul_high, __m128i, _mm_mulhi_epu16)
+HALIDE_CPP_NATIVE_BINOP(int16_t, 8, saturating_add, __m128i, _mm_adds_epi16)
+HALIDE_CPP_NATIVE_BINOP(int16_t, 8, saturating_sub, __m128i, _mm_subs_epi16)
+HALIDE_CPP_NATIVE_BINOP(int16_t, 8, mul_high, __m128i, _mm_mulhi_epi16)
+
+template<>
+inline NativeVector<int32_t, 4> NativeVectorOps<int32_t, 4>::pairwise_dot_product(const NativeVector<int16_t, 8> a, const NativeVector<int16_t, 8> b) {
+    return (NativeVector<int32_t, 4>)_mm_madd_epi16((__m128i)a, (__m128i)b);
+}
+#endif  // __SSE2__
+
+#if defined(__AVX2__)
+HALIDE_CPP_NATIVE_BINOP(uint8_t, 32, saturating_add, __m256i, _mm256_adds_epu8)
+HALIDE_CPP_NATIVE_BINOP(uint8_t, 32, saturating_sub, __m256i, _mm256_subs_epu8)
+HALIDE_CPP_NATIVE_BINOP(uint8_t, 32, rounding_halving_add, __m256i, _mm256_avg_epu8)
+HALIDE_CPP_NATIVE_BINOP(int8_t, 32, saturating_add, __m256i, _mm256_adds_epi8)
+HALIDE_CPP_NATIVE_BINOP(int8_t, 32, saturating_sub, __m256i, _mm256_subs_epi8)
+HALIDE_CPP_NATIVE_BINOP(uint16_t, 16, saturating_add, __m256i, _mm256_adds_epu16)
+HALIDE_CPP_NATIVE_BINOP(uint16_t, 16, saturating_sub, __m256i, _mm256_subs_epu16)
+HALIDE_CPP_NATIVE_BINOP(uint16_t, 16, rounding_halving_add, __m256i, _mm256_avg_epu16)
+HALIDE_CPP_NATIVE_BINOP(uint16_t, 16, mul_high, __m256i, _mm256_mulhi_epu16)
+HALIDE_CPP_NATIVE_BINOP(int16_t, 16, saturating_add, __m256i, _mm256_adds_epi16)
+HALIDE_CPP_NATIVE_BINOP(int16_t, 16, saturating_sub, __m256i, _mm256_subs_epi16)
+HALIDE_CPP_NATIVE_BINOP(int16_t, 16, mul_high, __m256i, _mm256_mulhi_epi16)
+
+template<>
+inline NativeVector<int32_t, 8> NativeVectorOps<int32_t, 8>::pairwise_dot_product(const NativeVector<int16_t, 16> a, const NativeVector<int16_t, 16> b) {
+    return (NativeVector<int32_t, 8>)_mm256_madd_epi16((__m256i)a, (__m256i)b);
+}
+#endif  // __AVX2__
+
+#if defined(__AVX512BW__)
+HALIDE_CPP_NATIVE_BINOP(uint8_t, 64, saturating_add, __m512i, _mm512_adds_epu8)
+HALIDE_CPP_NATIVE_BINOP(uint8_t, 64, saturating_sub, __m512i, _mm512_subs_epu8)
+HALIDE_CPP_NATIVE_BINOP(uint8_t, 64, rounding_halving_add, __m512i, _mm512_avg_epu8)
+HALIDE_CPP_NATIVE_BINOP(int8_t, 64, saturating_add, __m512i, _mm512_adds_epi8)
+HALIDE_CPP_NATIVE_BINOP(int8_t, 64, saturating_sub, __m512i, _mm512_subs_epi8)
+HALIDE_CPP_NATIVE_BINOP(uint16_t, 32, saturating_add, __m512i, _mm512_adds_epu16)
+HALIDE_CPP_NATIVE_BINOP(uint16_t, 32, saturating_sub, __m512i, _mm512_subs_epu16)
+HALIDE_CPP_NATIVE_BINOP(uint16_t, 32, rounding_halving_add, __m512i, _mm512_avg_epu16)
+HALIDE_CPP_NATIVE_BINOP(uint16_t, 32, mul_high, __m512i, _mm512_mulhi_epu16)
+HALIDE_CPP_NATIVE_BINOP(int16_t, 32, saturating_add, __m512i, _mm512_adds_epi16)
+HALIDE_CPP_NATIVE_BINOP(int16_t, 32, saturating_sub, __m512i, _mm512_subs_epi16)
+HALIDE_CPP_NATIVE_BINOP(int16_t, 32, mul_high, __m512i, _mm512_mulhi_epi16)
+
+template<>
+inline NativeVector<int32_t, 16> NativeVectorOps<int32_t, 16>::pairwise_dot_product(const NativeVector<int16_t, 32> a, const NativeVector<int16_t, 32> b) {
+    return (NativeVector<int32_t, 16>)_mm512_madd_epi16((__m512i)a, (__m512i)b);
+}
+#endif  // __AVX512BW__
+
+#if HALIDE_CPP_USE_NEON_INTRINSICS
+#define HALIDE_CPP_NEON_BINOPS(T, N, NT, SUFFIX)                                                \
+    HALIDE_CPP_NATIVE_BINOP(T, N, saturating_add, halide_cpp_neon_##NT, vqaddq_##SUFFIX)        \
+    HALIDE_CPP_NATIVE_BINOP(T, N, saturating_sub, halide_cpp_neon_##NT, vqsubq_##SUFFIX)        \
+    HALIDE_CPP_NATIVE_BINOP(T, N, halving_add, halide_cpp_neon_##NT, vhaddq_##SUFFIX)           \
+    HALIDE_CPP_NATIVE_BINOP(T, N, halving_sub, halide_cpp_neon_##NT, vhsubq_##SUFFIX)           \
+    HALIDE_CPP_NATIVE_BINOP(T, N, rounding_halving_add, halide_cpp_neon_##NT, vrhaddq_##SUFFIX)
+
+HALIDE_CPP_NEON_BINOPS(uint8_t, 16, uint8x16_t, u8)
+HALIDE_CPP_NEON_BINOPS(int8_t, 16, int8x16_t, s8)
+HALIDE_CPP_NEON_BINOPS(uint16_t, 8, uint16x8_t, u16)
+HALIDE_CPP_NEON_BINOPS(int16_t, 8, int16x8_t, s16)
+HALIDE_CPP_NEON_BINOPS(uint32_t, 4, uint32x4_t, u32)
+HALIDE_CPP_NEON_BINOPS(int32_t, 4, int32x4_t, s32)
+
+#undef HALIDE_CPP_NEON_BINOPS
+
+#if defined(__aarch64__)
+template<>
+inline NativeVector<int32_t, 4> NativeVectorOps<int32_t, 4>::pairwise_dot_product(const NativeVector<int16_t, 8> a, const NativeVector<int16_t, 8> b) {
+    const halide_cpp_neon_int16x8_t na = (halide_cpp_neon_int16x8_t)a, nb = (halide_cpp_neon_int16x8_t)b;
+    return (NativeVector<int32_t, 4>)vpaddq_s32(vmull_s16(vget_low_s16(na), vget_low_s16(nb)),
+                                                vmull_high_s16(na, nb));
+}
+
+template<>
+inline NativeVector<uint32_t, 4> NativeVectorOps<uint32_t, 4>::pairwise_dot_product(const NativeVector<uint16_t, 8> a, const NativeVector<uint16_t, 8> b) {
+    const halide_cpp_neon_uint16x8_t na = (halide_cpp_neon_uint16x8_t)a, nb = (halide_cpp_neon_uint16x8_t)b;
+    return (NativeVector<uint32_t, 4>)vpaddq_u32(vmull_u16(vget_low_u16(na), vget_low_u16(nb)),
+                                                 vmull_high_u16(na, nb));
+}
+#endif  // __aarch64__
+#endif  // HALIDE_CPP_USE_NEON_INTRINSICS
+
+#undef HALIDE_CPP_NATIVE_BINOP
+
+#endif  // !HALIDE_CPP_DISABLE_SIMD_INTRINSICS
+
 #endif  // __has_attribute(ext_vector_type) || __has_attribute(vector_size)
 
 }  // namespace
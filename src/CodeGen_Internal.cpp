@@ -51,9 +51,12 @@ bool function_takes_user_context(const std::string &name) {
         "halide_print",
         "halide_profiler_memory_allocate",
         "halide_profiler_memory_free",
+        "halide_profiler_memory_traffic",
         "halide_profiler_instance_start",
         "halide_profiler_instance_end",
         "halide_profiler_stack_peak_update",
+        "halide_profiler_timeline_enable",
+        "halide_profiler_timeline_event",
         "halide_spawn_thread",
         "halide_device_release",
         "halide_start_clock",
@@ -62,6 +65,7 @@ bool function_takes_user_context(const std::string &name) {
         "halide_memoization_cache_lookup",
         "halide_memoization_cache_store",
         "halide_memoization_cache_release",
+        "halide_workspace_malloc",
         "halide_cuda_run",
         "halide_opencl_run",
         "halide_metal_run",
@@ -298,6 +298,9 @@ struct MangledNames {
     string simple_name;
     string extern_name;
     string argv_name;
+    string batch_name;
+    string workspace_create_name;
+    string workspace_destroy_name;
     string metadata_name;
 };
 
@@ -311,6 +314,9 @@ MangledNames get_mangled_names(const std::string &name,
     names.simple_name = extract_namespaces(name, namespaces);
     names.extern_name = names.simple_name;
     names.argv_name = names.simple_name + "_argv";
+    names.batch_name = names.simple_name + "_batch";
+    names.workspace_create_name = names.simple_name + "_workspace_create";
+    names.workspace_destroy_name = names.simple_name + "_workspace_destroy";
     names.metadata_name = names.simple_name + "_metadata";
 
     if (linkage != LinkageType::Internal &&
@@ -331,6 +337,23 @@ MangledNames get_mangled_names(const std::string &name,
                                                 {halide_handle_cplusplus_type::Pointer, halide_handle_cplusplus_type::Pointer});
         Type void_star_star(Handle(1, &inner_type));
         names.argv_name = cplusplus_function_mangled_name(names.argv_name, namespaces, type_of<int>(), {ExternFuncArgument(make_zero(void_star_star))}, target);
+        halide_handle_cplusplus_type argvs_type(halide_cplusplus_type_name(halide_cplusplus_type_name::Simple, "void"), {}, {},
+                                                {halide_handle_cplusplus_type::Pointer, halide_handle_cplusplus_type::Pointer, halide_handle_cplusplus_type::Pointer});
+        names.batch_name = cplusplus_function_mangled_name(names.batch_name, namespaces, type_of<int>(),
+                                                           {ExternFuncArgument(make_zero(type_of<void *>())),
+                                                            ExternFuncArgument(make_zero(Int(32))),
+                                                            ExternFuncArgument(make_zero(Handle(1, &argvs_type))),
+                                                            ExternFuncArgument(make_zero(type_of<int *>()))},
+                                                           target);
+        names.workspace_create_name = cplusplus_function_mangled_name(names.workspace_create_name, namespaces, type_of<halide_workspace_t *>(),
+                                                                      {ExternFuncArgument(make_zero(type_of<void *>())),
+                                                                       ExternFuncArgument(make_zero(UInt(64)))},
+                                                                      target);
+        halide_handle_cplusplus_type void_type(halide_cplusplus_type_name(halide_cplusplus_type_name::Simple, "void"));
+        names.workspace_destroy_name = cplusplus_function_mangled_name(names.workspace_destroy_name, namespaces, Handle(1, &void_type),
+                                                                       {ExternFuncArgument(make_zero(type_of<void *>())),
+                                                                        ExternFuncArgument(make_zero(type_of<halide_workspace_t *>()))},
+                                                                       target);
         names.metadata_name = cplusplus_function_mangled_name(names.metadata_name, namespaces, type_of<const struct halide_filter_metadata_t *>(), {}, target);
     }
     return names;
@@ -546,13 +569,20 @@ std::unique_ptr<llvm::Module> CodeGen_LLVM::compile(const Module &input) {
         // If the Func is externally visible, also create the argv wrapper and metadata.
         // (useful for calling from JIT and other machine interfaces).
         if (f.linkage == LinkageType::ExternalPlusArgv || f.linkage == LinkageType::ExternalPlusMetadata) {
-            add_argv_wrapper(function, names.argv_name, false, buffer_args);
+            llvm::Function *argv_fn = add_argv_wrapper(function, names.argv_name, false, buffer_args);
+            add_batch_wrapper(argv_fn, names.batch_name);
             if (f.linkage == LinkageType::ExternalPlusMetadata) {
                 embed_metadata_getter(names.metadata_name,
                                       names.simple_name, f.args, input.get_metadata_name_map());
             }
         }
 
+        // If requested, also create the functions that manage a
+        // persistent workspace for this pipeline.
+        if (f.linkage != LinkageType::Internal && target.has_feature(Target::Workspace)) {
+            add_workspace_wrappers(f.name, names.workspace_create_name, names.workspace_destroy_name);
+        }
+
         // Workaround for https://github.com/halide/Halide/issues/635:
         // For historical reasons, Halide-generated AOT code
         // defines user_context as `void const*`, but expects all
@@ -1019,6 +1049,70 @@ llvm::Function *CodeGen_LLVM::add_argv_wrapper(llvm::Function *fn,
     return wrapper_func;
 }
 
+// Make a wrapper that calls an argv wrapper (see above) once for each
+// of an array of argv arrays, as a single parallel loop. The actual
+// work is done by halide_do_argv_batch in the runtime.
+llvm::Function *CodeGen_LLVM::add_batch_wrapper(llvm::Function *argv_fn, const std::string &name) {
+    llvm::Type *wrapper_args_t[] = {ptr_t, i32_t, ptr_t, ptr_t};
+    llvm::FunctionType *wrapper_func_t = llvm::FunctionType::get(i32_t, wrapper_args_t, false);
+    llvm::Function *wrapper_func = llvm::Function::Create(wrapper_func_t, llvm::GlobalValue::ExternalLinkage, name, module.get());
+    llvm::BasicBlock *wrapper_block = llvm::BasicBlock::Create(module->getContext(), "entry", wrapper_func);
+    builder->SetInsertPoint(wrapper_block);
+
+    llvm::Type *do_batch_args_t[] = {ptr_t, ptr_t, i32_t, ptr_t, ptr_t};
+    llvm::FunctionCallee do_batch =
+        module->getOrInsertFunction("halide_do_argv_batch",
+                                    llvm::FunctionType::get(i32_t, do_batch_args_t, false));
+
+    std::vector<llvm::Value *> args;
+    llvm::Function::arg_iterator arg = wrapper_func->arg_begin();
+    args.push_back(iterator_to_pointer(arg++));
+    args.push_back(argv_fn);
+    for (; arg != wrapper_func->arg_end(); arg++) {
+        args.push_back(iterator_to_pointer(arg));
+    }
+    llvm::CallInst *result = builder->CreateCall(do_batch, args);
+    builder->CreateRet(result);
+
+    internal_assert(!verifyFunction(*wrapper_func, &llvm::errs()));
+    return wrapper_func;
+}
+
+// Make the functions that create and destroy the persistent workspace
+// of a pipeline. They forward to the runtime, which keys the workspace
+// on the user context and the pipeline name.
+void CodeGen_LLVM::add_workspace_wrappers(const std::string &pipeline_name,
+                                          const std::string &create_name,
+                                          const std::string &destroy_name) {
+    llvm::Type *create_args_t[] = {ptr_t, i64_t};
+    llvm::FunctionType *create_func_t = llvm::FunctionType::get(ptr_t, create_args_t, false);
+    llvm::Function *create_func = llvm::Function::Create(create_func_t, llvm::GlobalValue::ExternalLinkage, create_name, module.get());
+    builder->SetInsertPoint(llvm::BasicBlock::Create(module->getContext(), "entry", create_func));
+
+    llvm::Type *runtime_create_args_t[] = {ptr_t, ptr_t, i64_t};
+    llvm::FunctionCallee runtime_create =
+        module->getOrInsertFunction("halide_workspace_create",
+                                    llvm::FunctionType::get(ptr_t, runtime_create_args_t, false));
+    llvm::Value *create_args[] = {iterator_to_pointer(create_func->arg_begin()),
+                                  create_string_constant(pipeline_name),
+                                  iterator_to_pointer(create_func->arg_begin() + 1)};
+    builder->CreateRet(builder->CreateCall(runtime_create, create_args));
+    internal_assert(!verifyFunction(*create_func, &llvm::errs()));
+
+    llvm::Type *destroy_args_t[] = {ptr_t, ptr_t};
+    llvm::FunctionType *destroy_func_t = llvm::FunctionType::get(void_t, destroy_args_t, false);
+    llvm::Function *destroy_func = llvm::Function::Create(destroy_func_t, llvm::GlobalValue::ExternalLinkage, destroy_name, module.get());
+    builder->SetInsertPoint(llvm::BasicBlock::Create(module->getContext(), "entry", destroy_func));
+
+    llvm::FunctionCallee runtime_destroy =
+        module->getOrInsertFunction("halide_workspace_destroy", destroy_func_t);
+    llvm::Value *destroy_args[] = {iterator_to_pointer(destroy_func->arg_begin()),
+                                   iterator_to_pointer(destroy_func->arg_begin() + 1)};
+    builder->CreateCall(runtime_destroy, destroy_args);
+    builder->CreateRetVoid();
+    internal_assert(!verifyFunction(*destroy_func, &llvm::errs()));
+}
+
 llvm::Function *CodeGen_LLVM::embed_metadata_getter(const std::string &metadata_name,
                                                     const std::string &function_name, const std::vector<LoweredArgument> &args,
                                                     const MetadataNameMap &metadata_name_map) {
@@ -3325,6 +3419,13 @@ void CodeGen_LLVM::visit(const Call *op) {
 
         // Prefetch evaluates to zero of the prefetched type.
         value = codegen(make_zero(op->type));
+    } else if (op->is_intrinsic(Call::nontemporal_store)) {
+        // Only meaningful as the value of a Store, where it is peeled
+        // off before we get here.
+        value = codegen(op->args[0]);
+    } else if (op->is_intrinsic(Call::store_fence)) {
+        builder->CreateFence(AtomicOrdering::Release);
+        value = ConstantInt::get(i32_t, 0);
     } else if (op->is_intrinsic(Call::signed_integer_overflow)) {
         user_error << "Signed integer overflow occurred during constant-folding. Signed"
                       " integer overflow for int32 and int64 is undefined behavior in"
@@ -3780,6 +3881,12 @@ void CodeGen_LLVM::visit(const For *op) {
 }
 
 void CodeGen_LLVM::visit(const Store *op) {
+    if (const Call *c = Call::as_intrinsic(op->value, {Call::nontemporal_store})) {
+        ScopedValue<bool> old_emit_nontemporal_stores(emit_nontemporal_stores, true);
+        codegen(Store::make(op->name, c->args[0], op->index, op->param, op->predicate, op->alignment));
+        return;
+    }
+
     if (!emit_atomic_stores) {
         // Peel lets off the index to make us more likely to pattern
         // match a ramp.
@@ -3890,6 +3997,15 @@ void CodeGen_LLVM::visit(const Store *op) {
                     } else {
                         StoreInst *store = builder->CreateAlignedStore(slice_val, vec_ptr, llvm::Align(alignment));
                         annotate_store(store, slice_index);
+                        // Non-temporal stores must be aligned to the
+                        // vector width, or llvm turns them back into
+                        // regular stores.
+                        int slice_bytes = slice_lanes * value_type.bytes();
+                        if (emit_nontemporal_stores && slice_lanes > 1 &&
+                            alignment >= std::min(slice_bytes, native_bytes)) {
+                            llvm::Metadata *one = ConstantAsMetadata::get(ConstantInt::get(i32_t, 1));
+                            store->setMetadata(LLVMContext::MD_nontemporal, MDNode::get(*context, {one}));
+                        }
                     }
                 } else if (ramp) {
                     if (get_target().bits == 64 && !stride_val->getType()->isIntegerTy(64)) {
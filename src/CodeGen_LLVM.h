@@ -554,6 +554,9 @@ protected:
     /** Emit atomic store instructions? */
     bool emit_atomic_stores = false;
 
+    /** Emit dense, aligned vector stores as non-temporal stores? */
+    bool emit_nontemporal_stores = false;
+
     /** Can we call this operation with float16 type?
         This is used to avoid "emulated" equivalent code-gen in case target has FP16 feature **/
     virtual bool supports_call_as_float16(const Call *op) const;
@@ -729,6 +732,17 @@ private:
     llvm::Function *add_argv_wrapper(llvm::Function *fn, const std::string &name,
                                      bool result_in_argv, std::vector<bool> &arg_is_buffer);
 
+    /** Add a function with the given name that calls the given argv
+     * wrapper once per entry of an array of argv arrays, distributed
+     * over the thread pool via halide_do_argv_batch. */
+    llvm::Function *add_batch_wrapper(llvm::Function *argv_fn, const std::string &name);
+
+    /** Add the functions with the given names that create and destroy
+     * a persistent workspace for the named pipeline. */
+    void add_workspace_wrappers(const std::string &pipeline_name,
+                                const std::string &create_name,
+                                const std::string &destroy_name);
+
     llvm::Value *codegen_vector_load(const Type &type, const std::string &name, const Expr &base,
                                      const Buffer<> &image, const Parameter &param, const ModulusRemainder &alignment,
                                      llvm::Value *vpred = nullptr, bool slice_to_native = true, llvm::Value *stride = nullptr);
@@ -3,6 +3,7 @@
 #include "ConciseCasts.h"
 #include "ConstantBounds.h"
 #include "Debug.h"
+#include "EmulateFloat16Math.h"
 #include "IRMatch.h"
 #include "IRMutator.h"
 #include "IROperator.h"
@@ -85,6 +86,7 @@ protected:
     string mattrs() const override;
     bool use_soft_float_abi() const override;
     int native_vector_bits() const override;
+    Type upgrade_type_for_arithmetic(const Type &t) const override;
 
     int vector_lanes_for_slice(const Type &t) const;
 
@@ -584,6 +586,16 @@ void CodeGen_X86::visit(const Cast *op) {
 }
 
 void CodeGen_X86::visit(const Call *op) {
+    if (op->is_intrinsic(Call::store_fence)) {
+        // A release fence is free on x86, but non-temporal stores are
+        // weakly ordered, so they need an sfence.
+        llvm::FunctionCallee sfence =
+            module->getOrInsertFunction("llvm.x86.sse.sfence", llvm::FunctionType::get(void_t, false));
+        builder->CreateCall(sfence);
+        value = ConstantInt::get(i32_t, 0);
+        return;
+    }
+
     if (op->is_intrinsic(Call::round)) {
         value = call_overloaded_intrin(op->type, "round", op->args);
         if (value) {
@@ -1095,6 +1107,7 @@ string CodeGen_X86::mattrs() const {
         if (target.has_feature(Target::AVX512_SapphireRapids)) {
             attrs.emplace_back("+amx-int8");
             attrs.emplace_back("+amx-bf16");
+            attrs.emplace_back("+avx512fp16");
         }
     }
     if (gather_might_be_slow(target)) {
@@ -1129,6 +1142,13 @@ bool CodeGen_X86::use_soft_float_abi() const {
     return false;
 }
 
+Type CodeGen_X86::upgrade_type_for_arithmetic(const Type &t) const {
+    if (float16_math_is_native(t, target)) {
+        return t;
+    }
+    return CodeGen_Posix::upgrade_type_for_arithmetic(t);
+}
+
 int CodeGen_X86::native_vector_bits() const {
     if (target.has_feature(Target::AVX10_1)) {
         return target.vector_bits;
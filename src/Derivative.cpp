@@ -1989,4 +1989,66 @@ Derivative propagate_adjoints(const Func &output) {
     return propagate_adjoints(output, adjoint, output_bounds);
 }
 
+namespace {
+
+vector<Func> apply_checkpoints(const vector<Func> &funcs,
+                               const set<string> &stored) {
+    vector<Func> result;
+    for (Func f : funcs) {
+        if (stored.count(f.name())) {
+            f.compute_root();
+            result.push_back(f);
+        } else {
+            f.compute_inline();
+        }
+    }
+    return result;
+}
+
+vector<Func> dependencies(const Func &output) {
+    vector<Func> funcs;
+    for (const auto &it : Internal::find_transitive_calls(output.function())) {
+        if (it.first != output.name()) {
+            funcs.emplace_back(it.second);
+        }
+    }
+    return funcs;
+}
+
+}  // namespace
+
+vector<Func> checkpoint_adjoints(const Func &output,
+                                 const Region &output_bounds,
+                                 int64_t memory_budget) {
+    user_assert(output.dimensions() == (int)output_bounds.size())
+        << "Output bounds of " << output.name() << " have "
+        << output_bounds.size() << " dimensions, but the Func has "
+        << output.dimensions() << ".\n";
+    Internal::Box box;
+    for (const Range &r : output_bounds) {
+        box.push_back(Internal::Interval(r.min, r.min + r.extent - 1));
+    }
+    map<string, Internal::Box> bounds = Internal::inference_bounds(output, box);
+    vector<Func> funcs = dependencies(output);
+    map<string, int64_t> func_bytes;
+    for (const Func &f : funcs) {
+        auto it = bounds.find(f.name());
+        if (it != bounds.end()) {
+            func_bytes[f.name()] = Internal::func_footprint(f, it->second);
+        }
+    }
+    set<string> stored = Internal::choose_checkpoints(funcs, {}, func_bytes, memory_budget);
+    return apply_checkpoints(funcs, stored);
+}
+
+void checkpoint_adjoints(const Func &output,
+                         const vector<Func> &checkpoints) {
+    set<string> names;
+    for (const Func &f : checkpoints) {
+        names.insert(f.name());
+    }
+    vector<Func> funcs = dependencies(output);
+    apply_checkpoints(funcs, Internal::choose_checkpoints(funcs, names, {}, 0));
+}
+
 }  // namespace Halide
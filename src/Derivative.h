@@ -70,6 +70,26 @@ Derivative propagate_adjoints(const Func &output,
  */
 Derivative propagate_adjoints(const Func &output);
 
+/**
+ *  Choose which of the Funcs that output depends on to store for the
+ *  backward pass, so that the gradient fits in memory_budget bytes.
+ *  The chosen Funcs are computed at root, and the rest are recomputed
+ *  inline wherever the forward pass or the adjoints use them, cheapest
+ *  recomputation per byte first. Funcs with update or extern definitions
+ *  are always stored. The bounds of output need to be specified with
+ *  pair {min, extent}. Returns the stored Funcs.
+ */
+std::vector<Func> checkpoint_adjoints(const Func &output,
+                                      const Region &output_bounds,
+                                      int64_t memory_budget);
+/**
+ *  Store the given Funcs for the backward pass, and recompute every
+ *  other Func that output depends on inline. Funcs with update or
+ *  extern definitions are always stored.
+ */
+void checkpoint_adjoints(const Func &output,
+                         const std::vector<Func> &checkpoints);
+
 }  // namespace Halide
 
 #endif
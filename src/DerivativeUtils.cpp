@@ -311,6 +311,116 @@ map<string, Box> inference_bounds(const Func &func,
                             vector<Box>{output_bounds});
 }
 
+namespace {
+
+// Count the IR nodes in each definition of a Func, and the number of
+// times it calls each other Func.
+class CountNodesAndCalls : public IRGraphVisitor {
+    using IRGraphVisitor::include;
+    using IRGraphVisitor::visit;
+
+    void include(const Expr &e) override {
+        nodes++;
+        IRGraphVisitor::include(e);
+    }
+
+    void visit(const Call *op) override {
+        if (op->call_type == Call::Halide) {
+            calls[op->name]++;
+        }
+        IRGraphVisitor::visit(op);
+    }
+
+public:
+    int64_t nodes = 0;
+    map<string, int64_t> &calls;
+
+    explicit CountNodesAndCalls(map<string, int64_t> &calls)
+        : calls(calls) {
+    }
+};
+
+}  // namespace
+
+set<string> choose_checkpoints(const vector<Func> &funcs,
+                               const set<string> &always_store,
+                               const map<string, int64_t> &func_bytes,
+                               int64_t memory_budget) {
+    map<string, int64_t> num_calls, cost;
+    set<string> stored = always_store;
+    for (const Func &f : funcs) {
+        const Function &func = f.function();
+        CountNodesAndCalls counter(num_calls);
+        if (func.has_pure_definition()) {
+            func.definition().accept(&counter);
+        }
+        for (const Definition &def : func.updates()) {
+            def.accept(&counter);
+        }
+        cost[f.name()] = counter.nodes;
+        if (func.has_update_definition() || func.has_extern_definition()) {
+            stored.insert(f.name());
+        }
+        for (const ExternFuncArgument &arg : func.extern_arguments()) {
+            if (arg.is_func()) {
+                stored.insert(Function(arg.func).name());
+            }
+        }
+    }
+
+    struct Candidate {
+        string name;
+        int64_t bytes;
+        double savings;
+    };
+    vector<Candidate> candidates;
+    for (const Func &f : funcs) {
+        auto it = func_bytes.find(f.name());
+        if (stored.count(f.name())) {
+            if (it != func_bytes.end() && it->second > 0) {
+                memory_budget -= it->second;
+            }
+            continue;
+        }
+        if (it == func_bytes.end() || it->second < 0) {
+            continue;
+        }
+        // Each consumer recomputes the whole definition if it's not
+        // stored. The gradient calls it once more.
+        double savings = (double)cost[f.name()] * (num_calls[f.name()] + 1);
+        candidates.push_back({f.name(), it->second, savings / std::max(it->second, (int64_t)1)});
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate &a, const Candidate &b) {
+                         return a.savings > b.savings;
+                     });
+    for (const Candidate &c : candidates) {
+        if (c.bytes <= memory_budget) {
+            stored.insert(c.name);
+            memory_budget -= c.bytes;
+        }
+    }
+    return stored;
+}
+
+int64_t func_footprint(const Func &func, const Box &bounds) {
+    int64_t bytes = 0;
+    for (const Type &t : func.types()) {
+        bytes += t.bytes();
+    }
+    for (const Interval &i : bounds.bounds) {
+        if (!i.is_bounded()) {
+            return -1;
+        }
+        auto extent = as_const_int(simplify(i.max - i.min + 1));
+        if (!extent) {
+            return -1;
+        }
+        bytes *= std::max(*extent, (int64_t)0);
+    }
+    return bytes;
+}
+
 vector<pair<Expr, Expr>> box_to_vector(const Box &bounds) {
     vector<pair<Expr, Expr>> ret;
     ret.reserve(bounds.size());
@@ -55,6 +55,24 @@ std::map<std::string, Box> inference_bounds(const std::vector<Func> &funcs,
                                             const std::vector<Box> &output_bounds);
 std::map<std::string, Box> inference_bounds(const Func &func,
                                             const Box &output_bounds);
+/**
+ * Choose the Funcs to store when memory is limited, so that the others can
+ * be recomputed inline wherever they are called. Funcs in always_store,
+ * Funcs with update or extern definitions, and Funcs passed to extern
+ * stages are always stored. The rest are stored in decreasing order of
+ * the recomputation they save per byte until func_bytes exceeds
+ * memory_budget. Funcs missing from func_bytes are never chosen. Returns
+ * the names of the stored Funcs.
+ */
+std::set<std::string> choose_checkpoints(const std::vector<Func> &funcs,
+                                         const std::set<std::string> &always_store,
+                                         const std::map<std::string, int64_t> &func_bytes,
+                                         int64_t memory_budget);
+/**
+ * The number of bytes a Func takes over the given bounds, or -1 if they
+ * are not constant.
+ */
+int64_t func_footprint(const Func &func, const Box &bounds);
 /**
  * Convert Box to vector of (min, extent)
  */
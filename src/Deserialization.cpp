@@ -7,11 +7,15 @@
 #include "Function.h"
 #include "IR.h"
 #include "Schedule.h"
+#include "Util.h"
 #include "halide_ir.fbs.h"
 
+#include <algorithm>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <numeric>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -36,6 +40,11 @@ public:
     // Deserialize a pipeline from the given buffer of bytes
     Pipeline deserialize(const std::vector<uint8_t> &data);
 
+    // Deserialize a pipeline from the given filename by memory-mapping it. The
+    // contents of buffers are wrapped in place, and each such buffer keeps the
+    // mapping it points into alive
+    Pipeline deserialize_mapped(const std::string &filename);
+
     // Deserialize just the unbound external parameters that need to be defined for the pipeline from the given filename
     // (so they can be remapped and overridden with user parameters prior to deserializing the pipeline)
     std::map<std::string, Parameter> deserialize_parameters(const std::string &filename);
@@ -78,6 +87,19 @@ private:
     // Default external parameters that were created during deserialization
     std::map<std::string, Parameter> external_params;
 
+    // The file being deserialized, if any, which the external data is relative to
+    std::string filename;
+
+    // Whether to wrap the contents of buffers in place rather than copy them, and
+    // the mapped files they are wrapped in: the pipeline itself, then the external data
+    bool map_buffers = false;
+    std::vector<std::shared_ptr<MappedFile>> mappings;
+
+    // Where the contents of large buffers are stored, if not in the pipeline
+    std::string external_data_filename;
+
+    Pipeline deserialize(const uint8_t *data);
+
     MemoryType deserialize_memory_type(Serialize::MemoryType memory_type);
 
     ForType deserialize_for_type(Serialize::ForType for_type);
@@ -98,6 +120,8 @@ private:
 
     Split::SplitType deserialize_split_type(Serialize::SplitType split_type);
 
+    FuseOrder deserialize_fuse_order(Serialize::FuseOrder fuse_order);
+
     DimType deserialize_dim_type(Serialize::DimType dim_type);
 
     LoopAlignStrategy deserialize_loop_align_strategy(Serialize::LoopAlignStrategy loop_align_strategy);
@@ -374,6 +398,20 @@ Split::SplitType Deserializer::deserialize_split_type(Serialize::SplitType split
     }
 }
 
+FuseOrder Deserializer::deserialize_fuse_order(Serialize::FuseOrder fuse_order) {
+    switch (fuse_order) {
+    case Serialize::FuseOrder::Lexicographic:
+        return FuseOrder::Lexicographic;
+    case Serialize::FuseOrder::Morton:
+        return FuseOrder::Morton;
+    case Serialize::FuseOrder::Hilbert:
+        return FuseOrder::Hilbert;
+    default:
+        user_error << "unknown fuse order " << (int)fuse_order << "\n";
+        return FuseOrder::Lexicographic;
+    }
+}
+
 DimType Deserializer::deserialize_dim_type(Serialize::DimType dim_type) {
     switch (dim_type) {
     case Serialize::DimType::PureVar:
@@ -1017,6 +1055,7 @@ FuncSchedule Deserializer::deserialize_func_schedule(const Serialize::FuncSchedu
     const auto async = func_schedule->async();
     const auto ring_buffer = deserialize_expr(func_schedule->ring_buffer_type(), func_schedule->ring_buffer());
     const auto memoize_eviction_key = deserialize_expr(func_schedule->memoize_eviction_key_type(), func_schedule->memoize_eviction_key());
+    const auto store_nontemporal = func_schedule->store_nontemporal();
     auto hl_func_schedule = FuncSchedule();
     hl_func_schedule.store_level() = store_level;
     hl_func_schedule.compute_level() = compute_level;
@@ -1030,6 +1069,7 @@ FuncSchedule Deserializer::deserialize_func_schedule(const Serialize::FuncSchedu
     hl_func_schedule.async() = async;
     hl_func_schedule.ring_buffer() = ring_buffer;
     hl_func_schedule.memoize_eviction_key() = memoize_eviction_key;
+    hl_func_schedule.store_nontemporal() = store_nontemporal;
     return hl_func_schedule;
 }
 
@@ -1124,6 +1164,7 @@ Split Deserializer::deserialize_split(const Serialize::Split *split) {
     const auto exact = split->exact();
     const auto tail = deserialize_tail_strategy(split->tail());
     const auto split_type = deserialize_split_type(split->split_type());
+    const auto fuse_order = deserialize_fuse_order(split->fuse_order());
     auto hl_split = Split();
     hl_split.old_var = old_var;
     hl_split.outer = outer;
@@ -1132,6 +1173,7 @@ Split Deserializer::deserialize_split(const Serialize::Split *split) {
     hl_split.exact = exact;
     hl_split.tail = tail;
     hl_split.split_type = split_type;
+    hl_split.fuse_order = fuse_order;
     return hl_split;
 }
 
@@ -1311,36 +1353,65 @@ Buffer<> Deserializer::deserialize_buffer(const Serialize::Buffer *buffer) {
     const auto type = deserialize_type(buffer->type());
     const int32_t dimensions = buffer->dimensions();
     std::vector<halide_dimension_t> hl_buffer_dimensions;
-    std::vector<halide_dimension_t> dense_buffer_dimensions;
     hl_buffer_dimensions.reserve(dimensions);
-    dense_buffer_dimensions.reserve(dimensions);
-    int32_t stride = -1;
     for (int i = 0; i < dimensions; ++i) {
         const auto *dim = buffer->dims()->Get(i);
-        halide_dimension_t hl_dim, dense_dim;
+        halide_dimension_t hl_dim;
         hl_dim.min = dim->min();
         hl_dim.extent = dim->extent();
         hl_dim.stride = dim->stride();
         hl_buffer_dimensions.push_back(hl_dim);
-        dense_dim.min = hl_dim.min;
-        dense_dim.extent = hl_dim.extent;
-        if (i == 0) {
-            dense_dim.stride = hl_dim.stride;
-            stride = hl_dim.stride * hl_dim.extent;
-        } else {
-            dense_dim.stride = stride;
-            stride *= hl_dim.extent;
+    }
+    // The contents are compact, with the dimensions in the same order of
+    // stride as the original buffer (see Buffer::copy)
+    std::vector<int> order(dimensions);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return hl_buffer_dimensions[a].stride < hl_buffer_dimensions[b].stride;
+    });
+    uint64_t size = type.bytes();
+    for (int i : order) {
+        hl_buffer_dimensions[i].stride = (int32_t)(size / type.bytes());
+        size *= hl_buffer_dimensions[i].extent;
+    }
+
+    const uint8_t *data = nullptr;
+    if (buffer->external_size() > 0) {
+        user_assert(buffer->external_size() == size)
+            << "buffer " << name << " has " << buffer->external_size() << " bytes of data instead of " << size << "\n";
+        user_assert(!external_data_filename.empty()) << "buffer " << name << " refers to missing external data\n";
+        const std::string path = resolve_relative_path(filename, external_data_filename);
+        if (!map_buffers) {
+            Buffer<> hl_buffer(type, nullptr, dimensions, hl_buffer_dimensions.data(), name);
+            hl_buffer.allocate();
+            std::ifstream in(path, std::ios::binary | std::ios::in);
+            in.seekg(buffer->external_offset());
+            in.read((char *)hl_buffer.data(), size);
+            user_assert(in.good()) << "failed to read the data of buffer " << name << " from " << path << "\n";
+            return hl_buffer;
+        }
+        if (mappings.size() < 2) {
+            mappings.push_back(std::make_shared<MappedFile>(path));
         }
-        dense_buffer_dimensions.push_back(dense_dim);
-    }
-    // To handle cropped buffer, we create a dense buffer and serialize into it,
-    // then create a (potential sparse) buffer with orignal dimension infos and copy from the dense buffer
-    auto fake_dense_buffer = Buffer<>(type, nullptr, dimensions, dense_buffer_dimensions.data(), name + "_dense_fake");
-    auto dense_buffer = Buffer<>::make_with_shape_of(fake_dense_buffer, nullptr, nullptr, name + "_dense_tmp");
-    memcpy(dense_buffer.data(), buffer->data()->data(), buffer->data()->size());
-    auto fake_buffer = Buffer<>(type, nullptr, dimensions, hl_buffer_dimensions.data(), name + "_fake");
-    auto hl_buffer = Buffer<>::make_with_shape_of(fake_buffer, nullptr, nullptr, name);
-    hl_buffer.copy_from(dense_buffer);
+        user_assert(buffer->external_offset() + size <= mappings.back()->size())
+            << "the data of buffer " << name << " is past the end of " << path << "\n";
+        data = mappings.back()->data() + buffer->external_offset();
+    } else {
+        user_assert(buffer->data() != nullptr && buffer->data()->size() == size)
+            << "buffer " << name << " has the wrong amount of data\n";
+        data = buffer->data()->data();
+    }
+
+    if (map_buffers && (uintptr_t)data % type.bytes() == 0) {
+        // The mapping is private, so it's safe to write to: the pages
+        // written to are copied then.
+        Buffer<> hl_buffer(type, const_cast<uint8_t *>(data), dimensions, hl_buffer_dimensions.data(), name);
+        hl_buffer.set_host_owner(buffer->external_size() > 0 ? mappings.back() : mappings[0]);
+        return hl_buffer;
+    }
+    Buffer<> hl_buffer(type, nullptr, dimensions, hl_buffer_dimensions.data(), name);
+    hl_buffer.allocate();
+    memcpy(hl_buffer.data(), data, size);
     return hl_buffer;
 }
 
@@ -1375,6 +1446,7 @@ void Deserializer::build_reverse_function_mappings(const std::vector<Function> &
 }
 
 Pipeline Deserializer::deserialize(const std::string &filename) {
+    this->filename = filename;
     std::ifstream in(filename, std::ios::binary | std::ios::in);
     if (!in) {
         user_error << "failed to open file " << filename << "\n";
@@ -1403,7 +1475,19 @@ Pipeline Deserializer::deserialize(std::istream &in) {
 }
 
 Pipeline Deserializer::deserialize(const std::vector<uint8_t> &data) {
-    const auto *pipeline_obj = Serialize::GetPipeline(data.data());
+    return deserialize(data.data());
+}
+
+Pipeline Deserializer::deserialize_mapped(const std::string &filename) {
+    this->filename = filename;
+    map_buffers = true;
+    mappings.push_back(std::make_shared<MappedFile>(filename));
+    user_assert(mappings[0]->size() > 0) << "failed to deserialize from file " << filename << " properly\n";
+    return deserialize(mappings[0]->data());
+}
+
+Pipeline Deserializer::deserialize(const uint8_t *data) {
+    const auto *pipeline_obj = Serialize::GetPipeline(data);
     if (pipeline_obj == nullptr) {
         user_warning << "deserialized pipeline is empty\n";
         return Pipeline();
@@ -1443,6 +1527,10 @@ Pipeline Deserializer::deserialize(const std::vector<uint8_t> &data) {
     }
     build_reverse_function_mappings(functions);
 
+    if (pipeline_obj->external_data() != nullptr) {
+        external_data_filename = deserialize_string(pipeline_obj->external_data());
+    }
+
     // Buffers need to be deserialized first as Parameters may reference them
     const std::vector<Buffer<>> buffers =
         deserialize_vector<Serialize::Buffer, Buffer<>>(pipeline_obj->buffers(),
@@ -1561,6 +1649,11 @@ Pipeline deserialize_pipeline(const std::vector<uint8_t> &buffer, const std::map
     return deserializer.deserialize(buffer);
 }
 
+Pipeline deserialize_pipeline_mapped(const std::string &filename, const std::map<std::string, Parameter> &user_params) {
+    Internal::Deserializer deserializer(user_params);
+    return deserializer.deserialize_mapped(filename);
+}
+
 std::map<std::string, Parameter> deserialize_parameters(const std::string &filename) {
     Internal::Deserializer deserializer;
     return deserializer.deserialize_parameters(filename);
@@ -1597,6 +1690,11 @@ Pipeline deserialize_pipeline(const std::vector<uint8_t> &buffer, const std::map
     return Pipeline();
 }
 
+Pipeline deserialize_pipeline_mapped(const std::string &filename, const std::map<std::string, Parameter> &user_params) {
+    user_error << "Deserialization is not supported in this build of Halide; try rebuilding with WITH_SERIALIZATION=ON.";
+    return Pipeline();
+}
+
 std::map<std::string, Parameter> deserialize_parameters(const std::string &filename) {
     user_error << "Deserialization is not supported in this build of Halide; try rebuilding with WITH_SERIALIZATION=ON.";
     return {};
@@ -25,6 +25,16 @@ Pipeline deserialize_pipeline(std::istream &in, const std::map<std::string, Para
 /// @return Returns a newly constructed deserialized Pipeline object/
 Pipeline deserialize_pipeline(const std::vector<uint8_t> &data, const std::map<std::string, Parameter> &user_params);
 
+/// @brief Deserialize a Halide pipeline from a file by memory-mapping it, rather than reading it. The contents of its
+///        buffers, including any stored in a separate file, are used in place rather than copied, so they are only
+///        read from disk as they are used. The mapping is private: writing to a buffer copies the pages written to,
+///        and never modifies the file. Each buffer that points into a file keeps it mapped for as long as the buffer
+///        is used, by the pipeline or by anything compiled from it.
+/// @param filename The location of the file to deserialize.  Must use .hlpipe extension.
+/// @param user_params Map of named input/output parameters to bind with the resulting pipeline (used to avoid deserializing specific objects and enable the use of externally defined ones instead).
+/// @return Returns a newly constructed deserialized Pipeline object/
+Pipeline deserialize_pipeline_mapped(const std::string &filename, const std::map<std::string, Parameter> &user_params);
+
 /// @brief Deserialize the extenal parameters for the Halide pipeline from a file.
 ///        This method allows a minimal deserialization of just the external pipeline parameters, so they can be
 ///        remapped and overridden with user parameters prior to deserializing the pipeline definition.
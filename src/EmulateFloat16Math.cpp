@@ -4,6 +4,7 @@
 #include "IROperator.h"
 #include "Lerp.h"
 #include "Simplify.h"
+#include "Target.h"
 
 namespace Halide {
 namespace Internal {
@@ -192,5 +193,152 @@ Expr lower_float16_cast(const Cast *op) {
     return cast(dst, val);
 }
 
+bool float16_math_is_native(const Type &t, const Target &target) {
+    // Only IEEE half arithmetic has native support. No supported target
+    // has bfloat16 arithmetic beyond conversions and dot products.
+    if (t.code() != Type::Float || t.bits() != 16) {
+        return false;
+    }
+    switch (target.arch) {
+    case Target::ARM:
+        return target.has_feature(Target::ARMFp16);
+    case Target::X86:
+        return target.has_feature(Target::AVX512_SapphireRapids);
+    default:
+        return false;
+    }
+}
+
+namespace {
+
+class WidenFloat16Math : public IRMutator {
+    using IRMutator::visit;
+
+    const Target &target;
+
+    bool is_emulated(const Type &t) const {
+        return (t.is_bfloat() || (t.is_float() && t.bits() < 32)) &&
+               !float16_math_is_native(t, target);
+    }
+
+    // Compute the value of a tree of emulated arithmetic in float32,
+    // without rounding any of the intermediates.
+    Expr widen(const Expr &e) {
+        if (!is_emulated(e.type())) {
+            return mutate(e);
+        }
+        Type wide = Float(32, e.type().lanes());
+        if (const Add *op = e.as<Add>()) {
+            return Add::make(widen(op->a), widen(op->b));
+        } else if (const Sub *op = e.as<Sub>()) {
+            return Sub::make(widen(op->a), widen(op->b));
+        } else if (const Mul *op = e.as<Mul>()) {
+            return Mul::make(widen(op->a), widen(op->b));
+        } else if (const Div *op = e.as<Div>()) {
+            return Div::make(widen(op->a), widen(op->b));
+        } else if (const Min *op = e.as<Min>()) {
+            return Min::make(widen(op->a), widen(op->b));
+        } else if (const Max *op = e.as<Max>()) {
+            return Max::make(widen(op->a), widen(op->b));
+        } else if (const Select *op = e.as<Select>()) {
+            return Select::make(mutate(op->condition), widen(op->true_value), widen(op->false_value));
+        } else if (const Broadcast *op = e.as<Broadcast>()) {
+            return Broadcast::make(widen(op->value), op->lanes);
+        } else if (const FloatImm *op = e.as<FloatImm>()) {
+            // Already rounded to 16 bits, so exactly representable.
+            return FloatImm::make(wide, op->value);
+        } else {
+            // Loads, calls, casts, and variables are where values
+            // enter the tree, already rounded.
+            return Cast::make(wide, mutate(e));
+        }
+    }
+
+    // Count the operations in a tree of emulated arithmetic that
+    // would each round their result.
+    int count_rounding_ops(const Expr &e) const {
+        if (!is_emulated(e.type())) {
+            return 0;
+        }
+        if (const Add *op = e.as<Add>()) {
+            return 1 + count_rounding_ops(op->a) + count_rounding_ops(op->b);
+        } else if (const Sub *op = e.as<Sub>()) {
+            return 1 + count_rounding_ops(op->a) + count_rounding_ops(op->b);
+        } else if (const Mul *op = e.as<Mul>()) {
+            return 1 + count_rounding_ops(op->a) + count_rounding_ops(op->b);
+        } else if (const Div *op = e.as<Div>()) {
+            return 1 + count_rounding_ops(op->a) + count_rounding_ops(op->b);
+        } else if (const Min *op = e.as<Min>()) {
+            return 1 + count_rounding_ops(op->a) + count_rounding_ops(op->b);
+        } else if (const Max *op = e.as<Max>()) {
+            return 1 + count_rounding_ops(op->a) + count_rounding_ops(op->b);
+        } else if (const Select *op = e.as<Select>()) {
+            return count_rounding_ops(op->true_value) + count_rounding_ops(op->false_value);
+        } else if (const Broadcast *op = e.as<Broadcast>()) {
+            return count_rounding_ops(op->value);
+        } else {
+            return 0;
+        }
+    }
+
+    template<typename T>
+    Expr visit_arithmetic(const T *op) {
+        // A single operation already rounds only once.
+        if (count_rounding_ops(op) > 1) {
+            return Cast::make(op->type, widen(op));
+        } else {
+            return IRMutator::visit(op);
+        }
+    }
+
+    Expr visit(const Add *op) override {
+        return visit_arithmetic(op);
+    }
+
+    Expr visit(const Sub *op) override {
+        return visit_arithmetic(op);
+    }
+
+    Expr visit(const Mul *op) override {
+        return visit_arithmetic(op);
+    }
+
+    Expr visit(const Div *op) override {
+        return visit_arithmetic(op);
+    }
+
+    Expr visit(const Min *op) override {
+        return visit_arithmetic(op);
+    }
+
+    Expr visit(const Max *op) override {
+        return visit_arithmetic(op);
+    }
+
+    Expr visit(const Select *op) override {
+        return visit_arithmetic(op);
+    }
+
+    Stmt visit(const For *op) override {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // Device code has its own float16 support.
+            return op;
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    WidenFloat16Math(const Target &target)
+        : target(target) {
+    }
+};
+
+}  // namespace
+
+Stmt widen_float16_math(const Stmt &s, const Target &t) {
+    return WidenFloat16Math(t).mutate(s);
+}
+
 }  // namespace Internal
 }  // namespace Halide
@@ -9,6 +9,9 @@
 #include "IR.h"
 
 namespace Halide {
+
+struct Target;
+
 namespace Internal {
 
 /** Check if a call is a float16 transcendental (e.g. sqrt_f16) */
@@ -26,6 +29,16 @@ Expr bfloat16_to_float32(Expr e);
 Expr lower_float16_cast(const Cast *op);
 //@}
 
+/** Check if the target does arithmetic on the given (b)float16 type
+ * natively, rather than by widening each operation to float32. */
+bool float16_math_is_native(const Type &t, const Target &target);
+
+/** Compute each tree of (b)float16 arithmetic that the target would
+ * emulate entirely in float32, rounding to 16 bits only at its root,
+ * where the value is stored, bound to a name, or passed to a call.
+ * This changes results, because intermediates are no longer rounded. */
+Stmt widen_float16_math(const Stmt &s, const Target &t);
+
 }  // namespace Internal
 }  // namespace Halide
 
@@ -1070,6 +1070,51 @@ Func Stage::rfactor(const vector<pair<RVar, Var>> &preserved) {
     return intm;
 }
 
+Func Stage::privatize(const RVar &r, const Expr &num_tasks, int vector_width) {
+    user_assert(!definition.is_init()) << "privatize() must be called on an update definition\n";
+    user_assert(vector_width >= 1) << "The vector width passed to privatize() must be positive\n";
+    user_assert(vector_width == 1 || !dim_vars.empty())
+        << "In schedule for " << name() << ", privatize() can't vectorize the merge of a "
+        << "zero-dimensional Func. Use a vector width of one.\n";
+
+    // Split r into num_tasks pieces, and give each piece its own copy
+    // of this Func.
+    RVar ri;
+    Var u;
+    split(r, r, ri, (r.extent() + num_tasks - 1) / num_tasks, TailStrategy::GuardWithIf);
+    Func intm = rfactor(r, u);
+
+    intm.compute_root().parallel(u);
+    if (vector_width > 1) {
+        intm.vectorize(dim_vars[0], vector_width);
+    }
+    intm.update(0).parallel(u);
+
+    if (dim_vars.empty()) {
+        // A scalar reduction just sums up the private copies serially.
+        return intm;
+    }
+
+    // This definition now merges the private copies, reducing over r.
+    // Merge one vector of each copy at a time.
+    Var x = dim_vars[0];
+    if (vector_width > 1) {
+        Var xi;
+        split(x, x, xi, vector_width, TailStrategy::GuardWithIf);
+        vectorize(xi);
+        reorder(xi, r);
+    }
+    if (dim_vars.size() == 1) {
+        // Amortize the task overhead over a few vectors.
+        const int merge_vectors_per_task = 16;
+        parallel(x, merge_vectors_per_task, TailStrategy::GuardWithIf);
+    } else {
+        parallel(dim_vars.back());
+    }
+
+    return intm;
+}
+
 void Stage::split(const string &old, const string &outer, const string &inner, const Expr &factor, bool exact, TailStrategy tail) {
     debug(4) << "In schedule for " << name() << ", split " << old << " into "
              << outer << " and " << inner << " with factor of " << factor << "\n";
@@ -1292,7 +1337,7 @@ Stage &Stage::split(const VarOrRVar &old, const VarOrRVar &outer, const VarOrRVa
     return *this;
 }
 
-Stage &Stage::fuse(const VarOrRVar &inner, const VarOrRVar &outer, const VarOrRVar &fused) {
+Stage &Stage::fuse(const VarOrRVar &inner, const VarOrRVar &outer, const VarOrRVar &fused, FuseOrder order) {
     definition.schedule().touched() = true;
     if (!fused.is_rvar) {
         user_assert(!outer.is_rvar) << "Can't fuse Var " << fused.name()
@@ -1312,6 +1357,10 @@ Stage &Stage::fuse(const VarOrRVar &inner, const VarOrRVar &outer, const VarOrRV
     DimType outer_type = DimType::PureRVar;
     for (size_t i = 0; (!found_outer) && i < dims.size(); i++) {
         if (dim_match(dims[i], outer)) {
+            user_assert(order == FuseOrder::Lexicographic || dims[i].dim_type != DimType::ImpureRVar)
+                << "In schedule for " << name() << ", can't fuse " << outer.name()
+                << " along a space-filling curve, because it is an RVar whose "
+                << "iterations can't be reordered.\n";
             found_outer = true;
             outer_name = dims[i].var;
             outer_type = dims[i].dim_type;
@@ -1333,6 +1382,11 @@ Stage &Stage::fuse(const VarOrRVar &inner, const VarOrRVar &outer, const VarOrRV
             fused_name = inner_name + "." + fused.name();
             dims[i].var = fused_name;
 
+            user_assert(order == FuseOrder::Lexicographic || dims[i].dim_type != DimType::ImpureRVar)
+                << "In schedule for " << name() << ", can't fuse " << inner.name()
+                << " along a space-filling curve, because it is an RVar whose "
+                << "iterations can't be reordered.\n";
+
             if (dims[i].dim_type == DimType::ImpureRVar ||
                 outer_type == DimType::ImpureRVar) {
                 dims[i].dim_type = DimType::ImpureRVar;
@@ -1358,7 +1412,7 @@ Stage &Stage::fuse(const VarOrRVar &inner, const VarOrRVar &outer, const VarOrRV
     }
 
     // Add the fuse to the splits list
-    Split split = {fused_name, outer_name, inner_name, Expr(), true, TailStrategy::RoundUp, Split::FuseVars};
+    Split split = {fused_name, outer_name, inner_name, Expr(), true, TailStrategy::RoundUp, Split::FuseVars, order};
     definition.schedule().splits().push_back(split);
     return *this;
 }
@@ -2294,9 +2348,9 @@ Func &Func::split(const VarOrRVar &old, const VarOrRVar &outer, const VarOrRVar
     return *this;
 }
 
-Func &Func::fuse(const VarOrRVar &inner, const VarOrRVar &outer, const VarOrRVar &fused) {
+Func &Func::fuse(const VarOrRVar &inner, const VarOrRVar &outer, const VarOrRVar &fused, FuseOrder order) {
     invalidate_cache();
-    Stage(func, func.definition(), 0).fuse(inner, outer, fused);
+    Stage(func, func.definition(), 0).fuse(inner, outer, fused, order);
     return *this;
 }
 
@@ -2370,6 +2424,12 @@ Func &Func::async() {
     return *this;
 }
 
+Func &Func::store_nontemporal() {
+    invalidate_cache();
+    func.schedule().store_nontemporal() = true;
+    return *this;
+}
+
 Func &Func::ring_buffer(Expr extent) {
     invalidate_cache();
     func.schedule().ring_buffer() = std::move(extent);
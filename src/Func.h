@@ -191,6 +191,44 @@ public:
     Func rfactor(const RVar &r, const Var &v);
     // @}
 
+    /** Privatize the target of an associative update definition, such as
+     * a histogram or a scatter, across parallel tasks, instead of making
+     * the updates atomic. The RVar 'r' is split into num_tasks pieces,
+     * and the update is rfactored over the piece index. The returned
+     * intermediate Func is computed at root, holds one private copy of
+     * this Func per task, and has its update parallelized over the tasks.
+     * This update definition becomes a merge of the private copies that
+     * is vectorized by 'vector_width' along the innermost pure dimension
+     * and parallelized along the outermost one. For a zero-dimensional
+     * Func, such as a sum over an image, the merge is serial and
+     * 'vector_width' must be one. As with rfactor(), this throws an error
+     * if the update can't be proven associative.
+     *
+     * For example, for a histogram:
+     \code
+     hist(x) = 0;
+     hist(clamp(im(r.x, r.y), 0, 255)) += 1;
+     hist.update().privatize(r.y, 8, 8);
+     \endcode
+     * is equivalent to:
+     \code
+     parallel for u = 0 to 7:
+       for x:
+         hist_intm(x, u) = 0
+     parallel for u = 0 to 7:
+       for r.yi:
+         for r.x:
+           hist_intm(clamp(im(r.x, u * ceil(height / 8) + r.yi), 0, 255), u) += 1
+     for x:
+       hist(x) = 0
+     parallel for x.xo:
+       for r.yo = 0 to 7:
+         vectorized x.xi = 0 to 7:
+           hist(x) += hist_intm(x, r.yo)
+     \endcode
+     */
+    Func privatize(const RVar &r, const Expr &num_tasks, int vector_width = 1);
+
     /** Schedule the iteration over this stage to be fused with another
      * stage 's' from outermost loop to a given LoopLevel. 'this' stage will
      * be computed AFTER 's' in the innermost fused dimension. There should not
@@ -343,7 +381,7 @@ public:
     // @{
 
     Stage &split(const VarOrRVar &old, const VarOrRVar &outer, const VarOrRVar &inner, const Expr &factor, TailStrategy tail = TailStrategy::Auto);
-    Stage &fuse(const VarOrRVar &inner, const VarOrRVar &outer, const VarOrRVar &fused);
+    Stage &fuse(const VarOrRVar &inner, const VarOrRVar &outer, const VarOrRVar &fused, FuseOrder order = FuseOrder::Lexicographic);
     Stage &serial(const VarOrRVar &var);
     Stage &parallel(const VarOrRVar &var);
     Stage &vectorize(const VarOrRVar &var);
@@ -1415,8 +1453,29 @@ public:
     /** Join two dimensions into a single fused dimension. The fused dimension
      * covers the product of the extents of the inner and outer dimensions
      * given. The loop type (e.g. parallel, vectorized) of the resulting fused
-     * dimension is inherited from the first argument. */
-    Func &fuse(const VarOrRVar &inner, const VarOrRVar &outer, const VarOrRVar &fused);
+     * dimension is inherited from the first argument.
+     *
+     * By default the fused dimension visits the pairs of values in the
+     * same order as the loop nest it replaces. Passing FuseOrder::Morton
+     * or FuseOrder::Hilbert instead visits them along a space-filling
+     * curve, which keeps consecutive iterations close together in both
+     * dimensions. This is most useful when fusing the two outer
+     * dimensions of a tiling, so that neighbouring tiles (and the
+     * producers they share) are computed close together in time:
+     \code
+     f.tile(x, y, xo, yo, xi, yi, 32, 32)
+      .fuse(xo, yo, tile, FuseOrder::Hilbert)
+      .parallel(tile);
+     \endcode
+     * The extents of the two dimensions need not be equal, or powers of
+     * two. The curve is laid out over square blocks whose side is the
+     * smaller extent rounded up to a power of two, and the iterations
+     * that fall outside the original domain are skipped. The smaller
+     * extent may be at most 2^15, and the padded extent of the fused
+     * dimension must fit in an int32; this is checked at runtime.
+     * Dimensions that can't be reordered, such as impure RVars, can
+     * only be fused in lexicographic order. */
+    Func &fuse(const VarOrRVar &inner, const VarOrRVar &outer, const VarOrRVar &fused, FuseOrder order = FuseOrder::Lexicographic);
 
     /** Mark a dimension to be traversed serially. This is the default. */
     Func &serial(const VarOrRVar &var);
@@ -2278,6 +2337,21 @@ public:
      */
     Func &async();
 
+    /** Write the values of this Func with non-temporal (streaming)
+     * stores, which bypass the cache instead of allocating cache lines
+     * for the destination. This is useful for large outputs that are
+     * written once and not read again by the pipeline, such as the
+     * final stage of a pipeline, where the usual stores would evict
+     * data that is still needed and waste memory bandwidth reading in
+     * lines that are about to be overwritten. Only dense vector stores
+     * that are known to be aligned to the vector width are affected, so
+     * this should be combined with vectorizing the innermost storage
+     * dimension and, for inputs and outputs, an alignment
+     * constraint. A store fence is issued at the end of the production
+     * of the Func, and at the end of each iteration of any parallel
+     * loop within it. Stores made on a GPU are unaffected. */
+    Func &store_nontemporal();
+
     /** Expands the storage of the function by an extra dimension
      * to enable ring buffering. For this to be useful the storage
      * of the function has to be hoisted to an upper loop level using
@@ -1,8 +1,14 @@
+#include <algorithm>
 #include <atomic>
 #include <cmath>
 #include <condition_variable>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <random>
 #include <unordered_map>
 #include <utility>
 
@@ -637,6 +643,13 @@ std::string halide_type_to_c_type(const Type &t) {
 
 namespace {
 
+// The shared libraries loaded with -p. They may contain autoschedulers,
+// so the generator output cache has to know about them.
+std::vector<std::string> &loaded_plugins() {
+    static std::vector<std::string> plugins;
+    return plugins;
+}
+
 int generate_filter_main_inner(int argc,
                                char **argv,
                                const GeneratorFactoryProvider &generator_factory_provider) {
@@ -677,6 +690,13 @@ gengen
      infinite time. Defaults to infinite.
 
  -v  If nonzero, log the path to all generated files to stdout.
+
+ If the environment variable HL_GENERATOR_CACHE_DIR is set, outputs for a single
+ target are cached in that directory, keyed on the serialized pipeline, the
+ generator params, the target, and the build of libHalide, and copied from
+ there by later runs with the same key instead of being compiled again. Set
+ HL_GENERATOR_CACHE_SIZE to cap the cache at that many megabytes; the least
+ recently used entries are evicted first.
 )INLINE_CODE";
 
     std::map<std::string, std::string> flags_info = {
@@ -719,6 +739,7 @@ gengen
     for (const auto &lib_path : split_string(flags_info["-p"], ",")) {
         if (!lib_path.empty()) {
             load_plugin(lib_path);
+            loaded_plugins().push_back(lib_path);
         }
     }
 
@@ -976,6 +997,381 @@ int generate_filter_main(int argc, char **argv) {
     return generate_filter_main(argc, argv, GeneratorsFromRegistry());
 }
 
+namespace {
+
+// A 128-bit hash of everything that determines the outputs of a
+// Generator, made of two 64-bit FNV-1a-style hashes with different
+// multipliers. They take 8 bytes at a time, folding the high bits of each
+// product back down, so that hashing all of libHalide is quick.
+class GeneratorCacheKey {
+    uint64_t h[2] = {0xcbf29ce484222325ULL, 0x84222325cbf29ce4ULL};
+
+    void add_word(uint64_t w) {
+        h[0] = (h[0] ^ w) * 0x100000001b3ULL;
+        h[0] ^= h[0] >> 29;
+        h[1] = (h[1] ^ w) * 0xff51afd7ed558ccdULL;
+        h[1] ^= h[1] >> 31;
+    }
+
+public:
+    void add_bytes(const void *data, size_t size) {
+        const uint8_t *bytes = (const uint8_t *)data;
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t w;
+            memcpy(&w, bytes + i, sizeof(w));
+            add_word(w);
+        }
+        for (; i < size; i++) {
+            add_word(bytes[i]);
+        }
+    }
+
+    void add(uint64_t x) {
+        add_bytes(&x, sizeof(x));
+    }
+
+    // Strings are length-prefixed so that adjacent ones can't run together.
+    void add(const std::string &s) {
+        add((uint64_t)s.size());
+        add_bytes(s.data(), s.size());
+    }
+
+    // Identify a file by its contents, not its path or modification time,
+    // so that an identical file rebuilt elsewhere (e.g. a relinked
+    // generator in a new build directory) gives the same key.
+    void add_file_contents(const std::string &path) {
+        const bool exists = !path.empty() && file_exists(path);
+        add((uint64_t)exists);
+        if (exists) {
+            add(file_contents_hash(path));
+        }
+    }
+
+    // The hash of a file's contents. They are remembered for the life of
+    // the process, by path, size, and modification time, since the same
+    // large files are hashed for every generator it runs.
+    static std::string file_contents_hash(const std::string &path) {
+        static std::mutex mutex;
+        static std::map<std::string, std::tuple<uint64_t, uint64_t, std::string>> hashes;
+        const FileStat stat = file_stat(path);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &[size, mod_time, hash] = hashes[path];
+        if (hash.empty() || size != stat.file_size || mod_time != (uint64_t)stat.mod_time) {
+            GeneratorCacheKey key;
+            std::ifstream in(path, std::ios::binary);
+            std::vector<char> chunk(1 << 20);
+            while (in) {
+                in.read(chunk.data(), chunk.size());
+                key.add_bytes(chunk.data(), in.gcount());
+            }
+            size = stat.file_size;
+            mod_time = (uint64_t)stat.mod_time;
+            hash = key.to_string();
+        }
+        return hash;
+    }
+
+    std::string to_string() const {
+        std::ostringstream s;
+        s << std::hex << std::setfill('0') << std::setw(16) << h[0] << std::setw(16) << h[1];
+        return s.str();
+    }
+};
+
+// The cache only handles the simple case of one target: multitarget
+// builds produce an extra object per target. The compiler log is
+// skipped because it is meant to describe an actual compilation.
+bool generator_outputs_are_cacheable(const ExecuteGeneratorArgs &args) {
+    if (args.targets.size() != 1 ||
+        args.output_types.count(OutputFileType::compiler_log) ||
+        !get_env_variable("HL_EXTRA_OUTPUTS").empty() ||
+        !get_env_variable("HL_DEBUG_COMPILER_LOGGER").empty()) {
+        debug(1) << "Not using the generator cache for " << args.function_name << "\n";
+        return false;
+    }
+#if !defined(WITH_SERIALIZATION)
+    user_warning << "HL_GENERATOR_CACHE_DIR is ignored because this build of Halide has no serialization support.\n";
+    return false;
+#elif !defined(HALIDE_WITH_EXCEPTIONS)
+    // A pipeline that can't be serialized would abort the build, instead
+    // of falling back to compiling it without the cache.
+    user_warning << "HL_GENERATOR_CACHE_DIR is ignored because this build of Halide has no exception support.\n";
+    return false;
+#else
+    return true;
+#endif
+}
+
+// The cpp_stub and hlpipe outputs are emitted separately, before compilation.
+bool is_cached_output(OutputFileType type) {
+    return type != OutputFileType::cpp_stub && type != OutputFileType::hlpipe;
+}
+
+// Returns an empty key if the outputs for this pipeline can't be cached.
+std::string generator_cache_key(const ExecuteGeneratorArgs &args,
+                                const std::map<OutputFileType, std::string> &output_files,
+                                Pipeline pipeline) {
+    // Custom lowering passes are arbitrary code, which the key can't describe.
+    if (!pipeline.custom_lowering_passes().empty()) {
+        debug(1) << "Not using the generator cache for " << args.function_name
+                 << " because it has custom lowering passes\n";
+        return "";
+    }
+
+    GeneratorCacheKey key;
+
+    // The build of libHalide, and any plugins loaded into it. When
+    // libHalide is a shared library, the generator's own code (which may
+    // call extern functions or add passes that serialization can't see)
+    // lives in the executable instead.
+    key.add(std::to_string(HALIDE_VERSION_MAJOR) + "." +
+            std::to_string(HALIDE_VERSION_MINOR) + "." +
+            std::to_string(HALIDE_VERSION_PATCH));
+    key.add_file_contents(get_libhalide_path());
+    key.add_file_contents(get_executable_path());
+    for (const auto &plugin : loaded_plugins()) {
+        key.add_file_contents(plugin);
+    }
+
+    // What to build. Only the names of the outputs matter, not their
+    // directory: the one thing that depends on it, the include guard of
+    // the headers, is fixed up when they are copied out of the cache.
+    key.add(args.generator_name);
+    key.add(args.function_name);
+    key.add((uint64_t)args.build_mode);
+    key.add(args.targets[0].to_string());
+    for (const auto &[type, path] : output_files) {
+        key.add((uint64_t)type);
+        key.add(std::filesystem::path(path).filename().string());
+    }
+    for (const auto &[name, value] : args.generator_params) {
+        key.add(name);
+        key.add(value);
+    }
+
+    // The environment variables that change what the compiler produces.
+    for (const char *var : {"HL_LLVM_ARGS", "HL_PERMIT_FAILED_UNROLL", "HL_HEXAGON_CODE_SIGNER",
+                            "HL_CYOS", "HL_CYOS_FROM_FILE", "HL_RANDOMIZE_WEIGHTS"}) {
+        key.add(get_env_variable(var));
+    }
+    key.add_file_contents(get_env_variable("HL_PGO_PROFILE"));
+    key.add_file_contents(get_env_variable("HL_STMT_HTML_PROFILE"));
+
+#if defined(WITH_SERIALIZATION) && defined(HALIDE_WITH_EXCEPTIONS)
+    std::vector<uint8_t> data;
+    std::map<std::string, Parameter> params;
+    try {
+        serialize_pipeline(pipeline, data, params);
+    } catch (const CompileError &err) {
+        debug(1) << "Not using the generator cache for " << args.function_name
+                 << " because its pipeline can't be serialized: " << err.what() << "\n";
+        return "";
+    }
+    key.add_bytes(data.data(), data.size());
+#endif
+
+    return key.to_string();
+}
+
+// A generator whose pipeline has already been built, to compute its
+// cache key. On a miss it is compiled from that pipeline, rather than
+// by running generate() and schedule() a second time.
+class PrebuiltGenerator : public AbstractGenerator {
+    AbstractGeneratorPtr gen;
+    Pipeline pipeline;
+
+public:
+    PrebuiltGenerator(AbstractGeneratorPtr gen, const Pipeline &pipeline)
+        : gen(std::move(gen)), pipeline(pipeline) {
+    }
+
+    std::string name() override {
+        return gen->name();
+    }
+    GeneratorContext context() const override {
+        return gen->context();
+    }
+    std::vector<ArgInfo> arginfos() override {
+        return gen->arginfos();
+    }
+    void set_generatorparam_value(const std::string &name, const std::string &value) override {
+        gen->set_generatorparam_value(name, value);
+    }
+    void set_generatorparam_value(const std::string &name, const LoopLevel &loop_level) override {
+        gen->set_generatorparam_value(name, loop_level);
+    }
+    Pipeline build_pipeline() override {
+        return pipeline;
+    }
+    std::vector<Parameter> input_parameter(const std::string &name) override {
+        return gen->input_parameter(name);
+    }
+    std::vector<Func> output_func(const std::string &name) override {
+        return gen->output_func(name);
+    }
+    void bind_input(const std::string &name, const std::vector<Parameter> &v) override {
+        gen->bind_input(name, v);
+    }
+    void bind_input(const std::string &name, const std::vector<Func> &v) override {
+        gen->bind_input(name, v);
+    }
+    void bind_input(const std::string &name, const std::vector<Expr> &v) override {
+        gen->bind_input(name, v);
+    }
+    bool emit_cpp_stub(const std::string &stub_file_path) override {
+        return gen->emit_cpp_stub(stub_file_path);
+    }
+    bool emit_hlpipe(const std::string &hlpipe_file_path) override {
+        return gen->emit_hlpipe(hlpipe_file_path);
+    }
+    bool allow_out_of_order_inputs_and_outputs() const override {
+        return gen->allow_out_of_order_inputs_and_outputs();
+    }
+};
+
+// The headers' include guards are made from their paths (see
+// Module::compile). The cached copies have the guard replaced with this,
+// and copying one out puts back the guard for its new path.
+const char *const cached_include_guard = "_halide_generator_cache_include_guard";
+
+bool has_include_guard(OutputFileType type) {
+    return type == OutputFileType::c_header || type == OutputFileType::function_info_header;
+}
+
+// Copy a file, replacing every occurrence of one string with another.
+void copy_file_replacing(const std::filesystem::path &from, const std::filesystem::path &to,
+                         const std::string &old_text, const std::string &new_text,
+                         std::error_code &ec) {
+    std::ifstream in(from, std::ios::binary);
+    if (!in.is_open()) {
+        ec = std::make_error_code(std::errc::no_such_file_or_directory);
+        return;
+    }
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    for (size_t pos = contents.find(old_text); pos != std::string::npos; pos = contents.find(old_text, pos + new_text.size())) {
+        contents.replace(pos, old_text.size(), new_text);
+    }
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    out.write(contents.data(), contents.size());
+    out.close();
+    if (out.fail()) {
+        ec = std::make_error_code(std::errc::io_error);
+    }
+}
+
+bool copy_outputs_from_cache(const std::filesystem::path &entry,
+                             const std::map<OutputFileType, std::string> &output_files) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (!fs::is_directory(entry, ec)) {
+        return false;
+    }
+    for (const auto &[type, path] : output_files) {
+        if (!is_cached_output(type)) {
+            continue;
+        }
+        // Copying (rather than linking) gives the output a fresh
+        // modification time, which is what build systems expect.
+        const fs::path cached = entry / fs::path(path).filename();
+        if (has_include_guard(type)) {
+            copy_file_replacing(cached, path, cached_include_guard, c_print_name(path), ec);
+        } else {
+            fs::copy_file(cached, path, fs::copy_options::overwrite_existing, ec);
+        }
+        if (ec) {
+            // The entry may have been evicted by a concurrent build.
+            debug(1) << "Could not copy " << path << " from the generator cache: " << ec.message() << "\n";
+            return false;
+        }
+    }
+    // Mark the entry as recently used, for eviction.
+    fs::last_write_time(entry, fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+// Delete the least recently used entries until the cache is no bigger than max_bytes.
+void evict_from_cache(const std::filesystem::path &cache_dir, uint64_t max_bytes) {
+    namespace fs = std::filesystem;
+    struct Entry {
+        fs::file_time_type last_used;
+        fs::path path;
+        uint64_t size;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+    for (const auto &dir : fs::directory_iterator(cache_dir, ec)) {
+        // Entries still being written have a '.' in their names.
+        if (!dir.is_directory(ec) || dir.path().filename().string().find('.') != std::string::npos) {
+            continue;
+        }
+        Entry entry{dir.last_write_time(ec), dir.path(), 0};
+        for (const auto &file : fs::directory_iterator(dir.path(), ec)) {
+            uintmax_t size = file.file_size(ec);
+            if (!ec) {
+                entry.size += size;
+            }
+        }
+        total += entry.size;
+        entries.push_back(std::move(entry));
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.last_used < b.last_used;
+    });
+    for (const Entry &entry : entries) {
+        if (total <= max_bytes) {
+            break;
+        }
+        debug(1) << "Evicting " << entry.path.string() << " from the generator cache\n";
+        fs::remove_all(entry.path, ec);
+        total -= entry.size;
+    }
+}
+
+void add_outputs_to_cache(const std::filesystem::path &cache_dir, const std::string &key,
+                          const std::map<OutputFileType, std::string> &output_files) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+
+    // Build the entry under a temporary name and then rename it into
+    // place, so that concurrent builds never see a partial entry.
+    const fs::path entry = cache_dir / key;
+    const fs::path temp = cache_dir / (key + ".tmp" + std::to_string(std::random_device()()));
+    fs::create_directories(temp, ec);
+    for (const auto &[type, path] : output_files) {
+        if (ec) {
+            break;
+        }
+        const fs::path cached = temp / fs::path(path).filename();
+        if (has_include_guard(type)) {
+            copy_file_replacing(path, cached, c_print_name(path), cached_include_guard, ec);
+        } else if (is_cached_output(type)) {
+            fs::copy_file(path, cached, ec);
+        }
+    }
+    if (!ec) {
+        fs::rename(temp, entry, ec);
+    }
+    if (ec) {
+        // Most likely another build added the same entry first.
+        debug(1) << "Could not add " << entry.string() << " to the generator cache: " << ec.message() << "\n";
+        fs::remove_all(temp, ec);
+        return;
+    }
+
+    const std::string max_size = get_env_variable("HL_GENERATOR_CACHE_SIZE");
+    if (!max_size.empty()) {
+        char *end = nullptr;
+        uint64_t max_megabytes = std::strtoull(max_size.c_str(), &end, 10);
+        user_assert(*end == 0 && max_megabytes > 0)
+            << "HL_GENERATOR_CACHE_SIZE must be a positive number of megabytes, not \"" << max_size << "\"\n";
+        evict_from_cache(cache_dir, max_megabytes * 1024 * 1024);
+    }
+}
+
+}  // namespace
+
 void execute_generator(const ExecuteGeneratorArgs &args_in) {
     const auto fix_defaults = [](const ExecuteGeneratorArgs &args_in) -> ExecuteGeneratorArgs {
         ExecuteGeneratorArgs args = args_in;
@@ -1096,13 +1492,39 @@ void execute_generator(const ExecuteGeneratorArgs &args_in) {
         // Don't bother with this if we're just emitting a cpp_stub.
         if (!cpp_stub_only) {
             auto output_files = compute_output_files(args.targets[0], base_path, args.output_types);
+            AbstractGeneratorPtr prebuilt;
             auto module_factory = [&](const std::string &function_name, const Target &target) -> Module {
-                auto gen = generator_factory(function_name, target);
+                auto gen = prebuilt ? std::move(prebuilt) : generator_factory(function_name, target);
                 return args.build_mode == ExecuteGeneratorArgs::Gradient ?
                            gen->build_gradient_module(function_name) :
                            gen->build_module(function_name);
             };
-            compile_multitarget(args.function_name, output_files, args.targets, args.suffixes, module_factory, args.compiler_logger_factory);
+
+            const std::string cache_dir = get_env_variable("HL_GENERATOR_CACHE_DIR");
+            std::string cache_key;
+            bool cache_hit = false;
+            if (!cache_dir.empty() && generator_outputs_are_cacheable(args)) {
+                // The cache is only used with a single target, so this is the
+                // generator that module_factory would otherwise make. Reset
+                // the random counters first, as compile_multitarget does, so
+                // that random_float etc. give the same pipeline either way.
+                reset_random_counters();
+                auto gen = generator_factory(args.function_name, args.targets[0]);
+                Pipeline pipeline = gen->build_pipeline();
+                prebuilt = std::make_unique<PrebuiltGenerator>(std::move(gen), pipeline);
+                cache_key = generator_cache_key(args, output_files, pipeline);
+                if (!cache_key.empty()) {
+                    cache_hit = copy_outputs_from_cache(std::filesystem::path(cache_dir) / cache_key, output_files);
+                    debug(1) << "Generator cache " << (cache_hit ? "hit" : "miss") << " for " << args.function_name
+                             << ": " << cache_key << "\n";
+                }
+            }
+            if (!cache_hit) {
+                compile_multitarget(args.function_name, output_files, args.targets, args.suffixes, module_factory, args.compiler_logger_factory);
+                if (!cache_key.empty()) {
+                    add_outputs_to_cache(cache_dir, cache_key, output_files);
+                }
+            }
             if (args.log_outputs) {
                 for (const auto &o : output_files) {
                     std::cout << "Generated file: " << o.second << "\n";
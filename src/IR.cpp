@@ -650,6 +650,7 @@ const char *const intrinsic_op_names[] = {
     "mod_round_to_zero",
     "mul_shift_right",
     "mux",
+    "nontemporal_store",
     "popcount",
     "prefetch",
     "profiling_enable_instance_marker",
@@ -677,6 +678,7 @@ const char *const intrinsic_op_names[] = {
     "skip_stages_marker",
     "sliding_window_marker",
     "sorted_avg",
+    "store_fence",
     "strict_add",
     "strict_div",
     "strict_eq",
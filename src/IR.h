@@ -567,6 +567,10 @@ struct Call : public ExprNode<Call> {
         mod_round_to_zero,
         mul_shift_right,
         mux,
+        // Wraps the value of a Store, marking it as one that should be
+        // written with non-temporal (streaming) stores that bypass the
+        // cache. Introduced by mark_nontemporal_stores.
+        nontemporal_store,
         popcount,
         prefetch,
         profiling_enable_instance_marker,
@@ -610,6 +614,9 @@ struct Call : public ExprNode<Call> {
 
         // Compute (arg[0] + arg[1]) / 2, assuming arg[0] < arg[1].
         sorted_avg,
+        // Orders all preceding non-temporal stores before any later
+        // stores, so that their results are visible to other threads.
+        store_fence,
 
         // strict floating point ops. These are floating point ops that we would
         // like to optimize around (or let llvm optimize around) by treating
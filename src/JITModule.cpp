@@ -321,15 +321,19 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
 // i386: "JIT session error: Unsupported i386 relocation:4" (R_386_PLT32)
 // ARM 32bit: Unsupported target machine architecture in ELF object shared runtime-jitted-objectbuffer
 // Windows 64-bit: JIT session error: could not register eh-frame: __register_frame function not found
+//
+// The memory manager is made whenever an object is linked, which with
+// LazyJIT can be long after this function returns, so the linking
+// layer holds its own copy of the dependencies.
 #if LLVM_VERSION >= 210
-        linkerBuilder = [&](llvm::orc::ExecutionSession &session) {
-            return std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(session, [&](const llvm::MemoryBuffer &) {
+        linkerBuilder = [dependencies](llvm::orc::ExecutionSession &session) {
+            return std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(session, [dependencies](const llvm::MemoryBuffer &) {
                 return std::make_unique<HalideJITMemoryManager>(dependencies);
             });
         };
 #else
-        linkerBuilder = [&](llvm::orc::ExecutionSession &session, const llvm::Triple &) {
-            return std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(session, [&]() {
+        linkerBuilder = [dependencies](llvm::orc::ExecutionSession &session, const llvm::Triple &) {
+            return std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(session, [dependencies]() {
                 return std::make_unique<HalideJITMemoryManager>(dependencies);
             });
         };
@@ -346,11 +350,43 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
 #endif
     }
 
-    auto JIT = llvm::cantFail(llvm::orc::LLJITBuilder()
-                                  .setDataLayout(target_data_layout)
-                                  .setCompileFunctionCreator(compilerBuilder)
-                                  .setObjectLinkingLayerCreator(linkerBuilder)
-                                  .create());
+    // Pipelines compiled with LazyJIT are split into one partition per
+    // function, each compiled the first time it is called. The shared
+    // runtime and trampoline modules, which have no entrypoint, are
+    // always compiled eagerly.
+    std::unique_ptr<llvm::orc::LLJIT> JIT;
+    bool lazy = false;
+    if (target.has_feature(Target::LazyJIT) && !function_name.empty()) {
+        // Partitions may be compiled concurrently, from whichever
+        // threads first call them, so each compile needs its own
+        // TargetMachine.
+        const auto concurrentCompilerBuilder = [&](const llvm::orc::JITTargetMachineBuilder & /*jtmb*/)
+            -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+            return std::make_unique<llvm::orc::ConcurrentIRCompiler>(tm_builder);
+        };
+        auto lazy_jit = llvm::orc::LLLazyJITBuilder()
+                            .setDataLayout(target_data_layout)
+                            .setCompileFunctionCreator(concurrentCompilerBuilder)
+                            .setObjectLinkingLayerCreator(linkerBuilder)
+                            .create();
+        if (lazy_jit) {
+            (*lazy_jit)->getCompileOnDemandLayer().setPartitionFunction(llvm::orc::CompileOnDemandLayer::compileRequested);
+            JIT = std::move(*lazy_jit);
+            lazy = true;
+        } else {
+            // Lazy compilation needs stubs and a call-through manager
+            // for the target architecture, which not all have.
+            debug(1) << "Lazy JIT compilation is not available for " << target.to_string()
+                     << ", compiling eagerly: " << llvm::toString(lazy_jit.takeError()) << "\n";
+        }
+    }
+    if (!JIT) {
+        JIT = llvm::cantFail(llvm::orc::LLJITBuilder()
+                                 .setDataLayout(target_data_layout)
+                                 .setCompileFunctionCreator(compilerBuilder)
+                                 .setObjectLinkingLayerCreator(linkerBuilder)
+                                 .create());
+    }
 
     auto ctors = llvm::orc::getConstructors(*m);
     llvm::orc::CtorDtorRunner ctorRunner(JIT->getMainJITDylib());
@@ -366,7 +402,8 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     JIT->getMainJITDylib().addGenerator(std::move(gen.get()));
 
     llvm::orc::ThreadSafeModule tsm(std::move(m), std::move(jit_module->context));
-    auto err = JIT->addIRModule(std::move(tsm));
+    auto err = lazy ? static_cast<llvm::orc::LLLazyJIT &>(*JIT).addLazyIRModule(std::move(tsm)) :
+                      JIT->addIRModule(std::move(tsm));
     internal_assert(!err) << llvm::toString(std::move(err)) << "\n";
 
     // Resolve symbol dependencies
@@ -389,9 +426,10 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     internal_assert(!err) << llvm::toString(std::move(err)) << "\n";
 
     // Retrieve function pointers from the compiled module (which also
-    // triggers compilation)
+    // triggers compilation, unless it is lazy, in which case we get
+    // back stubs that compile on first call)
     debug(1) << "JIT compiling " << module_name
-             << " for " << target.to_string() << "\n";
+             << " for " << target.to_string() << (lazy ? " lazily" : "") << "\n";
 
     std::map<std::string, Symbol> exports;
 
@@ -562,6 +600,51 @@ int JITModule::set_num_threads(int n) const {
     return 1;
 }
 
+int JITModule::do_par_for(JITUserContext *context, int (*f)(JITUserContext *, int, uint8_t *),
+                          int min, int extent, uint8_t *closure) const {
+    std::map<std::string, Symbol>::const_iterator iter =
+        exports().find("halide_do_par_for");
+    if (iter != exports().end()) {
+        using do_par_for_fn = int (*)(JITUserContext *, int (*)(JITUserContext *, int, uint8_t *), int, int, uint8_t *);
+        return (reinterpret_bits<do_par_for_fn>(iter->second.address))(context, f, min, extent, closure);
+    }
+    // No thread pool in this runtime; run serially.
+    for (int i = min; i < min + extent; i++) {
+        if (int result = f(context, i, closure)) {
+            return result;
+        }
+    }
+    return 0;
+}
+
+halide_workspace_t *JITModule::workspace_create(JITUserContext *context, const std::string &pipeline_name,
+                                                uint64_t initial_bytes) const {
+    std::map<std::string, Symbol>::const_iterator f =
+        exports().find("halide_workspace_create");
+    if (f != exports().end()) {
+        using workspace_create_fn = halide_workspace_t *(*)(JITUserContext *, const char *, uint64_t);
+        return (reinterpret_bits<workspace_create_fn>(f->second.address))(context, pipeline_name.c_str(), initial_bytes);
+    }
+    return nullptr;
+}
+
+void JITModule::workspace_destroy(JITUserContext *context, halide_workspace_t *workspace) const {
+    std::map<std::string, Symbol>::const_iterator f =
+        exports().find("halide_workspace_destroy");
+    if (f != exports().end()) {
+        (reinterpret_bits<void (*)(JITUserContext *, halide_workspace_t *)>(f->second.address))(context, workspace);
+    }
+}
+
+uint64_t JITModule::workspace_high_water_mark(const halide_workspace_t *workspace) const {
+    std::map<std::string, Symbol>::const_iterator f =
+        exports().find("halide_workspace_high_water_mark");
+    if (f != exports().end()) {
+        return (reinterpret_bits<uint64_t (*)(const halide_workspace_t *)>(f->second.address))(workspace);
+    }
+    return 0;
+}
+
 bool JITModule::compiled() const {
     return jit_module->JIT != nullptr;
 }
@@ -1118,6 +1201,34 @@ int JITSharedRuntime::set_num_threads(int n) {
     return shared_runtimes(MainShared).set_num_threads(n);
 }
 
+halide_workspace_t *JITSharedRuntime::workspace_create(JITUserContext *context, const std::string &pipeline_name,
+                                                       uint64_t initial_bytes) {
+    std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
+    return shared_runtimes(MainShared).workspace_create(context, pipeline_name, initial_bytes);
+}
+
+void JITSharedRuntime::workspace_destroy(JITUserContext *context, halide_workspace_t *workspace) {
+    std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
+    shared_runtimes(MainShared).workspace_destroy(context, workspace);
+}
+
+uint64_t JITSharedRuntime::workspace_high_water_mark(const halide_workspace_t *workspace) {
+    std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
+    return shared_runtimes(MainShared).workspace_high_water_mark(workspace);
+}
+
+int JITSharedRuntime::do_par_for(JITUserContext *context, int (*f)(JITUserContext *, int, uint8_t *),
+                                 int min, int extent, uint8_t *closure) {
+    // Don't hold the lock while the tasks run; they may want to JIT
+    // compile things themselves.
+    JITModule runtime;
+    {
+        std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
+        runtime = shared_runtimes(MainShared);
+    }
+    return runtime.do_par_for(context, f, min, extent, closure);
+}
+
 JITCache::JITCache(Target jit_target,
                    std::vector<Argument> arguments,
                    std::map<std::string, JITExtern> jit_externs,
@@ -253,6 +253,20 @@ struct JITModule {
     /** See JITSharedRuntime::set_num_threads */
     int set_num_threads(int) const;
 
+    /** See JITSharedRuntime::do_par_for */
+    int do_par_for(JITUserContext *context, int (*f)(JITUserContext *, int, uint8_t *),
+                   int min, int extent, uint8_t *closure) const;
+
+    /** See JITSharedRuntime::workspace_create */
+    halide_workspace_t *workspace_create(JITUserContext *context, const std::string &pipeline_name,
+                                         uint64_t initial_bytes) const;
+
+    /** See JITSharedRuntime::workspace_destroy */
+    void workspace_destroy(JITUserContext *context, halide_workspace_t *workspace) const;
+
+    /** See JITSharedRuntime::workspace_high_water_mark */
+    uint64_t workspace_high_water_mark(const halide_workspace_t *workspace) const;
+
     /** Return true if compile_module has been called on this module. */
     bool compiled() const;
 };
@@ -297,6 +311,35 @@ public:
      * avoid deadlock when using the async scheduling directive. Returns the old
      * number. */
     static int set_num_threads(int);
+
+    /** Run f(context, i, closure) for every i in [min, min + extent)
+     * on the Halide thread pool, honoring any custom_do_par_for set in
+     * the context's handlers. Returns zero if all of the calls returned
+     * zero, or the nonzero result of one of them otherwise. */
+    static int do_par_for(JITUserContext *context, int (*f)(JITUserContext *, int, uint8_t *),
+                          int min, int extent, uint8_t *closure);
+
+    /** Create a persistent workspace for the named pipeline when
+     * called with the given context. The pipeline must have been
+     * compiled with Target::Workspace. Heap allocations made outside
+     * of parallel loops by calls to the pipeline with the same context
+     * are then kept in the workspace and reused by the next call,
+     * instead of being freed. initial_bytes of memory are reserved up
+     * front. Returns nullptr if the memory could not be allocated. If
+     * you are compiling statically, use the generated
+     * <name>_workspace_create function instead. */
+    static halide_workspace_t *workspace_create(JITUserContext *context, const std::string &pipeline_name,
+                                                uint64_t initial_bytes);
+
+    /** Release a workspace made by workspace_create and all of the
+     * memory it holds. */
+    static void workspace_destroy(JITUserContext *context, halide_workspace_t *workspace);
+
+    /** Get the largest number of bytes the workspace has held at once.
+     * Passing this as initial_bytes to workspace_create gives a
+     * workspace that never needs to allocate while the pipeline runs
+     * on inputs no larger than those seen so far. */
+    static uint64_t workspace_high_water_mark(const halide_workspace_t *workspace);
 };
 
 void *get_symbol_address(const char *s);
@@ -6,6 +6,7 @@
 
 #include "Lower.h"
 
+#include "AddAlignedFastPath.h"
 #include "AddAtomicMutex.h"
 #include "AddImageChecks.h"
 #include "AddParameterChecks.h"
@@ -25,6 +26,7 @@
 #include "DebugToFile.h"
 #include "Deinterleave.h"
 #include "EarlyFree.h"
+#include "EmulateFloat16Math.h"
 #include "ExtractTileOperations.h"
 #include "FindCalls.h"
 #include "FindIntrinsics.h"
@@ -45,9 +47,12 @@
 #include "LowerParallelTasks.h"
 #include "LowerWarpShuffles.h"
 #include "Memoization.h"
+#include "NontemporalStores.h"
 #include "OffloadGPULoops.h"
+#include "PackHeapAllocations.h"
 #include "PartitionLoops.h"
 #include "Prefetch.h"
+#include "ProfileGuidedOptimization.h"
 #include "Profiling.h"
 #include "PurifyIndexMath.h"
 #include "Qualify.h"
@@ -79,6 +84,7 @@
 #include "UnrollLoops.h"
 #include "UnsafePromises.h"
 #include "VectorizeLoops.h"
+#include "WorkspaceAllocations.h"
 #include "WrapCalls.h"
 
 namespace Halide {
@@ -150,6 +156,13 @@ void lower_impl(const vector<Function> &output_funcs,
     bool any_strict_float = strictify_float(env, t);
     result_module.set_any_strict_float(any_strict_float);
 
+    // A profile of an earlier run of this pipeline can guide some
+    // decisions made during lowering.
+    PipelineProfile profile;
+    string profile_file = get_env_variable("HL_PGO_PROFILE");
+    bool use_profile = !profile_file.empty() &&
+                       load_pipeline_profile(profile_file, pipeline_name, profile);
+
     // Output functions should all be computed and stored at root.
     for (const Function &f : outputs) {
         Func(f).compute_root().store_root();
@@ -302,6 +315,12 @@ void lower_impl(const vector<Function> &output_funcs,
     s = add_atomic_mutex(s, outputs);
     log("Lowering after adding atomic mutex allocation:", s);
 
+    if (t.has_feature(Target::AlignedFastPath)) {
+        debug(1) << "Adding a fast path for dense aligned buffers...\n";
+        s = add_aligned_fast_path(s, t);
+        log("Lowering after adding a fast path for dense aligned buffers:", s);
+    }
+
     debug(1) << "Unpacking buffer arguments...\n";
     s = unpack_buffers(s);
     log("Lowering after unpacking buffer arguments:", s);
@@ -366,6 +385,12 @@ void lower_impl(const vector<Function> &output_funcs,
     s = simplify(s);
     log("Lowering after rewriting vector interleavings:", s);
 
+    if (use_profile) {
+        debug(1) << "Applying the profile to loop partitioning...\n";
+        s = apply_profile_to_loop_partitioning(s, profile);
+        log("Lowering after applying the profile to loop partitioning:", s);
+    }
+
     debug(1) << "Partitioning loops to simplify boundary conditions...\n";
     s = partition_loops(s);
     s = simplify(s);
@@ -392,6 +417,12 @@ void lower_impl(const vector<Function> &output_funcs,
     s = inject_early_frees(s);
     log("Lowering after injecting early frees:", s);
 
+    if (t.has_feature(Target::WidenFloat16Math)) {
+        debug(1) << "Widening float16 math...\n";
+        s = widen_float16_math(s, t);
+        log("Lowering after widening float16 math:", s);
+    }
+
     if (t.has_feature(Target::FuzzFloatStores)) {
         debug(1) << "Fuzzing floating point stores...\n";
         s = fuzz_float_stores(s);
@@ -406,10 +437,31 @@ void lower_impl(const vector<Function> &output_funcs,
     s = bound_small_allocations(s);
     log("Lowering after bounding small allocations:", s);
 
+    if (use_profile) {
+        debug(1) << "Applying the profile to allocations...\n";
+        s = apply_profile_to_allocations(s, profile);
+        log("Lowering after applying the profile to allocations:", s);
+    }
+
+    if (t.has_feature(Target::ArenaAllocations)) {
+        debug(1) << "Packing heap allocations into arenas...\n";
+        s = pack_heap_allocations(s, t);
+        log("Lowering after packing heap allocations into arenas:", s);
+    }
+
+    if (t.has_feature(Target::Workspace)) {
+        debug(1) << "Injecting workspace allocations...\n";
+        s = inject_workspace_allocations(s, pipeline_name);
+        log("Lowering after injecting workspace allocations:", s);
+    }
+
     if (t.has_feature(Target::Profile) || t.has_feature(Target::ProfileByTimer)) {
         debug(1) << "Injecting profiling...\n";
-        s = inject_profiling(s, pipeline_name, env);
+        s = inject_profiling(s, pipeline_name, env, t);
         log("Lowering after injecting profiling:", s);
+    } else if (t.has_feature(Target::ProfileTimeline) || t.has_feature(Target::ProfileMemoryTraffic)) {
+        user_warning << "Target features profile_timeline and profile_memory_traffic have no effect "
+                     << "without profile or profile_by_timer.\n";
     }
 
     if (t.has_feature(Target::CUDA)) {
@@ -452,6 +504,10 @@ void lower_impl(const vector<Function> &output_funcs,
     s = hoist_prefetches(s);
     log("Lowering after hoisting prefetches:", s);
 
+    debug(1) << "Marking non-temporal stores...\n";
+    s = mark_nontemporal_stores(s, env);
+    log("Lowering after marking non-temporal stores:", s);
+
     if (t.has_feature(Target::NoAsserts)) {
         debug(1) << "Stripping asserts...\n";
         s = strip_asserts(s);
@@ -156,6 +156,32 @@ int calculate_min_threads(const Stmt &body) {
     return min_threads.result;
 }
 
+bool contains_loop(const Stmt &s) {
+    class ContainsLoop : public IRVisitor {
+        using IRVisitor::visit;
+
+        void visit(const For *op) override {
+            result = true;
+        }
+
+    public:
+        bool result = false;
+    } contains;
+    s.accept(&contains);
+    return contains.result;
+}
+
+// With LazyJIT, an if with a loop nest on each side that isn't inside
+// any loop, such as the ones specialize() makes, has its branches
+// outlined into closures, so that only the branches that are taken get
+// compiled. Chains of them (one per specialization) are outlined one
+// branch at a time, rather than nesting a closure per link.
+bool should_outline_branches(const IfThenElse *op) {
+    return op->else_case.defined() &&
+           contains_loop(op->then_case) &&
+           contains_loop(op->else_case);
+}
+
 struct LowerParallelTasks : public IRMutator {
 
     /** Codegen a call to do_parallel_tasks */
@@ -184,9 +210,65 @@ struct LowerParallelTasks : public IRMutator {
              !expr_uses_var(acquire->count, op->name))) {
             return do_as_parallel_task(op);
         }
+        ScopedValue<int> old_loop_depth(loop_depth, loop_depth + 1);
         return IRMutator::visit(op);
     }
 
+    Stmt visit(const IfThenElse *op) override {
+        if (!target.has_feature(Target::LazyJIT) ||
+            loop_depth > 0 ||
+            !should_outline_branches(op)) {
+            return IRMutator::visit(op);
+        }
+        Stmt then_case = outline_branch(op->then_case, ".then");
+        const IfThenElse *next = op->else_case.as<IfThenElse>();
+        Stmt else_case = (next && should_outline_branches(next)) ?
+                             mutate(op->else_case) :
+                             outline_branch(op->else_case, ".else");
+        return IfThenElse::make(op->condition, then_case, else_case);
+    }
+
+    /** Move a statement into a closure of its own, and call it directly. */
+    Stmt outline_branch(const Stmt &s, const std::string &suffix) {
+        Closure closure;
+        closure.include(s);
+        for (auto const &b : closure.buffers) {
+            closure.vars.erase(b.first);
+        }
+
+        std::string closure_name = unique_name("branch_closure");
+        Expr closure_struct_allocation = closure.pack_into_struct();
+        Expr closure_struct = Variable::make(Handle(), closure_name);
+
+        const std::string closure_arg_name = unique_name("closure_arg");
+        std::vector<LoweredArgument> closure_args = {
+            make_scalar_arg<void *>("__user_context"),
+            make_scalar_arg<uint8_t *>(closure_arg_name)};
+
+        Stmt body;
+        {
+            ScopedValue<std::string> save_name(function_name, function_name + suffix);
+            body = mutate(s);
+        }
+
+        const std::string new_function_name = c_print_name(unique_name(function_name + suffix), false);
+        Expr closure_arg_var = Variable::make(closure_struct_allocation.type(), closure_arg_name);
+        body = closure.unpack_from_struct(closure_arg_var, body);
+        closure_implementations.emplace_back(new_function_name, closure_args, std::move(body), LinkageType::Internal, NameMangling::C);
+
+        Expr user_context = Call::make(type_of<void *>(), Call::get_user_context, {}, Call::PureIntrinsic);
+        Expr result = Call::make(Int(32), new_function_name,
+                                 {user_context, Cast::make(type_of<uint8_t *>(), closure_struct)},
+                                 Call::Extern);
+
+        std::string closure_result_name = unique_name("closure_result");
+        Expr closure_result = Variable::make(Int(32), closure_result_name);
+        Stmt stmt = AssertStmt::make(closure_result == 0, closure_result);
+        stmt = LetStmt::make(closure_result_name, result, stmt);
+        stmt = LetStmt::make(closure_name, closure_struct_allocation, stmt);
+        return stmt;
+    }
+
     Stmt visit(const Acquire *op) override {
         return do_as_parallel_task(op);
     }
@@ -289,6 +371,8 @@ struct LowerParallelTasks : public IRMutator {
             {
                 ScopedValue<std::string> save_name(function_name, t.name);
 
+                ScopedValue<int> old_loop_depth(loop_depth, loop_depth + 1);
+
                 task_parents.push(closure_task_parent);
                 t.body = mutate(t.body);
                 task_parents.pop();
@@ -417,6 +501,9 @@ struct LowerParallelTasks : public IRMutator {
     const Target &target;
     std::vector<LoweredFunc> closure_implementations;
     SmallStack<Expr> task_parents;
+    // The number of loops (including parallel tasks) around the
+    // statement being mutated.
+    int loop_depth = 0;
 };
 
 }  // namespace
@@ -676,17 +676,22 @@ void Module::compile(const std::map<OutputFileType, std::string> &output_files)
         std::ofstream file(output_files.at(OutputFileType::conceptual_stmt));
         file << get_conceptual_stmt();
     }
+    // A profile of an earlier run can be overlaid on the stmt html.
+    const std::string profile_path = (contains(output_files, OutputFileType::stmt_html) ||
+                                      contains(output_files, OutputFileType::conceptual_stmt_html)) ?
+                                         get_env_variable("HL_STMT_HTML_PROFILE") :
+                                         std::string();
     if (contains(output_files, OutputFileType::stmt_html)) {
         internal_assert(!assembly_path.empty());
         debug(1) << "Module.compile(): stmt_html " << output_files.at(OutputFileType::stmt_html) << "\n";
         Internal::print_to_stmt_html(output_files.at(OutputFileType::stmt_html),
-                                     *this, assembly_path);
+                                     *this, assembly_path, profile_path);
     }
     if (contains(output_files, OutputFileType::conceptual_stmt_html)) {
         internal_assert(!assembly_path.empty());
         debug(1) << "Module.compile(): conceptual_stmt_html " << output_files.at(OutputFileType::conceptual_stmt_html) << "\n";
         Internal::print_to_conceptual_stmt_html(output_files.at(OutputFileType::conceptual_stmt_html),
-                                                *this, assembly_path);
+                                                *this, assembly_path, profile_path);
     }
     if (contains(output_files, OutputFileType::device_code)) {
         debug(1) << "Module.compile(): device_code " << output_files.at(OutputFileType::device_code) << "\n";
@@ -0,0 +1,101 @@
+#include <set>
+
+#include "NontemporalStores.h"
+#include "Function.h"
+#include "IR.h"
+#include "IRMutator.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+
+namespace {
+
+Stmt store_fence() {
+    return Evaluate::make(Call::make(Int(32), Call::store_fence, {}, Call::Intrinsic));
+}
+
+class MarkNontemporalStores : public IRMutator {
+    using IRMutator::visit;
+
+    const map<string, Function> &env;
+
+    // The buffers written with non-temporal stores in the current
+    // producer.
+    set<string> buffers;
+
+    Stmt visit(const ProducerConsumer *op) override {
+        if (!op->is_producer) {
+            return IRMutator::visit(op);
+        }
+        auto it = env.find(op->name);
+        if (it == env.end() || !it->second.schedule().store_nontemporal()) {
+            return IRMutator::visit(op);
+        }
+
+        const Function &f = it->second;
+        std::vector<string> names;
+        if (f.outputs() == 1) {
+            names.push_back(op->name);
+        } else {
+            for (int i = 0; i < f.outputs(); i++) {
+                names.push_back(op->name + "." + std::to_string(i));
+            }
+        }
+        buffers.insert(names.begin(), names.end());
+        Stmt body = mutate(op->body);
+        for (const string &n : names) {
+            buffers.erase(n);
+        }
+        if (body.same_as(op->body)) {
+            return op;
+        }
+        return ProducerConsumer::make(op->name, true, Block::make(body, store_fence()));
+    }
+
+    Stmt visit(const For *op) override {
+        if (buffers.empty()) {
+            return IRMutator::visit(op);
+        }
+        if (op->device_api != DeviceAPI::Host &&
+            op->device_api != DeviceAPI::None) {
+            // Leave the stores made on a device alone.
+            return op;
+        }
+        Stmt stmt = IRMutator::visit(op);
+        const For *loop = stmt.as<For>();
+        if (loop && loop->is_parallel() && !loop->body.same_as(op->body)) {
+            // Each iteration may run on a different thread, so each
+            // needs its own fence.
+            stmt = For::make(loop->name, loop->min, loop->extent, loop->for_type,
+                             loop->partition_policy, loop->device_api,
+                             Block::make(loop->body, store_fence()));
+        }
+        return stmt;
+    }
+
+    Stmt visit(const Store *op) override {
+        if (!op->value.type().is_vector() || !buffers.count(op->name)) {
+            return IRMutator::visit(op);
+        }
+        Expr value = Call::make(op->value.type(), Call::nontemporal_store, {op->value}, Call::PureIntrinsic);
+        return Store::make(op->name, value, op->index, op->param, op->predicate, op->alignment);
+    }
+
+public:
+    MarkNontemporalStores(const map<string, Function> &env)
+        : env(env) {
+    }
+};
+
+}  // namespace
+
+Stmt mark_nontemporal_stores(const Stmt &s, const map<string, Function> &env) {
+    return MarkNontemporalStores(env).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,31 @@
+#ifndef HALIDE_NONTEMPORAL_STORES_H
+#define HALIDE_NONTEMPORAL_STORES_H
+
+/** \file
+ * Defines the lowering pass that marks the stores to Funcs scheduled
+ * with Func::store_nontemporal.
+ */
+
+#include <map>
+#include <string>
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+class Function;
+
+/** Wrap the value of each vector store to a Func scheduled with
+ * store_nontemporal in a nontemporal_store intrinsic, and add a
+ * store_fence at the end of the production of the Func and at the end
+ * of the body of each parallel loop within it. Stores made on a
+ * device are left alone. Must run after vectorization, and after the
+ * last simplification, so that nothing moves the intrinsic away from
+ * the store. */
+Stmt mark_nontemporal_stores(const Stmt &s, const std::map<std::string, Function> &env);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
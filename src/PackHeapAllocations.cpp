@@ -0,0 +1,563 @@
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include "CodeGen_Internal.h"
+#include "ExprUsesVar.h"
+#include "IREquality.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "PackHeapAllocations.h"
+#include "Scope.h"
+#include "Simplify.h"
+#include "Substitute.h"
+#include "Target.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::pair;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Every slice starts on a boundary of this many bytes. This is at
+// least as strict as the alignment halide_malloc provides on any
+// platform.
+constexpr int arena_alignment = 128;
+
+const char *const arena_prefix = "heap_arena";
+
+// Find all the buffers referred to by a statement or expression.
+class FindBufferUses : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Load *op) override {
+        names.insert(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Store *op) override {
+        names.insert(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Call *op) override {
+        names.insert(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Variable *op) override {
+        names.insert(op->name);
+        if (ends_with(op->name, ".buffer")) {
+            // Don't let the memory be reused while a buffer that may
+            // refer to it is still in use.
+            names.insert(op->name.substr(0, op->name.size() - 7));
+        }
+    }
+
+    void visit(const Free *op) override {
+        names.insert(op->name);
+    }
+
+    void visit(const Prefetch *op) override {
+        names.insert(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Atomic *op) override {
+        names.insert(op->mutex_name);
+        IRVisitor::visit(op);
+    }
+
+public:
+    set<string> names;
+};
+
+// Can the value of a let be recomputed earlier than where it is
+// defined without changing its value?
+class IsLiftable : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Load *op) override {
+        result = false;
+    }
+
+    void visit(const Call *op) override {
+        if (!op->is_pure()) {
+            result = false;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+public:
+    bool result = true;
+};
+
+bool is_liftable(const Expr &e) {
+    IsLiftable check;
+    e.accept(&check);
+    return check.result;
+}
+
+// The arena planning works on the statements that are executed once
+// per instance of a scope (a loop body, an if branch, or the whole
+// pipeline). Blocks, lets, producer-consumer nodes and allocations
+// are walked through; any other statement is treated as a single
+// indivisible step, which uses every buffer mentioned anywhere inside
+// it.
+bool is_scope_level(const Stmt &s) {
+    return (s.as<Block>() ||
+            s.as<LetStmt>() ||
+            s.as<ProducerConsumer>() ||
+            s.as<Allocate>());
+}
+
+struct Candidate {
+    const Allocate *op;
+    // The scope-level statements enclosing the allocation, outermost
+    // first, including the allocation itself, along with the name each
+    // one defines (if any).
+    vector<pair<const IRNode *, string>> path;
+    // The first and last step during which the memory is live.
+    int start, end;
+    // The size of the allocation in units of arena_alignment bytes,
+    // expressed in terms of names defined outside the arena.
+    Expr blocks;
+    int slot = -1;
+};
+
+class PlanArena {
+    vector<pair<const IRNode *, string>> path;
+    map<string, int> live;
+    int step = 0;
+
+    void note_uses(const IRNode *node) {
+        FindBufferUses uses;
+        node->accept(&uses);
+        for (const string &n : uses.names) {
+            auto it = live.find(n);
+            if (it != live.end()) {
+                candidates[it->second].end = step;
+            }
+        }
+        step++;
+    }
+
+    void walk(const Stmt &s) {
+        if (const Block *op = s.as<Block>()) {
+            path.emplace_back(op, "");
+            walk(op->first);
+            walk(op->rest);
+            path.pop_back();
+        } else if (const LetStmt *op = s.as<LetStmt>()) {
+            note_uses(op->value.get());
+            lets[op->name] = op->value;
+            defined.insert(op->name);
+            path.emplace_back(op, op->name);
+            walk(op->body);
+            path.pop_back();
+        } else if (const ProducerConsumer *op = s.as<ProducerConsumer>()) {
+            path.emplace_back(op, "");
+            walk(op->body);
+            path.pop_back();
+        } else if (const Allocate *op = s.as<Allocate>()) {
+            path.emplace_back(op, op->name);
+            if (is_heap_allocation(op)) {
+                Candidate c;
+                c.op = op;
+                c.path = path;
+                c.start = c.end = step;
+                live[op->name] = (int)candidates.size();
+                candidates.push_back(c);
+            }
+            step++;
+            defined.insert(op->name);
+            walk(op->body);
+            path.pop_back();
+        } else {
+            note_uses(s.get());
+        }
+    }
+
+    // Rewrite an expression evaluated inside the arena so that it only
+    // refers to names visible outside of it, by substituting in the
+    // values of the lets it depends on. Returns an undefined Expr if
+    // that's not possible.
+    Expr make_visible(Expr e, const Scope<> &hidden) const {
+        for (size_t i = 0; i <= lets.size(); i++) {
+            if (!expr_uses_vars(e, hidden)) {
+                return e;
+            }
+            map<string, Expr> replacements;
+            for (const auto &p : lets) {
+                if (hidden.contains(p.first) && expr_uses_var(e, p.first)) {
+                    if (!is_liftable(p.second)) {
+                        return Expr();
+                    }
+                    replacements.emplace(p.first, p.second);
+                }
+            }
+            if (replacements.empty()) {
+                // It depends on an allocation or some other name we
+                // can't recompute.
+                return Expr();
+            }
+            e = substitute(replacements, e);
+        }
+        return Expr();
+    }
+
+    Expr allocation_blocks(const Allocate *op, const Scope<> &hidden) const {
+        Expr elems = cast<int64_t>(max(op->extents[0], 0));
+        for (size_t i = 1; i < op->extents.size(); i++) {
+            elems *= cast<int64_t>(max(op->extents[i], 0));
+        }
+        Expr bytes = (elems + op->padding) * (op->type.lanes() * op->type.bytes());
+        Expr blocks = (bytes + (arena_alignment - 1)) / arena_alignment;
+        if (!is_const_one(op->condition)) {
+            blocks = select(op->condition, blocks, make_zero(Int(64)));
+        }
+        blocks = make_visible(blocks, hidden);
+        return blocks.defined() ? simplify(blocks) : blocks;
+    }
+
+public:
+    vector<Candidate> candidates;
+    // All lets made at the scope level, and their values.
+    map<string, Expr> lets;
+    // All names defined at the scope level.
+    set<string> defined;
+
+    // The statement the arena will enclose.
+    const IRNode *placement = nullptr;
+
+    // The size of each slot of the arena, in units of arena_alignment
+    // bytes.
+    vector<Expr> slots;
+
+    PlanArena(const Stmt &s) {
+        walk(s);
+
+        // Find the innermost scope-level statement that encloses all
+        // of the candidates. The arena goes there. Candidates whose
+        // sizes can't be computed outside of it are dropped, which
+        // may move the arena inwards, so iterate to a fixed point.
+        while (candidates.size() > 1) {
+            size_t depth = candidates[0].path.size();
+            for (const Candidate &c : candidates) {
+                size_t d = 0;
+                while (d < depth && d < c.path.size() &&
+                       c.path[d].first == candidates[0].path[d].first) {
+                    d++;
+                }
+                depth = d;
+            }
+            internal_assert(depth > 0);
+
+            Scope<> hidden;
+            set<string> visible;
+            for (size_t i = 0; i + 1 < depth; i++) {
+                visible.insert(candidates[0].path[i].second);
+            }
+            for (const string &n : defined) {
+                if (!visible.count(n)) {
+                    hidden.push(n);
+                }
+            }
+
+            vector<Candidate> kept;
+            for (Candidate &c : candidates) {
+                c.blocks = allocation_blocks(c.op, hidden);
+                if (c.blocks.defined()) {
+                    kept.push_back(c);
+                } else {
+                    debug(3) << "Not packing " << c.op->name
+                             << " into an arena because its size depends on values computed too late\n";
+                }
+            }
+            if (kept.size() == candidates.size()) {
+                placement = candidates[0].path[depth - 1].first;
+                break;
+            }
+            candidates.swap(kept);
+        }
+
+        if (!placement) {
+            candidates.clear();
+            return;
+        }
+
+        // Assign the candidates to slots, in order of the start of
+        // their live ranges. A slot can be reused once the live range
+        // of everything previously assigned to it has ended. Prefer
+        // slots of exactly the right size.
+        vector<int> slot_end;
+        for (Candidate &c : candidates) {
+            int best = -1;
+            for (size_t i = 0; i < slots.size(); i++) {
+                if (slot_end[i] < c.start) {
+                    if (equal(slots[i], c.blocks)) {
+                        best = (int)i;
+                        break;
+                    } else if (best < 0) {
+                        best = (int)i;
+                    }
+                }
+            }
+            if (best < 0) {
+                best = (int)slots.size();
+                slots.push_back(c.blocks);
+                slot_end.push_back(c.end);
+            } else {
+                slots[best] = simplify(max(slots[best], c.blocks));
+                slot_end[best] = c.end;
+            }
+            c.slot = best;
+        }
+    }
+};
+
+// How the allocations of a scope are packed into an arena.
+struct Arena {
+    string name;
+    // The new_expr for each packed allocation.
+    map<const Allocate *, Expr> slices;
+    // The lets that compute the end of each slot, in units of
+    // arena_alignment bytes. The last one is the size of the arena.
+    vector<pair<string, Expr>> offset_lets;
+    // Whether the size of the arena is known at compile time.
+    bool constant_size = false;
+};
+
+class PackHeapAllocations : public IRMutator {
+    using IRMutator::visit;
+
+    const Target &target;
+
+    // The largest arena we can make, in units of arena_alignment
+    // bytes. Its size must fit in the int32 extent of an Allocate.
+    int64_t max_arena_blocks() const {
+        return std::min<int64_t>(target.maximum_buffer_size() / arena_alignment, 0x7fffffff);
+    }
+
+    Stmt pack_scope(const Stmt &s) {
+        if (!is_scope_level(s)) {
+            return mutate(s);
+        }
+
+        PlanArena plan(s);
+        Arena arena;
+        if (plan.placement) {
+            Expr total = make_zero(Int(64));
+            for (const Expr &slot : plan.slots) {
+                total += slot;
+            }
+            auto total_blocks = as_const_int(simplify(total));
+            if (total_blocks && *total_blocks > max_arena_blocks()) {
+                debug(3) << "Not packing " << plan.candidates.size()
+                         << " allocations into an arena because it would be too large\n";
+                plan.placement = nullptr;
+            }
+            arena.constant_size = total_blocks.has_value();
+        }
+        if (!plan.placement) {
+            return rewrite(s, plan, arena);
+        }
+
+        arena.name = unique_name(arena_prefix);
+        debug(3) << "Packing " << plan.candidates.size() << " allocations into "
+                 << plan.slots.size() << " slots of " << arena.name << "\n";
+
+        // The offset of each slot, in units of arena_alignment bytes.
+        vector<Expr> offsets;
+        Expr offset = make_zero(Int(64));
+        for (size_t i = 0; i < plan.slots.size(); i++) {
+            offsets.push_back(offset);
+            string name = arena.name + ".offset." + std::to_string(i + 1);
+            arena.offset_lets.emplace_back(name, offset + plan.slots[i]);
+            offset = Variable::make(Int(64), name);
+        }
+
+        Type ptr_int = UInt(target.bits);
+        Expr base = reinterpret(ptr_int, Variable::make(Handle(), arena.name));
+        for (const Candidate &c : plan.candidates) {
+            Expr byte_offset = cast(ptr_int, offsets[c.slot] * arena_alignment);
+            arena.slices[c.op] = reinterpret(Handle(), base + byte_offset);
+        }
+
+        return rewrite(s, plan, arena);
+    }
+
+    // Rewrite the scope-level statements, turning the packed
+    // allocations into slices of the arena and recursively packing
+    // any inner scopes.
+    Stmt rewrite(const Stmt &s, const PlanArena &plan, const Arena &arena) {
+        const map<const Allocate *, Expr> &slices = arena.slices;
+        Stmt result;
+        if (const Block *op = s.as<Block>()) {
+            Stmt first = rewrite(op->first, plan, arena);
+            Stmt rest = rewrite(op->rest, plan, arena);
+            if (first.same_as(op->first) && rest.same_as(op->rest)) {
+                result = op;
+            } else {
+                result = Block::make(first, rest);
+            }
+        } else if (const LetStmt *op = s.as<LetStmt>()) {
+            Stmt body = rewrite(op->body, plan, arena);
+            if (body.same_as(op->body)) {
+                result = op;
+            } else {
+                result = LetStmt::make(op->name, op->value, body);
+            }
+        } else if (const ProducerConsumer *op = s.as<ProducerConsumer>()) {
+            Stmt body = rewrite(op->body, plan, arena);
+            if (body.same_as(op->body)) {
+                result = op;
+            } else {
+                result = ProducerConsumer::make(op->name, op->is_producer, body);
+            }
+        } else if (const Allocate *op = s.as<Allocate>()) {
+            Stmt body = rewrite(op->body, plan, arena);
+            auto it = slices.find(op);
+            if (it != slices.end()) {
+                result = Allocate::make(op->name, op->type, op->memory_type,
+                                        op->extents, op->condition, body,
+                                        it->second, "halide_device_host_nop_free", op->padding);
+            } else if (body.same_as(op->body)) {
+                result = op;
+            } else {
+                result = Allocate::make(op->name, op->type, op->memory_type,
+                                        op->extents, op->condition, body,
+                                        op->new_expr, op->free_function, op->padding);
+            }
+        } else {
+            result = mutate(s);
+        }
+
+        if (s.get() == plan.placement) {
+            // The arena is a two-dimensional allocation so that its
+            // size in bytes is computed with the usual overflow checks.
+            const string &size_name = arena.offset_lets.back().first;
+            Expr size = Variable::make(Int(64), size_name);
+            result = Allocate::make(arena.name, UInt(8), MemoryType::Heap,
+                                    {cast<int32_t>(size), arena_alignment}, const_true(),
+                                    Block::make(result, Free::make(arena.name)));
+
+            // Fail cleanly, rather than truncating the size, if the
+            // arena is too big for its extent.
+            if (!arena.constant_size) {
+                Expr max_blocks = make_const(Int(64), max_arena_blocks());
+                Expr error = Call::make(Int(32), "halide_error_buffer_allocation_too_large",
+                                        {arena.name,
+                                         cast<uint64_t>(size) * arena_alignment,
+                                         cast<uint64_t>(max_blocks) * arena_alignment},
+                                        Call::Extern);
+                result = Block::make(AssertStmt::make(size <= max_blocks, error), result);
+            }
+
+            // The slot sizes may refer to names defined by the scope
+            // enclosing the placement, so the lets that compute the
+            // offsets go right around the arena.
+            for (auto it = arena.offset_lets.rbegin(); it != arena.offset_lets.rend(); it++) {
+                result = LetStmt::make(it->first, it->second, result);
+            }
+        }
+        return result;
+    }
+
+    Stmt visit(const For *op) override {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // Allocations inside device code aren't on the host heap.
+            return op;
+        }
+        Stmt body = pack_scope(op->body);
+        if (body.same_as(op->body)) {
+            return op;
+        }
+        return For::make(op->name, op->min, op->extent, op->for_type,
+                         op->partition_policy, op->device_api, body);
+    }
+
+    Stmt visit(const IfThenElse *op) override {
+        Stmt then_case = pack_scope(op->then_case);
+        Stmt else_case = op->else_case.defined() ? pack_scope(op->else_case) : op->else_case;
+        if (then_case.same_as(op->then_case) &&
+            else_case.same_as(op->else_case)) {
+            return op;
+        }
+        return IfThenElse::make(op->condition, then_case, else_case);
+    }
+
+    Stmt visit(const Fork *op) override {
+        Stmt first = pack_scope(op->first);
+        Stmt rest = pack_scope(op->rest);
+        if (first.same_as(op->first) &&
+            rest.same_as(op->rest)) {
+            return op;
+        }
+        return Fork::make(first, rest);
+    }
+
+    Stmt visit(const Acquire *op) override {
+        Stmt body = pack_scope(op->body);
+        if (body.same_as(op->body)) {
+            return op;
+        }
+        return Acquire::make(op->semaphore, op->count, body);
+    }
+
+public:
+    PackHeapAllocations(const Target &t)
+        : target(t) {
+    }
+
+    Stmt run(const Stmt &s) {
+        return pack_scope(s);
+    }
+};
+
+}  // namespace
+
+Stmt pack_heap_allocations(const Stmt &s, const Target &t) {
+    return PackHeapAllocations(t).run(s);
+}
+
+bool is_heap_allocation(const Allocate *op) {
+    if (op->new_expr.defined() ||
+        !op->free_function.empty() ||
+        op->extents.empty() ||
+        is_const_zero(op->condition)) {
+        return false;
+    }
+    if (op->memory_type == MemoryType::Heap) {
+        return true;
+    }
+    if (op->memory_type != MemoryType::Auto) {
+        return false;
+    }
+    int64_t constant_size = Allocate::constant_allocation_size(op->extents, op->name);
+    return (constant_size == 0 ||
+            !can_allocation_fit_on_stack(constant_size * op->type.lanes() * op->type.bytes()));
+}
+
+bool is_arena_slice(const Allocate *op) {
+    if (!op->new_expr.defined()) {
+        return false;
+    }
+    const Reinterpret *ptr = op->new_expr.as<Reinterpret>();
+    const Add *add = ptr ? ptr->value.as<Add>() : nullptr;
+    const Reinterpret *base = add ? add->a.as<Reinterpret>() : nullptr;
+    const Variable *arena = base ? base->value.as<Variable>() : nullptr;
+    return arena && starts_with(arena->name, arena_prefix);
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,41 @@
+#ifndef HALIDE_PACK_HEAP_ALLOCATIONS_H
+#define HALIDE_PACK_HEAP_ALLOCATIONS_H
+
+/** \file
+ * Defines the lowering pass that packs the heap allocations of a
+ * pipeline into a single arena per scope.
+ */
+
+#include "Expr.h"
+
+namespace Halide {
+
+struct Target;
+
+namespace Internal {
+
+struct Allocate;
+
+/** Compute the live range of every heap allocation that is made at
+ * the same loop level, and service all of them from a single arena
+ * allocated once for that loop level. Allocations with disjoint live
+ * ranges share the same slice of the arena. Sizes may be symbolic;
+ * the offset of each slice is then computed at runtime, just before
+ * the arena is allocated. Each parallel loop body gets its own
+ * arena. Must run after inject_early_frees, as the Free nodes mark
+ * the end of each live range. */
+Stmt pack_heap_allocations(const Stmt &s, const Target &t);
+
+/** Returns true if codegen would service the allocation with a call
+ * to halide_malloc. */
+bool is_heap_allocation(const Allocate *op);
+
+/** Returns true if the allocation is a slice of an arena introduced
+ * by pack_heap_allocations, and so does not allocate any memory of
+ * its own. */
+bool is_arena_slice(const Allocate *op);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
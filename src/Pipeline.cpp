@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <future>
 #include <utility>
 
 #include "Argument.h"
@@ -1212,6 +1213,133 @@ void Pipeline::infer_input_bounds(JITUserContext *context,
     infer_input_bounds(context, r, target);
 }
 
+void Pipeline::realize_streaming(const std::vector<int32_t> &sizes,
+                                 const std::vector<int32_t> &tile_sizes,
+                                 const StreamingInputFn &input,
+                                 const StreamingOutputFn &output,
+                                 const Target &target) {
+    user_assert(defined()) << "Can't realize an undefined Pipeline.\n";
+    user_assert(contents->outputs.size() == 1)
+        << "realize_streaming() only supports Pipelines with a single output Func.\n";
+    user_assert(!target.has_feature(Target::NoBoundsQuery))
+        << "You may not call realize_streaming() with Target::NoBoundsQuery set.\n";
+    user_assert(input && output)
+        << "realize_streaming() requires both an input and an output callback.\n";
+    const Function &out = contents->outputs[0];
+    user_assert((int)sizes.size() == out.dimensions() && tile_sizes.size() == sizes.size())
+        << "Func " << out.name() << " is defined with " << out.dimensions()
+        << " dimensions, but realize_streaming() was passed " << sizes.size()
+        << " sizes and " << tile_sizes.size() << " tile sizes.\n";
+    for (size_t d = 0; d < sizes.size(); d++) {
+        user_assert(sizes[d] > 0 && tile_sizes[d] > 0)
+            << "Sizes and tile sizes passed to realize_streaming() must be positive, but dimension "
+            << d << " has size " << sizes[d] << " and tile size " << tile_sizes[d] << ".\n";
+    }
+
+    compile_jit(target);
+
+    // The inputs we stream are the buffer params with nothing bound to
+    // them. We bind and unbind them around each call, so make sure they
+    // always end up unbound again, even if the pipeline throws.
+    vector<Parameter> streamed;
+    for (const InferredArgument &arg : contents->inferred_args) {
+        if (arg.param.defined() && arg.param.is_buffer() && !arg.param.buffer().defined()) {
+            streamed.push_back(arg.param);
+        }
+    }
+    struct Unbinder {
+        vector<Parameter> &params;
+        ~Unbinder() {
+            for (Parameter &p : params) {
+                p.set_buffer(Buffer<>());
+            }
+        }
+    } unbinder{streamed};
+
+    // Enumerate the tiles, with dimension zero innermost.
+    vector<vector<std::pair<int32_t, int32_t>>> tiles;
+    vector<std::pair<int32_t, int32_t>> tile(sizes.size());
+    std::function<void(int)> enumerate_tiles = [&](int d) {
+        if (d < 0) {
+            tiles.push_back(tile);
+            return;
+        }
+        for (int32_t min = 0; min < sizes[d]; min += tile_sizes[d]) {
+            tile[d] = {min, std::min(tile_sizes[d], sizes[d] - min)};
+            enumerate_tiles(d - 1);
+        }
+    };
+    if (!sizes.empty()) {
+        enumerate_tiles((int)sizes.size() - 1);
+    } else {
+        tiles.push_back(tile);
+    }
+
+    auto make_output_tile = [&](const vector<std::pair<int32_t, int32_t>> &t) {
+        vector<Buffer<>> bufs;
+        vector<int> tile_extents, tile_mins;
+        for (const auto &dim : t) {
+            tile_mins.push_back(dim.first);
+            tile_extents.push_back(dim.second);
+        }
+        for (Type type : out.output_types()) {
+            bufs.emplace_back(type, nullptr, tile_extents);
+            bufs.back().set_min(tile_mins);
+        }
+        return Realization(std::move(bufs));
+    };
+
+    // Run a bounds query for the given tile, which allocates a buffer of
+    // the required size for each streamed input, then take those buffers
+    // back off the params.
+    auto query_inputs = [&](const vector<std::pair<int32_t, int32_t>> &t) {
+        Realization r = make_output_tile(t);
+        infer_input_bounds(r, target);
+        vector<Buffer<>> regions;
+        for (Parameter &p : streamed) {
+            regions.push_back(p.buffer());
+            p.set_buffer(Buffer<>());
+        }
+        return regions;
+    };
+    auto fetch_inputs = [&](vector<Buffer<>> regions) {
+        for (size_t i = 0; i < streamed.size(); i++) {
+            input(streamed[i].name(), regions[i]);
+        }
+        return regions;
+    };
+
+    std::future<vector<Buffer<>>> next_inputs =
+        std::async(std::launch::deferred, fetch_inputs, query_inputs(tiles[0]));
+    for (size_t i = 0; i < tiles.size(); i++) {
+        vector<Buffer<>> inputs = next_inputs.get();
+
+        // Overlap the I/O for the next tile with the compute for this one.
+        if (i + 1 < tiles.size()) {
+            next_inputs = std::async(std::launch::async, fetch_inputs, query_inputs(tiles[i + 1]));
+        }
+
+        for (size_t j = 0; j < streamed.size(); j++) {
+            streamed[j].set_buffer(inputs[j]);
+        }
+        Realization r = make_output_tile(tiles[i]);
+        for (size_t j = 0; j < r.size(); j++) {
+            r[j].allocate();
+        }
+        realize(r, target);
+        for (size_t j = 0; j < r.size(); j++) {
+            auto result = r[j].copy_to_host();
+            user_assert(result == halide_error_code_success) << "copy_to_host() failed with error: " << result;
+        }
+        for (Parameter &p : streamed) {
+            p.set_buffer(Buffer<>());
+        }
+        inputs.clear();
+
+        output(r);
+    }
+}
+
 void Pipeline::invalidate_cache() {
     if (defined()) {
         contents->invalidate_cache();
@@ -454,6 +454,38 @@ public:
                             const Target &target = get_jit_target_from_environment());
     // @}
 
+    /** Callback used by realize_streaming to fill in an input region. It
+     * is passed the name of an unbound ImageParam, and an allocated
+     * buffer whose mins and extents describe the region of that input
+     * required by the current output tile. It may be called on a
+     * thread other than the one that called realize_streaming. */
+    using StreamingInputFn = std::function<void(const std::string &input_name, Buffer<> &region)>;
+
+    /** Callback used by realize_streaming to consume a finished output
+     * tile. The Realization has one Buffer per output, with mins set
+     * to the position of the tile in the full output domain. The
+     * buffers are freed once the callback returns. */
+    using StreamingOutputFn = std::function<void(Realization &tile)>;
+
+    /** Realize a single-output Pipeline over the domain [0, sizes) one
+     * tile at a time, without ever holding the full input or output in
+     * memory. For each tile, a bounds query determines the region of
+     * each unbound ImageParam that the tile requires, that region is
+     * requested from the input callback, the tile is computed, and the
+     * result is handed to the output callback. The input for the next
+     * tile is fetched on a separate thread while the current tile is
+     * being computed, so peak memory is bounded by roughly two tiles
+     * worth of inputs plus one tile of output. Tiles at the edge of the
+     * domain are truncated, so the output Func must be scheduled to
+     * support arbitrary output sizes. ImageParams that already have a
+     * Buffer bound are used as-is for every tile. Requires a Target
+     * without NoBoundsQuery, and all sizes and tile sizes to be positive. */
+    void realize_streaming(const std::vector<int32_t> &sizes,
+                           const std::vector<int32_t> &tile_sizes,
+                           const StreamingInputFn &input,
+                           const StreamingOutputFn &output,
+                           const Target &target = get_jit_target_from_environment());
+
     /** Infer the arguments to the Pipeline, sorted into a canonical order:
      * all buffers (sorted alphabetically by name), followed by all non-buffers
      * (sorted alphabetically by name).
@@ -0,0 +1,231 @@
+#include "ProfileGuidedOptimization.h"
+#include "CodeGen_Internal.h"
+#include "Debug.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Util.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+
+namespace {
+
+// Funcs that took less than this fraction of the pipeline's time are
+// considered cold.
+const double cold_time_fraction = 0.01;
+
+// With fewer samples than this, the time attributed to each Func is
+// too noisy to act on.
+const int min_samples_for_timing = 100;
+
+class NeverPartitionColdLoops : public IRMutator {
+    using IRMutator::visit;
+
+    const PipelineProfile &profile;
+    bool in_cold_func = false;
+
+    Stmt visit(const ProducerConsumer *op) override {
+        if (!op->is_producer) {
+            return IRMutator::visit(op);
+        }
+        const FuncProfile *f = find_func_profile(profile, op->name);
+        // Funcs missing from the profile (e.g. because the pipeline has
+        // changed since it was profiled) are assumed to be hot.
+        bool cold = f && f->time < profile.time * cold_time_fraction;
+        if (cold) {
+            debug(2) << "Func " << op->name << " is cold, not partitioning its loops\n";
+        }
+        ScopedValue<bool> old_in_cold_func(in_cold_func, cold);
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const For *op) override {
+        Stmt body = mutate(op->body);
+        if (in_cold_func && op->partition_policy == Partition::Auto) {
+            return For::make(op->name, op->min, op->extent, op->for_type,
+                             Partition::Never, op->device_api, body);
+        } else if (body.same_as(op->body)) {
+            return op;
+        } else {
+            return For::make(op->name, op->min, op->extent, op->for_type,
+                             op->partition_policy, op->device_api, body);
+        }
+    }
+
+public:
+    NeverPartitionColdLoops(const PipelineProfile &profile)
+        : profile(profile) {
+    }
+};
+
+// Free the heap fallback of an allocation wherever the allocation
+// itself used to be freed.
+class RetargetFree : public IRMutator {
+    using IRMutator::visit;
+
+    const string &name, &heap_name;
+
+    Stmt visit(const Free *op) override {
+        if (op->name == name) {
+            return Free::make(heap_name);
+        }
+        return op;
+    }
+
+public:
+    RetargetFree(const string &name, const string &heap_name)
+        : name(name), heap_name(heap_name) {
+    }
+};
+
+class StackAllocateSmallProfiledAllocations : public IRMutator {
+    using IRMutator::visit;
+
+    const PipelineProfile &profile;
+    DeviceAPI device_api = DeviceAPI::None;
+
+    Stmt visit(const For *op) override {
+        DeviceAPI new_device_api =
+            op->device_api == DeviceAPI::None ? device_api : op->device_api;
+        ScopedValue<DeviceAPI> old_device_api(device_api, new_device_api);
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const Allocate *op) override {
+        Stmt body = mutate(op->body);
+        Stmt result = body.same_as(op->body) ?
+                          Stmt(op) :
+                          Allocate::make(op->name, op->type, op->memory_type, op->extents,
+                                         op->condition, body, op->new_expr,
+                                         op->free_function, op->padding);
+
+        if (op->memory_type != MemoryType::Auto ||
+            op->new_expr.defined() ||
+            (device_api != DeviceAPI::None && device_api != DeviceAPI::Host) ||
+            op->constant_allocation_size() != 0) {
+            return result;
+        }
+
+        // Only allocations made more than once per run are worth
+        // specializing, and the peak memory use of the Func bounds the
+        // size of any one of its allocations.
+        const FuncProfile *f = find_func_profile(profile, op->name);
+        if (!f || f->memory_peak == 0 || f->num_allocs < 2 * profile.runs) {
+            return result;
+        }
+        const int64_t elem_bytes = op->type.bytes();
+        const int64_t elems = ((int64_t)f->memory_peak + elem_bytes - 1) / elem_bytes;
+        if (!can_allocation_fit_on_stack((elems + op->padding) * elem_bytes)) {
+            return result;
+        }
+
+        debug(2) << "Allocating " << op->name << " on the stack when it has at most "
+                 << elems << " elements\n";
+
+        Expr total_extent = make_const(Int(64), 1);
+        for (const Expr &e : op->extents) {
+            total_extent *= cast<int64_t>(e);
+        }
+        Expr fits = total_extent <= make_const(Int(64), elems);
+
+        // Make both a stack buffer of the peak size and a heap buffer
+        // that is only allocated if the stack buffer is too small, and
+        // point the allocation at whichever one is used. That way the
+        // body is only generated once.
+        const string stack_name = op->name + ".stack";
+        const string heap_name = op->name + ".heap";
+        Expr host = select(fits,
+                           Variable::make(Handle(), stack_name),
+                           Variable::make(Handle(), heap_name));
+        body = RetargetFree(op->name, heap_name).mutate(body);
+        result = Allocate::make(op->name, op->type, op->memory_type, op->extents,
+                                op->condition, body, host, "halide_device_host_nop_free", op->padding);
+        result = Allocate::make(heap_name, op->type, MemoryType::Heap, op->extents,
+                                op->condition && !fits, result, Expr(), "", op->padding);
+        return Allocate::make(stack_name, op->type, MemoryType::Stack, {(int32_t)elems},
+                              const_true(), result, Expr(), "", op->padding);
+    }
+
+public:
+    StackAllocateSmallProfiledAllocations(const PipelineProfile &profile)
+        : profile(profile) {
+    }
+};
+
+}  // namespace
+
+bool is_profiled_allocation_alias(const Allocate *op) {
+    const Select *host = op->new_expr.as<Select>();
+    const Variable *stack = host ? host->true_value.as<Variable>() : nullptr;
+    return stack && stack->name == op->name + ".stack";
+}
+
+const FuncProfile *find_func_profile(const PipelineProfile &profile, const string &name) {
+    // The profiler attributes everything in a Func's loop nest to the
+    // Func named by the part of the loop or allocation name before the
+    // first '.'.
+    auto it = profile.funcs.find(name.substr(0, name.find('.')));
+    return it == profile.funcs.end() ? nullptr : &it->second;
+}
+
+bool load_pipeline_profile(const string &filename,
+                           const string &pipeline_name,
+                           PipelineProfile &profile) {
+    std::ifstream in(filename);
+    user_assert(in.is_open()) << "Could not open profile " << filename << "\n";
+
+    // The file is a sequence of pipeline records, each followed by the
+    // records for its Funcs. Names go last, because Func names may
+    // contain spaces.
+    bool found = false, in_pipeline = false;
+    string line;
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        string kind, name;
+        ss >> kind;
+        if (kind == "pipeline") {
+            PipelineProfile p;
+            ss >> p.runs >> p.samples >> p.time;
+            std::getline(ss >> std::ws, name);
+            user_assert(!ss.fail()) << "Malformed line in profile " << filename << ": " << line << "\n";
+            in_pipeline = (name == pipeline_name) && p.runs > 0;
+            if (in_pipeline) {
+                // If the same pipeline was profiled more than once,
+                // the last profile wins.
+                profile = p;
+                found = true;
+            }
+        } else if (kind == "func") {
+            FuncProfile f;
+            ss >> f.time >> f.num_allocs >> f.memory_peak >> f.stack_peak;
+            std::getline(ss >> std::ws, name);
+            user_assert(!ss.fail()) << "Malformed line in profile " << filename << ": " << line << "\n";
+            if (in_pipeline) {
+                profile.funcs[name] = f;
+            }
+        } else {
+            user_assert(kind.empty()) << "Malformed line in profile " << filename << ": " << line << "\n";
+        }
+    }
+    return found;
+}
+
+Stmt apply_profile_to_loop_partitioning(const Stmt &s, const PipelineProfile &profile) {
+    if (profile.samples < min_samples_for_timing) {
+        debug(1) << "Too few samples in the profile to guide loop partitioning\n";
+        return s;
+    }
+    return NeverPartitionColdLoops(profile).mutate(s);
+}
+
+Stmt apply_profile_to_allocations(const Stmt &s, const PipelineProfile &profile) {
+    return StackAllocateSmallProfiledAllocations(profile).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
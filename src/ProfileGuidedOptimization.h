@@ -0,0 +1,71 @@
+#ifndef HALIDE_PROFILE_GUIDED_OPTIMIZATION_H
+#define HALIDE_PROFILE_GUIDED_OPTIMIZATION_H
+
+/** \file
+ * Defines the lowering passes that use a profile written by the
+ * sampling profiler to guide the compilation of a pipeline.
+ */
+
+#include <map>
+#include <string>
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+struct Allocate;
+
+/** The statistics recorded by the profiler for one Func, summed over
+ * all runs of the pipeline. */
+struct FuncProfile {
+    uint64_t time = 0;
+    int num_allocs = 0;
+    uint64_t memory_peak = 0;
+    uint64_t stack_peak = 0;
+};
+
+/** The statistics recorded by the profiler for one pipeline. */
+struct PipelineProfile {
+    int runs = 0;
+    int samples = 0;
+    uint64_t time = 0;
+    std::map<std::string, FuncProfile> funcs;
+};
+
+/** Read the statistics for the named pipeline from a profile written
+ * by halide_profiler_write_profile. Returns false if the file doesn't
+ * contain the pipeline, or if the pipeline was never run. */
+bool load_pipeline_profile(const std::string &filename,
+                           const std::string &pipeline_name,
+                           PipelineProfile &profile);
+
+/** Find the statistics for the Func that the profiler attributes a
+ * loop, allocation, or producer of the given name to: the Func named by
+ * the part of the name before the first '.'. Returns nullptr if the
+ * profile has no such Func. */
+const FuncProfile *find_func_profile(const PipelineProfile &profile, const std::string &name);
+
+/** Turn off loop partitioning for the loops of Funcs that took a
+ * negligible fraction of the profiled runtime. Partitioning such loops
+ * only makes the code bigger. Loops explicitly scheduled to always be
+ * partitioned are left alone. Must run before loop partitioning. */
+Stmt apply_profile_to_loop_partitioning(const Stmt &s, const PipelineProfile &profile);
+
+/** Heap allocations of dynamic size that the profile shows are made
+ * repeatedly and are always small get a stack allocation of the
+ * largest observed size, which is used whenever the requested size
+ * fits. A heap allocation, only made when it doesn't, is kept as the
+ * fallback. The original allocation then just points at one or the
+ * other. Must run after bounding small allocations. */
+Stmt apply_profile_to_allocations(const Stmt &s, const PipelineProfile &profile);
+
+/** Is this an allocation that apply_profile_to_allocations has pointed
+ * at a stack buffer or its heap fallback? Its memory is accounted for
+ * by those. */
+bool is_profiled_allocation_alias(const Allocate *op);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
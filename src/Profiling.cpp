@@ -3,10 +3,13 @@
 #include <string>
 
 #include "CodeGen_Internal.h"
+#include "ExprUsesVar.h"
 #include "Function.h"
 #include "IRMutator.h"
 #include "IROperator.h"
 #include "InjectHostDevBufferCopies.h"
+#include "PackHeapAllocations.h"
+#include "ProfileGuidedOptimization.h"
 #include "Profiling.h"
 #include "Scope.h"
 #include "Simplify.h"
@@ -89,8 +92,12 @@ public:
     bool in_parallel = false;
     bool in_leaf_task = false;
 
-    InjectProfiling(const Names &names, const map<std::string, Function> &env)
-        : names(names), env(env) {
+    // Whether to record the start and end of each producer for the
+    // timeline view.
+    bool timeline;
+
+    InjectProfiling(const Names &names, const map<std::string, Function> &env, bool timeline)
+        : names(names), env(env), timeline(timeline) {
         stack.push_back(get_func_id("overhead"));
         // ID 0 is treated specially in the runtime as overhead
         internal_assert(stack.back() == 0);
@@ -218,6 +225,11 @@ private:
         return s;
     }
 
+    Stmt timeline_event(int id, bool begin) {
+        return Evaluate::make(Call::make(Int(32), "halide_profiler_timeline_event",
+                                         {profiler_instance, id, (int)begin}, Call::Extern));
+    }
+
     Expr compute_allocation_size(const vector<Expr> &extents,
                                  const Expr &condition,
                                  const Type &type,
@@ -271,6 +283,11 @@ private:
         Expr size = compute_allocation_size(new_extents, condition, op->type, op->name, can_fit_on_stack);
         internal_assert(size.type() == UInt(64));
 
+        if (is_arena_slice(op) || is_profiled_allocation_alias(op)) {
+            // The memory is accounted for by the allocation it points into.
+            size = make_zero(UInt(64));
+        }
+
         bool on_stack = can_fit_on_stack && !op->new_expr.defined();
 
         func_alloc_sizes.push(op->name, {on_stack, size});
@@ -390,6 +407,9 @@ private:
                 stack.push_back(idx);
                 Stmt set_current = set_current_func(idx);
                 body = Block::make(set_current, mutate(op->body));
+                if (timeline) {
+                    body = Block::make({timeline_event(idx, true), body, timeline_event(idx, false)});
+                }
                 stack.pop_back();
             }
         } else {
@@ -482,6 +502,7 @@ private:
             // which means we can't do memory accounting.
             bool old_profiling_memory = profiling_memory;
             profiling_memory = false;
+            ScopedValue<bool> bind_timeline(timeline, false);
             body = mutate(body);
             profiling_memory = old_profiling_memory;
 
@@ -605,14 +626,272 @@ private:
     }
 };
 
+// Whether an Expr can be evaluated elsewhere in the producer than where
+// it was built. It can't if it loads from a buffer, as the buffer may not
+// be allocated there, or may not hold the same values yet.
+bool can_move_expr(const Expr &e) {
+    class ContainsLoad : public IRGraphVisitor {
+        using IRGraphVisitor::visit;
+        void visit(const Load *op) override {
+            result = true;
+        }
+
+    public:
+        bool result = false;
+    } contains_load;
+    e.accept(&contains_load);
+    return !contains_load.result && is_pure(e);
+}
+
+// Counts the bytes loaded and stored by each Func. Rather than bumping a
+// counter at every load and store, we add up the bytes each straight-line
+// piece of code moves, and multiply by the trip count on the way out of
+// each loop, for as long as the result doesn't depend on anything bound
+// inside it, or on a load (from a data-dependent loop extent, say).
+// Usually that's all the way out of the producer, so the cost is one call
+// per producer. Whatever can't be hoisted that far accumulates in a
+// counter on the stack of the producer or parallel task.
+class CountMemoryTraffic : public IRMutator {
+    using IRMutator::visit;
+
+    const map<string, int> &indices;
+    Expr profiler_instance;
+
+    struct Traffic {
+        Expr loaded, stored;
+    };
+
+    // The bytes moved by the code visited so far that haven't been
+    // counted yet, valid at the start of the enclosing statement.
+    Traffic pending;
+
+    // The counter for the current producer or task, and whether
+    // anything has been added to it.
+    string counter;
+    bool counter_used = false;
+    int func_id = 0;
+
+    static Expr bytes(Type t) {
+        return make_const(UInt(64), t.bytes() * t.lanes());
+    }
+
+    // Add two byte counts, either of which may be undefined, keeping
+    // any constant term on the right so that it folds with later ones.
+    static Expr add(const Expr &a, const Expr &b) {
+        if (!a.defined()) {
+            return b;
+        } else if (!b.defined()) {
+            return a;
+        }
+        auto ca = as_const_uint(a), cb = as_const_uint(b);
+        if (ca && cb) {
+            return make_const(UInt(64), *ca + *cb);
+        } else if (ca) {
+            return add(b, a);
+        }
+        if (const Add *sum = a.as<Add>()) {
+            if (auto c = as_const_uint(sum->b)) {
+                return cb ? sum->a + make_const(UInt(64), *c + *cb) : (sum->a + b) + sum->b;
+            }
+        }
+        return a + b;
+    }
+
+    Expr load_counter(int idx) {
+        return Load::make(UInt(64), counter, idx, Buffer<>(), Parameter(), const_true(), ModulusRemainder());
+    }
+
+    Stmt store_counter(const Expr &value, int idx) {
+        return Store::make(counter, value, idx, Parameter(), const_true(), ModulusRemainder());
+    }
+
+    // Add some bytes to the counter at the start of a statement.
+    Stmt count_in_counter(const Traffic &t, const Stmt &s) {
+        vector<Stmt> stmts;
+        if (t.loaded.defined()) {
+            stmts.push_back(store_counter(load_counter(0) + simplify(t.loaded), 0));
+        }
+        if (t.stored.defined()) {
+            stmts.push_back(store_counter(load_counter(1) + simplify(t.stored), 1));
+        }
+        if (stmts.empty()) {
+            return s;
+        }
+        counter_used = true;
+        stmts.push_back(s);
+        return Block::make(stmts);
+    }
+
+    // The body of a loop or let has finished with the given bytes still
+    // pending. Hoist them out of the statement (times the trip count, for
+    // loops) if they don't depend on the variable it binds or on any
+    // loads, otherwise count them inside it. Nothing pending ever contains
+    // a load, so counts never move past the Allocate or producer of a
+    // buffer they read.
+    Stmt hoist_out_of(const string &var, const Expr &trip_count, const Traffic &inner, const Stmt &body) {
+        const bool can_move_trip_count = !trip_count.defined() || can_move_expr(trip_count);
+        Traffic in_body;
+        for (auto field : {&Traffic::loaded, &Traffic::stored}) {
+            const Expr &e = inner.*field;
+            if (!e.defined()) {
+                continue;
+            } else if (expr_uses_var(e, var) || !can_move_trip_count) {
+                in_body.*field = e;
+            } else {
+                pending.*field = add(pending.*field, trip_count.defined() ? e * trip_count : e);
+            }
+        }
+        return count_in_counter(in_body, body);
+    }
+
+    // Code that may run on another thread gets its own counter, which is
+    // added to the given Func's stats when it finishes.
+    Stmt count_in_new_task(const Stmt &s, int id) {
+        ScopedValue<Traffic> bind_pending(pending, Traffic());
+        ScopedValue<string> bind_counter(counter, unique_name("memory_traffic"));
+        ScopedValue<bool> bind_counter_used(counter_used, false);
+        ScopedValue<int> bind_func_id(func_id, id);
+
+        Stmt body = mutate(s);
+        Expr loaded = pending.loaded, stored = pending.stored;
+        if (counter_used) {
+            loaded = add(loaded, load_counter(0));
+            stored = add(stored, load_counter(1));
+        }
+        if (!loaded.defined() && !stored.defined()) {
+            return body;
+        }
+        loaded = loaded.defined() ? simplify(loaded) : make_zero(UInt(64));
+        stored = stored.defined() ? simplify(stored) : make_zero(UInt(64));
+
+        Stmt count = Evaluate::make(Call::make(Int(32), "halide_profiler_memory_traffic",
+                                               {profiler_instance, id, loaded, stored}, Call::Extern));
+        body = Block::make(body, count);
+        if (counter_used) {
+            body = Block::make({store_counter(make_zero(UInt(64)), 0),
+                                store_counter(make_zero(UInt(64)), 1),
+                                body,
+                                Free::make(counter)});
+            body = Allocate::make(counter, UInt(64), MemoryType::Stack, {2}, const_true(), body);
+        }
+        return body;
+    }
+
+    Expr visit(const Load *op) override {
+        pending.loaded = add(pending.loaded, bytes(op->type));
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const Store *op) override {
+        pending.stored = add(pending.stored, bytes(op->value.type()));
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const ProducerConsumer *op) override {
+        auto it = indices.find(op->name.substr(0, op->name.find('.')));
+        if (!op->is_producer || it == indices.end()) {
+            return IRMutator::visit(op);
+        }
+        Stmt body = count_in_new_task(op->body, it->second);
+        return ProducerConsumer::make(op->name, op->is_producer, body);
+    }
+
+    Stmt visit(const Fork *op) override {
+        Stmt first = count_in_new_task(op->first, func_id);
+        Stmt rest = count_in_new_task(op->rest, func_id);
+        return Fork::make(first, rest);
+    }
+
+    Stmt visit(const For *op) override {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // We can't count what happens on other devices.
+            return op;
+        }
+        Expr min = mutate(op->min);
+        Expr extent = mutate(op->extent);
+        Stmt body;
+        if (op->is_unordered_parallel()) {
+            body = count_in_new_task(op->body, func_id);
+        } else {
+            Traffic outer = pending;
+            pending = Traffic();
+            body = mutate(op->body);
+            Traffic inner = pending;
+            pending = outer;
+            Expr trip_count = cast<uint64_t>(max(op->extent, 0));
+            body = hoist_out_of(op->name, trip_count, inner, body);
+        }
+        return For::make(op->name, min, extent, op->for_type, op->partition_policy, op->device_api, body);
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        Expr value = mutate(op->value);
+        Traffic outer = pending;
+        pending = Traffic();
+        Stmt body = mutate(op->body);
+        Traffic inner = pending;
+        pending = outer;
+        body = hoist_out_of(op->name, Expr(), inner, body);
+        return LetStmt::make(op->name, value, body);
+    }
+
+    Stmt visit(const IfThenElse *op) override {
+        Expr condition = mutate(op->condition);
+        Traffic outer = pending;
+        pending = Traffic();
+        Stmt then_case = mutate(op->then_case);
+        Traffic then_traffic = pending;
+        pending = Traffic();
+        Stmt else_case = mutate(op->else_case);
+        Traffic else_traffic = pending;
+        pending = outer;
+
+        if (can_move_expr(condition)) {
+            // Count whichever side runs with a select, so that it can
+            // keep moving outwards.
+            for (auto field : {&Traffic::loaded, &Traffic::stored}) {
+                const Expr &t = then_traffic.*field, &e = else_traffic.*field;
+                if (t.defined() || e.defined()) {
+                    pending.*field = add(pending.*field,
+                                         select(condition,
+                                                t.defined() ? t : make_zero(UInt(64)),
+                                                e.defined() ? e : make_zero(UInt(64))));
+                }
+            }
+        } else {
+            then_case = count_in_counter(then_traffic, then_case);
+            if (else_traffic.loaded.defined() || else_traffic.stored.defined()) {
+                else_case = count_in_counter(else_traffic, else_case.defined() ? else_case : Evaluate::make(0));
+            }
+        }
+        return IfThenElse::make(condition, then_case, else_case);
+    }
+
+public:
+    CountMemoryTraffic(const map<string, int> &indices, const Expr &profiler_instance)
+        : indices(indices), profiler_instance(profiler_instance) {
+    }
+
+    Stmt count(const Stmt &s) {
+        // Anything outside of a producer is overhead.
+        return count_in_new_task(s, 0);
+    }
+};
+
 }  // namespace
 
-Stmt inject_profiling(const Stmt &stmt, const string &pipeline_name, const std::map<string, Function> &env) {
+Stmt inject_profiling(const Stmt &stmt, const string &pipeline_name, const std::map<string, Function> &env,
+                      const Target &target) {
     Names names(pipeline_name);
 
-    InjectProfiling profiling(names, env);
+    InjectProfiling profiling(names, env, target.has_feature(Target::ProfileTimeline));
     Stmt s = profiling.mutate(stmt);
 
+    if (target.has_feature(Target::ProfileMemoryTraffic)) {
+        s = CountMemoryTraffic(profiling.indices, Variable::make(Handle(), names.profiler_instance)).count(s);
+    }
+
     int num_funcs = (int)(profiling.indices.size());
 
     // TODO: unique_name all these strings
@@ -640,6 +919,11 @@ Stmt inject_profiling(const Stmt &stmt, const string &pipeline_name, const std::
 
     s = profiling.activate_main_thread(s);
 
+    if (target.has_feature(Target::ProfileTimeline)) {
+        Expr enable_timeline = Call::make(Int(32), "halide_profiler_timeline_enable", {}, Call::Extern);
+        s = Block::make(Evaluate::make(enable_timeline), s);
+    }
+
     // Initialize the shared sampling token
     Expr shared_sampling_token_var = Variable::make(Handle(), names.profiler_shared_sampling_token);
     Expr init_sampling_token =
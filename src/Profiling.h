@@ -29,6 +29,9 @@
 #include "Expr.h"
 
 namespace Halide {
+
+struct Target;
+
 namespace Internal {
 
 class Function;
@@ -37,10 +40,13 @@ class Function;
  * high-resolution timing into the generated code (via spawning a
  * thread that acts as a sampling profiler); summaries of execution
  * times and counts will be logged at the end. Should be done before
- * storage flattening, but after all bounds inference.
- *
+ * storage flattening, but after all bounds inference. With the
+ * profile_timeline target feature, also record the start and end of each
+ * producer on each thread (see halide_profiler_write_timeline). With
+ * profile_memory_traffic, also count the bytes each Func loads and stores.
  */
-Stmt inject_profiling(const Stmt &, const std::string &, const std::map<std::string, Function> &env);
+Stmt inject_profiling(const Stmt &, const std::string &, const std::map<std::string, Function> &env,
+                      const Target &target);
 
 }  // namespace Internal
 }  // namespace Halide
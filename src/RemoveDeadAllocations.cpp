@@ -53,17 +53,21 @@ class RemoveDeadAllocations : public IRMutator {
     }
 
     Stmt visit(const Allocate *op) override {
+        // The new_expr may point into an enclosing allocation (e.g. a
+        // slice of a heap arena), which counts as a use of it.
+        Expr new_expr = op->new_expr.defined() ? mutate(op->new_expr) : op->new_expr;
+
         allocs.push(op->name, 1);
         Stmt body = mutate(op->body);
 
         if (allocs.contains(op->name) && op->free_function.empty()) {
             allocs.pop(op->name);
             return body;
-        } else if (body.same_as(op->body)) {
+        } else if (body.same_as(op->body) && new_expr.same_as(op->new_expr)) {
             return op;
         } else {
             return Allocate::make(op->name, op->type, op->memory_type, op->extents, op->condition,
-                                  body, op->new_expr, op->free_function, op->padding);
+                                  body, new_expr, op->free_function, op->padding);
         }
     }
 
@@ -241,6 +241,7 @@ struct FuncScheduleContents {
     MemoryType memory_type = MemoryType::Auto;
     bool memoized = false;
     bool async = false;
+    bool store_nontemporal = false;
     // This is an extent of the ring buffer and expected to be a positive integer.
     Expr ring_buffer;
     Expr memoize_eviction_key;
@@ -364,6 +365,7 @@ FuncSchedule FuncSchedule::deep_copy(
     copy.contents->memoized = contents->memoized;
     copy.contents->memoize_eviction_key = contents->memoize_eviction_key;
     copy.contents->async = contents->async;
+    copy.contents->store_nontemporal = contents->store_nontemporal;
     copy.contents->ring_buffer = contents->ring_buffer;
 
     // Deep-copy wrapper functions.
@@ -408,6 +410,14 @@ bool FuncSchedule::async() const {
     return contents->async;
 }
 
+bool &FuncSchedule::store_nontemporal() {
+    return contents->store_nontemporal;
+}
+
+bool FuncSchedule::store_nontemporal() const {
+    return contents->store_nontemporal;
+}
+
 Expr &FuncSchedule::ring_buffer() {
     return contents->ring_buffer;
 }
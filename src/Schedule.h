@@ -149,6 +149,24 @@ enum class LoopAlignStrategy {
     Auto
 };
 
+/** Different orders in which a fused dimension can visit the pairs of
+ * values of the two dimensions it was fused from. See \ref Func::fuse. */
+enum class FuseOrder {
+    /** Visit every value of the inner dimension for one value of the
+     * outer dimension before moving on to the next. This is the
+     * default, and is the same as the loop nest the fuse replaces. */
+    Lexicographic,
+
+    /** Visit the pairs along a Z-order (Morton) curve, which recursively
+     * visits the four quadrants of the domain in turn. */
+    Morton,
+
+    /** Visit the pairs along a Hilbert curve. Like Morton order, this
+     * visits the quadrants of the domain recursively, but consecutive
+     * pairs are always adjacent. */
+    Hilbert
+};
+
 /** A reference to a site in a Halide statement at the top of the
  * body of a particular for loop. Evaluating a region of a halide
  * function is done by generating a loop nest that spans its
@@ -343,6 +361,10 @@ struct Split {
     // If split_type is Fuse, then this does the opposite of a
     // split, it joins the outer and inner into the old_var.
     SplitType split_type;
+
+    // If split_type is Fuse, the order in which the old_var visits
+    // the values of the inner and outer.
+    FuseOrder fuse_order = FuseOrder::Lexicographic;
 };
 
 /** Each Dim below has a dim_type, which tells you what
@@ -606,6 +628,13 @@ public:
     bool &async();
     bool async() const;
 
+    /** Are the stores to this Function made with non-temporal
+     * (streaming) stores that bypass the cache. */
+    // @{
+    bool &store_nontemporal();
+    bool store_nontemporal() const;
+    // @}
+
     Expr &ring_buffer();
     Expr &ring_buffer() const;
 
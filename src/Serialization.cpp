@@ -24,10 +24,21 @@ using flatbuffers::FlatBufferBuilder;
 using flatbuffers::Offset;
 using flatbuffers::String;
 
+// Buffer contents are aligned to this many bytes, so that they can be
+// used in place when the serialized pipeline is memory-mapped.
+constexpr size_t buffer_data_alignment = 128;
+
 class Serializer {
 public:
     Serializer() = default;
 
+    // Store the contents of buffers with at least external_data_threshold
+    // bytes of data in the file external_data_filename, relative to the
+    // directory of the serialized pipeline, instead of in the pipeline.
+    Serializer(const std::string &external_data_filename, size_t external_data_threshold)
+        : external_data_filename(external_data_filename), external_data_threshold(external_data_threshold) {
+    }
+
     // Serialize the given pipeline into the given filename
     void serialize(const Pipeline &pipeline, const std::string &filename);
 
@@ -54,6 +65,11 @@ private:
     // so it can later be used during deserialization to have the correct bindings.
     std::map<std::string, Parameter> external_parameters;
 
+    // Where to store the contents of large buffers, if anywhere
+    std::string external_data_filename;
+    size_t external_data_threshold = 0;
+    std::ofstream external_data;
+
     Serialize::MemoryType serialize_memory_type(const MemoryType &memory_type);
 
     Serialize::ForType serialize_for_type(const ForType &for_type);
@@ -74,6 +90,8 @@ private:
 
     Serialize::SplitType serialize_split_type(const Split::SplitType &split_type);
 
+    Serialize::FuseOrder serialize_fuse_order(const FuseOrder &fuse_order);
+
     Serialize::DimType serialize_dim_type(const DimType &dim_type);
 
     Serialize::LoopAlignStrategy serialize_loop_align_strategy(const LoopAlignStrategy &loop_align_strategy);
@@ -344,6 +362,20 @@ Serialize::SplitType Serializer::serialize_split_type(const Split::SplitType &sp
     }
 }
 
+Serialize::FuseOrder Serializer::serialize_fuse_order(const FuseOrder &fuse_order) {
+    switch (fuse_order) {
+    case FuseOrder::Lexicographic:
+        return Serialize::FuseOrder::Lexicographic;
+    case FuseOrder::Morton:
+        return Serialize::FuseOrder::Morton;
+    case FuseOrder::Hilbert:
+        return Serialize::FuseOrder::Hilbert;
+    default:
+        user_error << "Unsupported fuse order\n";
+        return Serialize::FuseOrder::Lexicographic;
+    }
+}
+
 Serialize::DimType Serializer::serialize_dim_type(const DimType &dim_type) {
     switch (dim_type) {
     case DimType::PureVar:
@@ -1118,6 +1150,7 @@ Offset<Serialize::FuncSchedule> Serializer::serialize_func_schedule(FlatBufferBu
     const auto async = func_schedule.async();
     const auto ring_buffer = serialize_expr(builder, func_schedule.ring_buffer());
     const auto memoize_eviction_key_serialized = serialize_expr(builder, func_schedule.memoize_eviction_key());
+    const auto store_nontemporal = func_schedule.store_nontemporal();
     return Serialize::CreateFuncSchedule(builder, store_level_serialized, compute_level_serialized,
                                          hoist_storage_level_serialized,
                                          builder.CreateVector(storage_dims_serialized),
@@ -1125,7 +1158,8 @@ Offset<Serialize::FuncSchedule> Serializer::serialize_func_schedule(FlatBufferBu
                                          builder.CreateVector(estimates_serialized),
                                          builder.CreateVector(wrappers_serialized),
                                          memory_type, memoized, async, ring_buffer.first, ring_buffer.second,
-                                         memoize_eviction_key_serialized.first, memoize_eviction_key_serialized.second);
+                                         memoize_eviction_key_serialized.first, memoize_eviction_key_serialized.second,
+                                         store_nontemporal);
 }
 
 Offset<Serialize::Specialization> Serializer::serialize_specialization(FlatBufferBuilder &builder, const Specialization &specialization) {
@@ -1225,10 +1259,12 @@ Offset<Serialize::Split> Serializer::serialize_split(FlatBufferBuilder &builder,
     const auto exact = split.exact;
     const auto tail_serialized = serialize_tail_strategy(split.tail);
     const auto split_type_serialized = serialize_split_type(split.split_type);
+    const auto fuse_order_serialized = serialize_fuse_order(split.fuse_order);
     return Serialize::CreateSplit(builder, old_var_serialized,
                                   outer_serialized, inner_serialized,
                                   factor_serialized.first, factor_serialized.second,
-                                  exact, tail_serialized, split_type_serialized);
+                                  exact, tail_serialized, split_type_serialized,
+                                  fuse_order_serialized);
 }
 
 Offset<Serialize::Dim> Serializer::serialize_dim(FlatBufferBuilder &builder, const Dim &dim) {
@@ -1417,10 +1453,19 @@ Offset<Serialize::Buffer> Serializer::serialize_buffer(FlatBufferBuilder &builde
         buffer_dimensions_serialized.push_back(Serialize::CreateBufferDimension(builder, min, extent, stride));
     }
     auto copy = buffer.copy();  // compact in memory
-    std::vector<uint8_t> data;
-    data.resize(copy.size_in_bytes());
-    memcpy(data.data(), copy.data(), copy.size_in_bytes());
-    return Serialize::CreateBuffer(builder, true, name_serialized, type_serialized, dimensions, builder.CreateVector(buffer_dimensions_serialized), builder.CreateVector(data));
+    const size_t size = copy.size_in_bytes();
+    const auto dims_serialized = builder.CreateVector(buffer_dimensions_serialized);
+    if (external_data.is_open() && size > 0 && size >= external_data_threshold) {
+        uint64_t offset = external_data.tellp();
+        const uint64_t padding = (buffer_data_alignment - offset % buffer_data_alignment) % buffer_data_alignment;
+        external_data.write(std::string(padding, '\0').data(), padding);
+        offset += padding;
+        external_data.write((const char *)copy.data(), size);
+        return Serialize::CreateBuffer(builder, true, name_serialized, type_serialized, dimensions, dims_serialized, 0, offset, size);
+    }
+    builder.ForceVectorAlignment(size, sizeof(uint8_t), buffer_data_alignment);
+    const auto data_serialized = builder.CreateVector((const uint8_t *)copy.data(), size);
+    return Serialize::CreateBuffer(builder, true, name_serialized, type_serialized, dimensions, dims_serialized, data_serialized);
 }
 
 std::vector<Offset<Serialize::WrapperRef>> Serializer::serialize_wrapper_refs(FlatBufferBuilder &builder, const std::map<std::string, FunctionPtr> &wrappers) {
@@ -1526,7 +1571,8 @@ void Serializer::serialize(const Pipeline &pipeline, std::vector<uint8_t> &resul
                                                   builder.CreateVector(external_parameters_serialized),
                                                   builder.CreateVector(buffers_serialized),
                                                   serialize_string(builder, halide_version),
-                                                  serialize_string(builder, serialization_version));
+                                                  serialize_string(builder, serialization_version),
+                                                  external_data.is_open() ? serialize_string(builder, external_data_filename) : Offset<String>());
     builder.Finish(pipeline_obj);
 
     uint8_t *buf = builder.GetBufferPointer();
@@ -1542,8 +1588,17 @@ void Serializer::serialize(const Pipeline &pipeline, std::vector<uint8_t> &resul
 }
 
 void Serializer::serialize(const Pipeline &pipeline, const std::string &filename) {
+    if (!external_data_filename.empty()) {
+        const std::string path = resolve_relative_path(filename, external_data_filename);
+        external_data.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        user_assert(external_data) << "failed to open file " << path << "\n";
+    }
     std::vector<uint8_t> data;
     serialize(pipeline, data);
+    if (external_data.is_open()) {
+        external_data.close();
+        user_assert(external_data) << "failed to write external data for " << filename << "\n";
+    }
     std::ofstream out(filename, std::ios::out | std::ios::binary);
     if (!out) {
         user_error << "failed to open file " << filename << "\n";
@@ -1577,6 +1632,13 @@ void serialize_pipeline(const Pipeline &pipeline, const std::string &filename, s
     params = serializer.get_external_parameters();
 }
 
+void serialize_pipeline(const Pipeline &pipeline, const std::string &filename,
+                        const std::string &external_data_filename, size_t external_data_threshold) {
+    user_assert(!external_data_filename.empty()) << "serialize_pipeline needs a filename for the external data\n";
+    Internal::Serializer serializer(external_data_filename, external_data_threshold);
+    serializer.serialize(pipeline, filename);
+}
+
 }  // namespace Halide
 
 #else  // WITH_SERIALIZATION
@@ -1599,6 +1661,11 @@ void serialize_pipeline(const Pipeline &pipeline, const std::string &filename, s
     user_error << "Serialization is not supported in this build of Halide; try rebuilding with WITH_SERIALIZATION=ON.";
 }
 
+void serialize_pipeline(const Pipeline &pipeline, const std::string &filename,
+                        const std::string &external_data_filename, size_t external_data_threshold) {
+    user_error << "Serialization is not supported in this build of Halide; try rebuilding with WITH_SERIALIZATION=ON.";
+}
+
 }  // namespace Halide
 
 #endif  // WITH_SERIALIZATION
@@ -27,6 +27,14 @@ void serialize_pipeline(const Pipeline &pipeline, const std::string &filename);
 /// @param params Map of named parameters which will get populated during serialization (can be used to bind external parameters to objects in the pipeline by name).
 void serialize_pipeline(const Pipeline &pipeline, const std::string &filename, std::map<std::string, Parameter> &params);
 
+/// @brief Serialize a Halide pipeline into the given filename, storing the contents of large buffers in a separate file.
+/// @param pipeline The Halide pipeline to serialize.
+/// @param filename The location of the file to write into to store the serialized pipeline.  Any existing contents will be destroyed.
+/// @param external_data_filename The location of the file to store the contents of large buffers into, relative to the directory of filename.  Any existing contents will be destroyed.
+/// @param external_data_threshold Buffers with at least this many bytes of data are stored in the separate file.
+void serialize_pipeline(const Pipeline &pipeline, const std::string &filename,
+                        const std::string &external_data_filename, size_t external_data_threshold);
+
 }  // namespace Halide
 
 #endif
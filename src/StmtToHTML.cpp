@@ -5,12 +5,14 @@
 #include "IRPrinter.h"
 #include "IRVisitor.h"
 #include "Module.h"
+#include "ProfileGuidedOptimization.h"
 #include "Scope.h"
 #include "Substitute.h"
 #include "Util.h"
 
 #include <cstdio>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <regex>
@@ -683,6 +685,17 @@ public:
         cost_model = std::move(cm);
     }
 
+    void init_profile_info(const PipelineProfile &p) {
+        profile = p;
+        has_profile = true;
+    }
+
+    // Comments to add to lines of the host assembly, describing the
+    // profile of the loops and producers that start there.
+    const std::map<int, std::string> &get_asm_profile_annotations() const {
+        return asm_profile_annotations;
+    }
+
     void print_conceptual_stmt(const Module &m, AssemblyInfo host_asm_info, AssemblyInfo device_asm_info) {
         host_assembly_info = std::move(host_asm_info);
         device_assembly_info = std::move(device_asm_info);
@@ -986,6 +999,11 @@ private:
     AssemblyInfo device_assembly_info;
     bool enable_assembly_features;
 
+    // Holds the profile of the visualized program, if any
+    PipelineProfile profile;
+    bool has_profile = false;
+    std::map<int, std::string> asm_profile_annotations;
+
     /* Private print functions to handle various IR types */
     void print(const Buffer<> &buf) {
         // Open div to hold this buffer
@@ -1116,6 +1134,7 @@ private:
         stream << "</label><div class='op-btns'>";
         if (op) {
             print_assembly_button(op);
+            print_profile_badge(op);
         }
         stream << "</div>";
     }
@@ -1181,6 +1200,57 @@ private:
         }
     }
 
+    // Prints the share of the profiled runtime spent in the Func that a
+    // loop or producer belongs to, colored by how hot the Func is.
+    void print_profile_badge(const IRNode *op) {
+        if (!has_profile || profile.time == 0) {
+            return;
+        }
+        std::string name;
+        if (op->node_type == IRNodeType::For) {
+            name = ((const For *)op)->name;
+        } else if (op->node_type == IRNodeType::ProducerConsumer &&
+                   ((const ProducerConsumer *)op)->is_producer) {
+            name = ((const ProducerConsumer *)op)->name;
+        } else {
+            return;
+        }
+        const FuncProfile *f = find_func_profile(profile, name);
+        if (!f) {
+            return;
+        }
+        const std::string func_name = name.substr(0, name.find('.'));
+
+        const int num_heat_buckets = 10;
+        const double share = (double)f->time / profile.time;
+        const int heat = std::min(num_heat_buckets - 1, (int)(share * num_heat_buckets));
+        const double ms_per_run = f->time / (1e6 * std::max(profile.runs, 1));
+        // The profiler only counts samples per pipeline, so estimate the
+        // number that landed in this Func from its share of the time.
+        const int samples = (int)std::lround(share * profile.samples);
+
+        std::ostringstream percent, ms;
+        percent << std::fixed << std::setprecision(1) << share * 100 << "%";
+        ms << std::fixed << std::setprecision(3) << ms_per_run << " ms";
+
+        stream << "<div class='profile-badge tooltip-parent ProfileHeat" << heat << "'>"
+               << percent.str()
+               << "<span class='tooltip' role='tooltip'>"
+               << "Func " << escape_html(func_name) << "<br/>"
+               << ms.str() << " per run, " << percent.str() << " of the pipeline<br/>"
+               << "~" << samples << " of " << profile.samples << " samples";
+        if (f->memory_peak) {
+            stream << "<br/>Peak heap: " << f->memory_peak << " bytes in "
+                   << f->num_allocs << " allocations";
+        }
+        stream << "</span></div>";
+
+        int asm_lno = host_assembly_info.get_asm_lno((uint64_t)op);
+        if (asm_lno != -1) {
+            asm_profile_annotations[asm_lno] = func_name + ": " + percent.str() + ", " + ms.str() + " per run";
+        }
+    }
+
     // Prints the args in a function declaration
     void print_fndecl_args(const std::vector<LoweredArgument> &args) {
         bool print_delim = false;
@@ -2272,8 +2342,10 @@ public:
     explicit PipelineHTMLInspector(const std::string &html_output_filename,
                                    const Module &m,
                                    const std::string &assembly_input_filename,
+                                   const std::string &profile_filename,
                                    bool use_conceptual_stmt_ir)
-        : use_conceptual_stmt_ir(use_conceptual_stmt_ir),
+        : profile_filename(profile_filename),
+          use_conceptual_stmt_ir(use_conceptual_stmt_ir),
           html_code_printer(stream, node_ids, true) {
         // Open output file
         stream.open(html_output_filename.c_str());
@@ -2332,6 +2404,22 @@ public:
         cost_model.finalize_cost_computation();
         html_code_printer.init_cost_info(cost_model);
 
+        // Overlay the profile of an earlier run, if we were given one
+        if (!profile_filename.empty()) {
+            for (const auto &fn : m.functions()) {
+                PipelineProfile profile;
+                if (load_pipeline_profile(profile_filename, fn.name, profile)) {
+                    html_code_printer.init_profile_info(profile);
+                    has_profile = true;
+                    break;
+                }
+            }
+            if (!has_profile) {
+                user_warning << "The profile " << profile_filename
+                             << " contains no runs of module " << m.name() << "\n";
+            }
+        }
+
         // Generate html page
         stream << "<!DOCTYPE html>\n";
         stream << "<html lang='en'>\n";
@@ -2347,6 +2435,10 @@ private:
     // Holds cost information for visualized program
     IRCostModel cost_model;
 
+    // The profile to overlay on the program, if any
+    std::string profile_filename;
+    bool has_profile = false;
+
     // Annotate AST nodes with unique IDs
     std::map<const IRNode *, int> node_ids;
 
@@ -2402,6 +2494,9 @@ private:
         stream << "   <label><input type='checkbox' name='checkbox-show-ir-wrap' checked />Wrap</label>\n";
         stream << "   <label><input type='checkbox' name='checkbox-show-ir-line-nums' checked />Line numbers</label>\n";
         stream << "   <label><input type='checkbox' name='checkbox-show-ir-costs' checked />Costs</label>\n";
+        if (has_profile) {
+            stream << "   <label><input type='checkbox' name='checkbox-show-ir-profile' checked />Profile</label>\n";
+        }
         stream << "</form>\n";
 
         // Which panes to show
@@ -2460,14 +2555,20 @@ private:
         stream << "<div id='host-assembly-pane' class='pane'>\n";
         stream << "<div id='assemblyContent' class='shj-lang-asm'>\n";
         stream << "<pre>\n";
+        const auto &profile_annotations = html_code_printer.get_asm_profile_annotations();
         std::istringstream ss{asm_stream.str()};
-        for (std::string line; std::getline(ss, line);) {
+        int lno = 1;
+        for (std::string line; std::getline(ss, line); lno++) {
             if (line.length() > 500) {
                 // Very long lines in the assembly are typically the _gpu_kernel_sources
                 // as a raw ASCII block in the assembly. Let's chop that off to make
                 // browsers faster when dealing with this.
                 line = line.substr(0, 100) + "\" # omitted the remainder of the ASCII buffer";
             }
+            auto it = profile_annotations.find(lno);
+            if (it != profile_annotations.end()) {
+                line += "  # profile: " + it->second;
+            }
             stream << html_code_printer.escape_html(line) << "\n";
         }
         stream << "\n";
@@ -2539,16 +2640,18 @@ private:
 // The external interface to this module
 void print_to_stmt_html(const std::string &html_output_filename,
                         const Module &m,
-                        const std::string &assembly_input_filename) {
-    PipelineHTMLInspector inspector(html_output_filename, m, assembly_input_filename, false);
+                        const std::string &assembly_input_filename,
+                        const std::string &profile_filename) {
+    PipelineHTMLInspector inspector(html_output_filename, m, assembly_input_filename, profile_filename, false);
     inspector.generate_html(m);
     debug(1) << "Done generating HTML IR Inspector - printed to: " << html_output_filename << "\n";
 }
 
 void print_to_conceptual_stmt_html(const std::string &html_output_filename,
                                    const Module &m,
-                                   const std::string &assembly_input_filename) {
-    PipelineHTMLInspector inspector(html_output_filename, m, assembly_input_filename, true);
+                                   const std::string &assembly_input_filename,
+                                   const std::string &profile_filename) {
+    PipelineHTMLInspector inspector(html_output_filename, m, assembly_input_filename, profile_filename, true);
     inspector.generate_html(m);
     debug(1) << "Done generating HTML Conceptual IR Inspector - printed to: " << html_output_filename << "\n";
 }
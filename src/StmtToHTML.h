@@ -19,19 +19,25 @@ struct Stmt;
  * If assembly_input_filename is not empty, it is expected to be the path
  * to assembly output. If empty, the code will attempt to find such a
  * file based on output_filename (replacing ".stmt.html" with ".s"),
- * and will assert-fail if no such file is found. */
+ * and will assert-fail if no such file is found. If profile_filename
+ * is not empty, it is expected to be a profile of the Module written by
+ * halide_profiler_write_profile, and each producer and loop is annotated
+ * with the share of the runtime spent in its Func. */
 void print_to_stmt_html(const std::string &html_output_filename,
                         const Module &m,
-                        const std::string &assembly_input_filename = "");
+                        const std::string &assembly_input_filename = "",
+                        const std::string &profile_filename = "");
 
 /** Dump an HTML-formatted visualization of a Module's conceptual Stmt code to filename.
  * If assembly_input_filename is not empty, it is expected to be the path
  * to assembly output. If empty, the code will attempt to find such a
  * file based on output_filename (replacing ".stmt.html" with ".s"),
- * and will assert-fail if no such file is found. */
+ * and will assert-fail if no such file is found. The profile_filename
+ * is used as in print_to_stmt_html. */
 void print_to_conceptual_stmt_html(const std::string &html_output_filename,
                                    const Module &m,
-                                   const std::string &assembly_input_filename = "");
+                                   const std::string &assembly_input_filename = "",
+                                   const std::string &profile_filename = "");
 
 }  // namespace Internal
 }  // namespace Halide
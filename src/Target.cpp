@@ -744,6 +744,13 @@ const std::map<std::string, Target::Feature> feature_name_map = {
     {"semihosting", Target::Semihosting},
     {"avx10_1", Target::AVX10_1},
     {"x86apx", Target::X86APX},
+    {"arena_allocations", Target::ArenaAllocations},
+    {"workspace", Target::Workspace},
+    {"lazy_jit", Target::LazyJIT},
+    {"aligned_fast_path", Target::AlignedFastPath},
+    {"widen_float16_math", Target::WidenFloat16Math},
+    {"profile_timeline", Target::ProfileTimeline},
+    {"profile_memory_traffic", Target::ProfileMemoryTraffic},
     // NOTE: When adding features to this map, be sure to update PyEnums.cpp as well.
 };
 
@@ -182,6 +182,13 @@ struct Target {
         Semihosting = halide_target_feature_semihosting,
         AVX10_1 = halide_target_feature_avx10_1,
         X86APX = halide_target_feature_x86_apx,
+        ArenaAllocations = halide_target_feature_arena_allocations,
+        Workspace = halide_target_feature_workspace,
+        LazyJIT = halide_target_feature_lazy_jit,
+        AlignedFastPath = halide_target_feature_aligned_fast_path,
+        WidenFloat16Math = halide_target_feature_widen_float16_math,
+        ProfileTimeline = halide_target_feature_profile_timeline,
+        ProfileMemoryTraffic = halide_target_feature_profile_memory_traffic,
         FeatureEnd = halide_target_feature_end
     };
     Target() = default;
@@ -20,6 +20,7 @@
 #include <io.h>
 #else
 #include <cstdlib>
+#include <fcntl.h>
 #include <sys/mman.h>  // For mmap
 #include <unistd.h>
 #endif
@@ -132,10 +133,21 @@ std::string get_env_variable(char const *env_var_name) {
 }
 
 string running_program_name() {
-#ifndef CAN_GET_RUNNING_PROGRAM_NAME
+    string path = get_executable_path();
+    return path.substr(path.find_last_of("/\\") + 1);
+}
+
+string get_executable_path() {
+#ifdef _WIN32
+    char path[MAX_PATH] = {0};
+    DWORD len = GetModuleFileNameA(nullptr, path, MAX_PATH);
+    if (len == 0 || len >= MAX_PATH) {
+        return "";
+    }
+    return string(path, len);
+#elif !defined(CAN_GET_RUNNING_PROGRAM_NAME)
     return "";
 #else
-    string program_name;
     char path[PATH_MAX] = {0};
     uint32_t size = sizeof(path);
 #if defined(__linux__)
@@ -143,16 +155,36 @@ string running_program_name() {
 #elif defined(__APPLE__)
     ssize_t len = ::_NSGetExecutablePath(path, &size);
 #endif
-    if (len != -1) {
+    if (len == -1) {
+        return "";
+    }
 #if defined(__linux__)
-        path[len] = '\0';
+    path[len] = '\0';
 #endif
-        string tmp = std::string(path);
-        program_name = tmp.substr(tmp.find_last_of('/') + 1);
-    } else {
+    return string(path);
+#endif
+}
+
+string get_libhalide_path() {
+#ifdef _WIN32
+    HMODULE module = nullptr;
+    if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+                                GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                            (LPCSTR)&get_libhalide_path, &module)) {
+        return "";
+    }
+    char path[MAX_PATH] = {0};
+    DWORD len = GetModuleFileNameA(module, path, MAX_PATH);
+    if (len == 0 || len >= MAX_PATH) {
+        return "";
+    }
+    return string(path, len);
+#else
+    Dl_info info;
+    if (!dladdr((void *)&get_libhalide_path, &info) || !info.dli_fname) {
         return "";
     }
-    return program_name;
+    return info.dli_fname;
 #endif
 }
 
@@ -498,6 +530,77 @@ void write_entire_file(const std::string &pathname, const void *source, size_t s
     f.close();
 }
 
+MappedFile::MappedFile(const std::string &pathname) {
+    // The file is closed before reporting any error past opening it, as
+    // user errors may be thrown.
+#ifdef _WIN32
+    HANDLE file = CreateFileA(pathname.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    user_assert(file != INVALID_HANDLE_VALUE) << "Unable to open file " << pathname << ": error " << GetLastError() << "\n";
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        const DWORD error = GetLastError();
+        CloseHandle(file);
+        user_error << "Unable to stat file " << pathname << ": error " << error << "\n";
+    }
+    length = (size_t)file_size.QuadPart;
+    if (length > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        // The view keeps the mapping alive.
+        contents = mapping ? (uint8_t *)MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : nullptr;
+        const DWORD error = GetLastError();
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        if (!contents) {
+            CloseHandle(file);
+            user_error << "Unable to map file " << pathname << ": error " << error << "\n";
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = open(pathname.c_str(), O_RDONLY);
+    user_assert(fd != -1) << "Unable to open file " << pathname << ": " << strerror(errno) << "\n";
+    struct stat s;
+    if (fstat(fd, &s) != 0) {
+        const int error = errno;
+        close(fd);
+        user_error << "Unable to stat file " << pathname << ": " << strerror(error) << "\n";
+    }
+    length = (size_t)s.st_size;
+    if (length > 0) {
+        void *ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) {
+            const int error = errno;
+            close(fd);
+            user_error << "Unable to map file " << pathname << ": " << strerror(error) << "\n";
+        }
+        contents = (uint8_t *)ptr;
+    }
+    close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+    if (contents) {
+#ifdef _WIN32
+        UnmapViewOfFile(contents);
+#else
+        munmap(contents, length);
+#endif
+    }
+}
+
+std::string resolve_relative_path(const std::string &base_pathname, const std::string &path) {
+    const bool is_absolute = (!path.empty() && (path[0] == '/' || path[0] == '\\')) ||
+                             (path.size() > 1 && path[1] == ':');
+    const size_t slash = base_pathname.find_last_of("/\\");
+    if (is_absolute || slash == std::string::npos) {
+        return path;
+    }
+    return base_pathname.substr(0, slash + 1) + path;
+}
+
 bool add_would_overflow(int bits, int64_t a, int64_t b) {
     int64_t max_val = 0x7fffffffffffffffLL >> (64 - bits);
     int64_t min_val = -max_val - 1;
@@ -149,6 +149,16 @@ std::string get_env_variable(char const *env_var_name);
  * If program name cannot be retrieved, function returns an empty string. */
 std::string running_program_name();
 
+/** Get the full path of the currently running executable.
+ * Platform-specific. If it cannot be retrieved, returns an empty
+ * string. */
+std::string get_executable_path();
+
+/** Get the path of the shared library or executable that contains
+ * libHalide's own code. Platform-specific. If it cannot be retrieved,
+ * returns an empty string. */
+std::string get_libhalide_path();
+
 /** Generate a unique name starting with the given prefix. It's unique
  * relative to all other strings returned by unique_name in this
  * process.
@@ -360,6 +370,38 @@ public:
     TemporaryFile &operator=(TemporaryFile &&) = delete;
 };
 
+/** A simple utility class that memory-maps a file in its ctor and unmaps
+ * it in its dtor. The mapping is private: its contents can be written to
+ * without modifying the file, and each page is only copied the first time
+ * it's written to. A file that can't be opened or mapped is a user error,
+ * which names the file and the reason. */
+class MappedFile final {
+public:
+    explicit MappedFile(const std::string &pathname);
+    ~MappedFile();
+
+    uint8_t *data() const {
+        return contents;
+    }
+    size_t size() const {
+        return length;
+    }
+
+private:
+    uint8_t *contents = nullptr;
+    size_t length = 0;
+
+public:
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&) = delete;
+    MappedFile &operator=(MappedFile &&) = delete;
+};
+
+/** Interpret path relative to the directory containing the file
+ * base_pathname. Absolute paths are returned unchanged. */
+std::string resolve_relative_path(const std::string &base_pathname, const std::string &path);
+
 /** Routines to test if math would overflow for signed integers with
  * the given number of bits. */
 // @{
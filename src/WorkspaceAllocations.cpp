@@ -0,0 +1,74 @@
+#include "WorkspaceAllocations.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "PackHeapAllocations.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+namespace {
+
+class InjectWorkspaceAllocations : public IRMutator {
+    using IRMutator::visit;
+
+    const std::string &pipeline_name;
+    int next_site = 0;
+
+    // Allocations that may be live more than once at the same time
+    // can't be given the same block on every call.
+    bool in_parallel = false;
+
+    Stmt visit(const For *op) override {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            return op;
+        }
+        ScopedValue<bool> old_in_parallel(in_parallel, in_parallel || op->is_parallel());
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const Fork *op) override {
+        ScopedValue<bool> old_in_parallel(in_parallel, true);
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const Allocate *op) override {
+        if (in_parallel || !is_heap_allocation(op)) {
+            return IRMutator::visit(op);
+        }
+
+        int site = next_site++;
+        Stmt body = mutate(op->body);
+
+        Expr size = make_const(UInt(64), op->padding);
+        Expr elems = cast<uint64_t>(max(op->extents[0], 0));
+        for (size_t i = 1; i < op->extents.size(); i++) {
+            elems *= cast<uint64_t>(max(op->extents[i], 0));
+        }
+        size = (elems + size) * (op->type.lanes() * op->type.bytes());
+        if (!is_const_one(op->condition)) {
+            size = select(op->condition, size, make_zero(UInt(64)));
+        }
+
+        Expr new_expr = Call::make(Handle(), "halide_workspace_malloc",
+                                   {pipeline_name, site, size}, Call::Extern);
+        return Allocate::make(op->name, op->type, op->memory_type,
+                              op->extents, op->condition, body,
+                              new_expr, "halide_workspace_free", op->padding);
+    }
+
+public:
+    InjectWorkspaceAllocations(const std::string &pipeline_name)
+        : pipeline_name(pipeline_name) {
+    }
+};
+
+}  // namespace
+
+Stmt inject_workspace_allocations(const Stmt &s, const std::string &pipeline_name) {
+    return InjectWorkspaceAllocations(pipeline_name).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
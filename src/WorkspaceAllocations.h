@@ -0,0 +1,26 @@
+#ifndef HALIDE_WORKSPACE_ALLOCATIONS_H
+#define HALIDE_WORKSPACE_ALLOCATIONS_H
+
+/** \file
+ * Defines the lowering pass that takes heap allocations from a
+ * persistent workspace.
+ */
+
+#include <string>
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Rewrite the heap allocations made outside of parallel loops to get
+ * their memory from the workspace created for the pipeline and
+ * user_context, if any (see halide_workspace_create). Each such
+ * allocation is assigned a distinct site number, which the runtime
+ * uses to give it the same block of memory on every call. */
+Stmt inject_workspace_allocations(const Stmt &s, const std::string &pipeline_name);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -12,6 +12,11 @@ namespace {
 struct GradientAutoschedulerParams {
     /** Maximum level of parallelism available. */
     int parallelism = 16;
+
+    /** Maximum number of bytes of intermediate Funcs to store. Funcs that
+     * don't fit are recomputed inline by their consumers. Negative
+     * means no limit. */
+    int64_t memory_budget = -1;
 };
 
 std::map<std::string, Box> inference_bounds(const std::vector<Function> &functions,
@@ -906,11 +911,37 @@ void generate_schedule(const std::vector<Function> &outputs,
         output_set.insert(output.name());
     }
 
+    // Choose the Funcs to store within the memory budget. The rest are
+    // recomputed inline.
+    std::set<std::string> stored;
+    if (params.memory_budget >= 0) {
+        std::vector<Func> funcs;
+        std::map<std::string, int64_t> func_bytes;
+        for (const auto &func_name : order) {
+            Func func(env[func_name]);
+            funcs.push_back(func);
+            int64_t bytes = 0;
+            for (const Type &t : func.types()) {
+                bytes += t.bytes();
+            }
+            for (int extent : get_int_bounds(func_bounds[func_name])) {
+                bytes *= extent;
+            }
+            func_bytes[func_name] = bytes;
+        }
+        stored = choose_checkpoints(funcs, output_set, func_bytes, params.memory_budget);
+    }
+
     std::ostringstream schedule_source;
     // Traverse from the consumers to the producers
     for (const auto &func_name : reverse_view(order)) {
         Func func(env[func_name]);
         debug(1) << "[gradient_autoscheduler] Processing function:" << func_name << "\n";
+        if (params.memory_budget >= 0 && !stored.count(func_name)) {
+            func.compute_inline();
+            schedule_source << func.name() << ".compute_inline()\n";
+            continue;
+        }
         // Get the bounds in integer constant by substitute all the parameters' estimates.
         Box bounds = func_bounds[func_name];
         std::vector<int> int_bounds = get_int_bounds(bounds);
@@ -939,6 +970,7 @@ struct Li2018 {
         {
             ParamParser parser(params_in.extra);
             parser.parse("parallelism", &params.parallelism);
+            parser.parse("memory_budget", &params.memory_budget);
             parser.finish();
         }
         generate_schedule(outputs, target, params, results);
@@ -227,6 +227,7 @@ function initToolbar() {
     }
     make_toggler(document.getElementsByName("checkbox-show-ir-line-nums")[0], "data-show-line-nums", false);
     make_toggler(document.getElementsByName("checkbox-show-ir-costs")[0], "data-hide-cost", true);
+    make_toggler(document.getElementsByName("checkbox-show-ir-profile")[0], "data-hide-profile", true);
     make_toggler(document.getElementsByName("checkbox-show-ir-wrap")[0], "data-wrap", false);
 
     /* Hiding panes */
@@ -238,6 +238,17 @@ extern void halide_shutdown_thread_pool(void);
 typedef int (*halide_do_par_for_t)(void *, halide_task_t, int, int, uint8_t *);
 extern halide_do_par_for_t halide_set_custom_do_par_for(halide_do_par_for_t do_par_for);
 
+/** Call an argv-style pipeline entry point (e.g. the foo_argv function
+ * generated for a pipeline called foo) once for each of batch_size
+ * argument arrays, distributing the calls across the thread pool as a
+ * single halide_do_par_for. A failing call does not stop the others. If
+ * exit_statuses is non-null, it must have room for batch_size entries and
+ * receives the result of each call. Returns zero if every call succeeded,
+ * or the result of the first failing call (in batch order) otherwise. This
+ * is what the generated foo_batch functions call. */
+extern int halide_do_argv_batch(void *user_context, int (*argv_func)(void **),
+                                int batch_size, void ***argvs, int *exit_statuses);
+
 /** An opaque struct representing a semaphore. Used by the task system for async tasks. */
 struct halide_semaphore_t {
     uint64_t _private[2];
@@ -1026,6 +1037,46 @@ extern void halide_memoization_cache_release(void *user_context, void *host);
  */
 extern void halide_memoization_cache_cleanup(void);
 
+/** An opaque handle to heap memory that persists across calls to a
+ * pipeline compiled with Target::Workspace. */
+struct halide_workspace_t;
+
+/** Create a workspace for the named pipeline. Calls to that pipeline
+ * made with the same user_context will then take the memory for heap
+ * allocations made outside of parallel loops from the workspace,
+ * rather than from halide_malloc. Each allocation site keeps the
+ * largest block it has been given, so repeated calls with equal or
+ * smaller sizes do not allocate at all. If initial_bytes is non-zero,
+ * a single block of that size is allocated up front and carved up
+ * between the allocation sites as they are first used; passing the
+ * high water mark of an earlier run avoids allocation entirely.
+ *
+ * A workspace is not thread-safe: only one call using it may be in
+ * flight at once. Use a distinct user_context per thread to give each
+ * thread its own workspace. Returns nullptr on failure. */
+extern struct halide_workspace_t *halide_workspace_create(void *user_context, const char *pipeline_name,
+                                                          uint64_t initial_bytes);
+
+/** Free all memory held by a workspace. Must not be called while a
+ * call using it is in flight. */
+extern void halide_workspace_destroy(void *user_context, struct halide_workspace_t *workspace);
+
+/** The number of bytes a workspace created with this as its
+ * initial_bytes needs to serve the same sequence of allocations without
+ * calling halide_malloc. This counts the space left behind when an
+ * allocation site outgrows its block, so it can be more than the
+ * workspace ever held at once. */
+extern uint64_t halide_workspace_high_water_mark(const struct halide_workspace_t *workspace);
+
+/** Called by pipelines compiled with Target::Workspace to allocate and
+ * free heap memory. The site identifies the allocation within the
+ * pipeline. Falls back to halide_malloc and halide_free when there is
+ * no workspace for the pipeline and user_context. */
+// @{
+extern void *halide_workspace_malloc(void *user_context, const char *pipeline_name, int32_t site, uint64_t size);
+extern void halide_workspace_free(void *user_context, void *ptr);
+// @}
+
 /** Verify that a given range of memory has been initialized; only used when Target::MSAN is enabled.
  *
  * The default implementation simply calls the LLVM-provided __msan_check_mem_is_initialized() function.
@@ -1465,6 +1516,13 @@ typedef enum halide_target_feature_t {
     halide_target_feature_semihosting,            ///< Used together with Target::NoOS for the baremetal target built with semihosting library and run with semihosting mode where minimum I/O communication with a host PC is available.
     halide_target_feature_avx10_1,                ///< Intel AVX10 version 1 support. vector_bits is used to indicate width.
     halide_target_feature_x86_apx,                ///< Intel x86 APX support. Covers initial set of features released as APX: egpr,push2pop2,ppx,ndd .
+    halide_target_feature_arena_allocations,      ///< Pack the heap allocations made at each loop level into a single arena.
+    halide_target_feature_workspace,              ///< Take heap allocations made outside of parallel loops from a persistent workspace, if one was created for the pipeline. See halide_workspace_create.
+    halide_target_feature_lazy_jit,               ///< When JIT compiling, compile each function of the pipeline (e.g. each parallel loop body, or each side of a specialization) to machine code the first time it is called, rather than all up front.
+    halide_target_feature_aligned_fast_path,      ///< Add a second copy of the pipeline that assumes dense, vector-aligned buffer arguments, and select it at runtime when they are.
+    halide_target_feature_widen_float16_math,     ///< Compute each chain of emulated (b)float16 arithmetic in float32, rounding to 16 bits once at the end instead of after every operation.
+    halide_target_feature_profile_timeline,       ///< When used with profile or profile_by_timer, also record when each thread begins and ends each Func's producer and each thread pool task. See halide_profiler_write_timeline.
+    halide_target_feature_profile_memory_traffic, ///< When used with profile or profile_by_timer, also count the bytes loaded and stored by each Func.
     halide_target_feature_end                     ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
 
@@ -1862,6 +1920,11 @@ struct HALIDE_ATTRIBUTE_ALIGN(8) halide_profiler_func_stats {
 
     /** The total number of memory allocation of this Func. */
     int num_allocs;
+
+    /** The total number of bytes loaded and stored by this Func. Only
+     * counted for pipelines compiled with profile_memory_traffic. These
+     * come last so that the fields above keep their offsets. */
+    uint64_t bytes_loaded, bytes_stored;
 };
 
 /** Per-pipeline state tracked by the sampling profiler. These exist
@@ -2028,6 +2091,28 @@ extern void halide_profiler_shutdown(void);
  * reset. Also happens at process exit. */
 extern void halide_profiler_report(void *user_context);
 
+/** Write the statistics for everything run since the last reset to a
+ * text file, in a form that can be read back by the compiler to guide
+ * later compilations of the same pipelines (see HL_PGO_PROFILE). Also
+ * happens at process exit if the environment variable
+ * HL_PROFILER_OUTPUT names a file. */
+extern int halide_profiler_write_profile(void *user_context, const char *filename);
+
+/** Write the events recorded by pipelines compiled with the
+ * profile_timeline target feature since the last reset to a file, as
+ * JSON in the Chrome trace event format (viewable in Perfetto or
+ * chrome://tracing). Each thread keeps only its most recent 65536
+ * events. Also happens at process exit if the environment variable
+ * HL_PROFILER_TIMELINE names a file. Do not call this while a
+ * pipeline is running.
+ *
+ * To record thread pool tasks, the first such pipeline to run wraps the
+ * handlers set with halide_set_custom_do_task and
+ * halide_set_custom_do_loop_task. halide_profiler_reset puts them back
+ * and frees the recorded events. A handler set in between replaces the
+ * wrapper, so tasks aren't recorded until after the next reset. */
+extern int halide_profiler_write_timeline(void *user_context, const char *filename);
+
 /** These routines are called to temporarily disable and then reenable
  * the profiler. */
 //@{
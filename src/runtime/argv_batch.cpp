@@ -0,0 +1,47 @@
+#include "HalideRuntime.h"
+#include "runtime_internal.h"
+
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+struct argv_batch_closure {
+    int (*argv_func)(void **);
+    void ***argvs;
+    int *exit_statuses;
+};
+
+WEAK int argv_batch_task(void *user_context, int idx, uint8_t *closure) {
+    argv_batch_closure *c = (argv_batch_closure *)closure;
+    int result = c->argv_func(c->argvs[idx]);
+    if (c->exit_statuses) {
+        c->exit_statuses[idx] = result;
+        // Keep going so that one failure doesn't cancel the rest of the batch.
+        return halide_error_code_success;
+    }
+    return result;
+}
+
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
+extern "C" {
+
+WEAK int halide_do_argv_batch(void *user_context, int (*argv_func)(void **),
+                              int batch_size, void ***argvs, int *exit_statuses) {
+    Halide::Runtime::Internal::argv_batch_closure closure = {argv_func, argvs, exit_statuses};
+    auto result = halide_do_par_for(user_context, Halide::Runtime::Internal::argv_batch_task,
+                                    0, batch_size, (uint8_t *)&closure);
+    if (result != halide_error_code_success || exit_statuses == nullptr) {
+        return result;
+    }
+    for (int i = 0; i < batch_size; i++) {
+        if (exit_statuses[i] != halide_error_code_success) {
+            return exit_statuses[i];
+        }
+    }
+    return halide_error_code_success;
+}
+
+}  // extern "C"
@@ -23,6 +23,20 @@ WEAK halide_profiler_state *halide_profiler_get_state() {
     return &s;
 }
 
+#ifdef WINDOWS
+#ifdef BITS_64
+#define WIN32API
+#else
+#define WIN32API __stdcall
+#endif
+extern "C" WIN32API uint32_t GetCurrentThreadId();
+#else
+// pthread_t is an unsigned long on Linux and a pointer on macOS. Both are
+// pointer-sized and returned the same way, so we only need an integer the
+// size of a pointer to tell threads apart.
+extern "C" uintptr_t pthread_self();
+#endif
+
 #if TIMER_PROFILING
 extern "C" void halide_start_timer_chain();
 extern "C" void halide_disable_timer_interrupt();
@@ -105,6 +119,8 @@ WEAK halide_profiler_pipeline_stats *find_or_create_pipeline(const char *pipelin
         p->funcs[i].memory_total = 0;
         p->funcs[i].num_allocs = 0;
         p->funcs[i].stack_peak = 0;
+        p->funcs[i].bytes_loaded = 0;
+        p->funcs[i].bytes_stored = 0;
         p->funcs[i].active_threads_numerator = 0;
         p->funcs[i].active_threads_denominator = 0;
     }
@@ -174,6 +190,156 @@ WEAK void sampling_profiler_thread(void *) {
     halide_mutex_unlock(&s->lock);
 }
 
+// In timeline mode (the profile_timeline target feature) we also record
+// when each thread begins and ends each Func's producer and each thread
+// pool task, so that a trace viewer can show idle workers, stragglers,
+// and async producers overlapping their consumers. Each thread gets its
+// own ring buffer, so recording an event takes no locks. Once a buffer
+// is full its oldest events are overwritten.
+struct TimelineEvent {
+    uint64_t time;
+    // The pipeline the Func belongs to, or nullptr for a thread pool task.
+    halide_profiler_pipeline_stats *pipeline;
+    // The Func id, or the first loop iteration of a thread pool task.
+    int32_t id;
+    // The number of loop iterations of a thread pool task.
+    int32_t extent;
+    int32_t begin;
+    int32_t padding;
+};
+
+constexpr int timeline_max_threads = 256;
+constexpr uint32_t timeline_buffer_size = 1 << 16;
+
+struct TimelineBuffer {
+    // The thread that owns this buffer, or zero if it is unclaimed.
+    uintptr_t thread;
+    // The total number of events recorded, including overwritten ones.
+    uint32_t count;
+    TimelineEvent *events;
+};
+
+WEAK TimelineBuffer timeline_buffers[timeline_max_threads];
+WEAK halide_do_task_t timeline_next_do_task = nullptr;
+WEAK halide_do_loop_task_t timeline_next_do_loop_task = nullptr;
+
+WEAK uintptr_t timeline_current_thread() {
+#ifdef WINDOWS
+    return (uintptr_t)GetCurrentThreadId() + 1;
+#else
+    return pthread_self();
+#endif
+}
+
+WEAK TimelineBuffer *timeline_buffer_for_current_thread() {
+    using namespace Halide::Runtime::Internal::Synchronization;
+
+    uintptr_t self = timeline_current_thread();
+    uintptr_t start = (self ^ (self >> 12)) % timeline_max_threads;
+    for (int i = 0; i < timeline_max_threads; i++) {
+        TimelineBuffer *b = timeline_buffers + (start + i) % timeline_max_threads;
+        uintptr_t owner;
+        atomic_load_acquire(&(b->thread), &owner);
+        if (owner == self) {
+            return b;
+        } else if (owner == 0) {
+            uintptr_t expected = 0;
+            if (atomic_cas_strong_sequentially_consistent(&(b->thread), &expected, &self)) {
+                // Only the owning thread touches the events until they're written out.
+                b->events = (TimelineEvent *)malloc(timeline_buffer_size * sizeof(TimelineEvent));
+                return b;
+            }
+        }
+    }
+    // There are too many threads. Drop the event.
+    return nullptr;
+}
+
+WEAK void timeline_record(halide_profiler_pipeline_stats *pipeline, int id, int extent, int begin) {
+    TimelineBuffer *b = timeline_buffer_for_current_thread();
+    if (!b || !b->events) {
+        return;
+    }
+    TimelineEvent *e = b->events + (b->count & (timeline_buffer_size - 1));
+    e->time = halide_current_time_ns(nullptr);
+    e->pipeline = pipeline;
+    e->id = id;
+    e->extent = extent;
+    e->begin = begin;
+    b->count++;
+}
+
+WEAK int timeline_do_task(void *user_context, halide_task_t f, int idx, uint8_t *closure) {
+    timeline_record(nullptr, idx, 1, 1);
+    int result = timeline_next_do_task(user_context, f, idx, closure);
+    timeline_record(nullptr, idx, 1, 0);
+    return result;
+}
+
+WEAK int timeline_do_loop_task(void *user_context, halide_loop_task_t f, int min, int extent,
+                               uint8_t *closure, void *task_parent) {
+    timeline_record(nullptr, min, extent, 1);
+    int result = timeline_next_do_loop_task(user_context, f, min, extent, closure, task_parent);
+    timeline_record(nullptr, min, extent, 0);
+    return result;
+}
+
+// Put back the do_task and do_loop_task handlers that enabling the
+// timeline wrapped. If something else has replaced ours since, leave it
+// in place.
+WEAK void timeline_restore_handlers() {
+    if (timeline_next_do_task) {
+        halide_do_task_t current = halide_set_custom_do_task(timeline_next_do_task);
+        if (current != timeline_do_task) {
+            halide_set_custom_do_task(current);
+        }
+        timeline_next_do_task = nullptr;
+    }
+    if (timeline_next_do_loop_task) {
+        halide_do_loop_task_t current = halide_set_custom_do_loop_task(timeline_next_do_loop_task);
+        if (current != timeline_do_loop_task) {
+            halide_set_custom_do_loop_task(current);
+        }
+        timeline_next_do_loop_task = nullptr;
+    }
+}
+
+// Free the event buffers. Threads claim one again the next time they
+// record an event.
+WEAK void timeline_free_buffers() {
+    using namespace Halide::Runtime::Internal::Synchronization;
+
+    for (int i = 0; i < timeline_max_threads; i++) {
+        TimelineBuffer *b = timeline_buffers + i;
+        free(b->events);
+        b->events = nullptr;
+        b->count = 0;
+        uintptr_t unclaimed = 0;
+        atomic_store_release(&(b->thread), &unclaimed);
+    }
+}
+
+WEAK void timeline_reset() {
+    timeline_restore_handlers();
+    timeline_free_buffers();
+}
+
+// Print a string as a JSON string literal.
+template<typename Printer>
+void print_json_string(Printer &p, const char *str) {
+    char c[3] = {'\\', 0, 0};
+    p << "\"";
+    for (; *str; str++) {
+        c[1] = *str;
+        if (*str == '"' || *str == '\\') {
+            p << c;
+        } else {
+            p << c + 1;
+        }
+    }
+    p << "\"";
+}
+
 }  // namespace Internal
 }  // namespace Runtime
 }  // namespace Halide
@@ -327,6 +493,8 @@ WEAK int halide_profiler_instance_end(void *user_context, halide_profiler_instan
             func->stack_peak = max(func->stack_peak, instance_func->stack_peak);
             func->memory_peak = max(func->memory_peak, instance_func->memory_peak);
             func->memory_total += instance_func->memory_total;
+            func->bytes_loaded += instance_func->bytes_loaded;
+            func->bytes_stored += instance_func->bytes_stored;
         }
     }
 
@@ -393,6 +561,21 @@ WEAK void halide_profiler_memory_allocate(void *user_context,
     sync_compare_max_and_swap(&func->memory_peak, f_mem_current);
 }
 
+// Called at the end of each producer and parallel task in a pipeline
+// compiled with profile_memory_traffic.
+WEAK int halide_profiler_memory_traffic(void *user_context,
+                                        halide_profiler_instance_state *instance,
+                                        int func_id,
+                                        uint64_t loaded,
+                                        uint64_t stored) {
+    using namespace Halide::Runtime::Internal::Synchronization;
+
+    halide_profiler_func_stats *func = &instance->funcs[func_id];
+    atomic_add_fetch_sequentially_consistent(&func->bytes_loaded, loaded);
+    atomic_add_fetch_sequentially_consistent(&func->bytes_stored, stored);
+    return 0;
+}
+
 WEAK void halide_profiler_memory_free(void *user_context,
                                       halide_profiler_instance_state *instance,
                                       int func_id,
@@ -631,6 +814,17 @@ WEAK void halide_profiler_report_unlocked(void *user_context, halide_profiler_st
                 if (fs->stack_peak > 0) {
                     sstr << " stack: " << fs->stack_peak;
                 }
+                if (fs->bytes_loaded || fs->bytes_stored) {
+                    sstr << " loaded: " << fs->bytes_loaded / p->runs
+                         << " stored: " << fs->bytes_stored / p->runs;
+                    if (fs->time) {
+                        // Bytes per nanosecond is GB/s
+                        float bandwidth = (float)(fs->bytes_loaded + fs->bytes_stored) / fs->time;
+                        sstr << " (" << bandwidth;
+                        sstr.erase(4);
+                        sstr << " GB/s)";
+                    }
+                }
                 sstr << "\n";
 
                 halide_print(user_context, sstr.str());
@@ -694,6 +888,147 @@ WEAK void halide_profiler_report_unlocked(void *user_context, halide_profiler_st
     }
 }
 
+WEAK int halide_profiler_write_profile_unlocked(void *user_context, halide_profiler_state *s, const char *filename) {
+    void *f = halide_fopen(filename, "w");
+    if (!f) {
+        error(user_context) << "Could not open profile file " << filename << "\n";
+        return halide_error_code_generic_error;
+    }
+
+    // One line per pipeline followed by one line per Func. The names
+    // go last, because Func names may contain spaces.
+    bool ok = true;
+    StringStreamPrinter<1024> sstr(user_context);
+    for (halide_profiler_pipeline_stats *p = s->pipelines; p && ok;
+         p = (halide_profiler_pipeline_stats *)(p->next)) {
+        if (!p->runs) {
+            continue;
+        }
+        sstr.clear();
+        sstr << "pipeline " << p->runs << " " << p->samples << " " << p->time
+             << " " << p->name << "\n";
+        ok = fwrite(sstr.str(), sstr.size(), 1, f) > 0;
+        for (int i = 0; i < p->num_funcs && ok; i++) {
+            halide_profiler_func_stats *fs = p->funcs + i;
+            sstr.clear();
+            sstr << "func " << fs->time << " " << fs->num_allocs << " "
+                 << fs->memory_peak << " " << fs->stack_peak << " " << fs->name << "\n";
+            ok = fwrite(sstr.str(), sstr.size(), 1, f) > 0;
+        }
+    }
+    fclose(f);
+
+    if (!ok) {
+        error(user_context) << "Could not write profile file " << filename << "\n";
+        return halide_error_code_generic_error;
+    }
+    return halide_error_code_success;
+}
+
+WEAK int halide_profiler_write_profile(void *user_context, const char *filename) {
+    halide_profiler_state *s = halide_profiler_get_state();
+    LockProfiler lock(s);
+    return halide_profiler_write_profile_unlocked(user_context, s, filename);
+}
+
+// Called at the start of a pipeline compiled with profile_timeline. This
+// wraps the do_task and do_loop_task handlers set with
+// halide_set_custom_do_task and halide_set_custom_do_loop_task, until the
+// profiler is next reset. A handler set after this replaces the wrapper,
+// so tasks are no longer recorded until the next reset, and the reset
+// leaves that handler in place.
+WEAK int halide_profiler_timeline_enable(void *user_context) {
+    halide_profiler_state *s = halide_profiler_get_state();
+    LockProfiler lock(s);
+    if (!timeline_next_do_task) {
+        // Wrap whatever the thread pool would otherwise do, so that we
+        // see every task on every thread, including the main one.
+        timeline_next_do_task = halide_set_custom_do_task(timeline_do_task);
+        timeline_next_do_loop_task = halide_set_custom_do_loop_task(timeline_do_loop_task);
+    }
+    return 0;
+}
+
+// Called at the start and end of each Func's producer in a pipeline
+// compiled with profile_timeline.
+WEAK int halide_profiler_timeline_event(void *user_context,
+                                        halide_profiler_instance_state *instance,
+                                        int func_id, int begin) {
+    timeline_record(instance->pipeline_stats, func_id, 0, begin);
+    return 0;
+}
+
+WEAK int halide_profiler_write_timeline_unlocked(void *user_context, halide_profiler_state *s, const char *filename) {
+    void *f = halide_fopen(filename, "w");
+    if (!f) {
+        error(user_context) << "Could not open timeline file " << filename << "\n";
+        return halide_error_code_generic_error;
+    }
+
+    // Time is measured from the earliest event still in any buffer.
+    uint64_t start_time = 0;
+    for (int i = 0; i < timeline_max_threads; i++) {
+        TimelineBuffer *b = timeline_buffers + i;
+        if (b->count && b->events) {
+            uint32_t first = b->count > timeline_buffer_size ? b->count - timeline_buffer_size : 0;
+            uint64_t t = b->events[first & (timeline_buffer_size - 1)].time;
+            if (start_time == 0 || t < start_time) {
+                start_time = t;
+            }
+        }
+    }
+
+    // One Chrome trace event per line. Threads are numbered by the
+    // buffer they recorded into.
+    bool ok = fwrite("{\"traceEvents\":[\n", 17, 1, f) > 0;
+    bool first_event = true;
+    StringStreamPrinter<1024> sstr(user_context);
+    for (int i = 0; i < timeline_max_threads && ok; i++) {
+        TimelineBuffer *b = timeline_buffers + i;
+        if (!b->count || !b->events) {
+            continue;
+        }
+        uint32_t first = b->count > timeline_buffer_size ? b->count - timeline_buffer_size : 0;
+        for (uint32_t j = first; j < b->count && ok; j++) {
+            const TimelineEvent &e = b->events[j & (timeline_buffer_size - 1)];
+            uint64_t ns = e.time - start_time;
+            uint64_t frac = ns % 1000;
+            sstr.clear();
+            sstr << (first_event ? "" : ",\n") << "{\"name\":";
+            if (e.pipeline) {
+                print_json_string(sstr, e.pipeline->funcs[e.id].name);
+                sstr << ",\"cat\":";
+                print_json_string(sstr, e.pipeline->name);
+            } else {
+                sstr << "\"task\",\"cat\":\"thread_pool\"";
+            }
+            sstr << ",\"ph\":\"" << (e.begin ? "B" : "E")
+                 << "\",\"ts\":" << ns / 1000 << "." << (frac < 100 ? "0" : "") << (frac < 10 ? "0" : "") << frac
+                 << ",\"pid\":0,\"tid\":" << i;
+            if (!e.pipeline && e.begin) {
+                sstr << ",\"args\":{\"min\":" << e.id << ",\"extent\":" << e.extent << "}";
+            }
+            sstr << "}";
+            ok = fwrite(sstr.str(), sstr.size(), 1, f) > 0;
+            first_event = false;
+        }
+    }
+    ok = ok && fwrite("\n]}\n", 4, 1, f) > 0;
+    fclose(f);
+
+    if (!ok) {
+        error(user_context) << "Could not write timeline file " << filename << "\n";
+        return halide_error_code_generic_error;
+    }
+    return halide_error_code_success;
+}
+
+WEAK int halide_profiler_write_timeline(void *user_context, const char *filename) {
+    halide_profiler_state *s = halide_profiler_get_state();
+    LockProfiler lock(s);
+    return halide_profiler_write_timeline_unlocked(user_context, s, filename);
+}
+
 WEAK void halide_profiler_report(void *user_context) {
     halide_profiler_state *s = halide_profiler_get_state();
     LockProfiler lock(s);
@@ -701,6 +1036,8 @@ WEAK void halide_profiler_report(void *user_context) {
 }
 
 WEAK void halide_profiler_reset_unlocked(halide_profiler_state *s) {
+    // Timeline events refer to the pipeline stats freed below.
+    timeline_reset();
     while (s->pipelines) {
         halide_profiler_pipeline_stats *p = s->pipelines;
         s->pipelines = (halide_profiler_pipeline_stats *)(p->next);
@@ -756,6 +1093,16 @@ halide_profiler_shutdown() {
     // down the thread.
     halide_profiler_report_unlocked(nullptr, s);
 
+    const char *profile_file = getenv("HL_PROFILER_OUTPUT");
+    if (profile_file) {
+        (void)halide_profiler_write_profile_unlocked(nullptr, s, profile_file);
+    }
+
+    const char *timeline_file = getenv("HL_PROFILER_TIMELINE");
+    if (timeline_file) {
+        (void)halide_profiler_write_timeline_unlocked(nullptr, s, timeline_file);
+    }
+
     halide_profiler_reset_unlocked(s);
 }
 
@@ -777,6 +1124,19 @@ WEAK void halide_windows_profiler_shutdown() {
     // Print results. Avoid locking as it will cause problems and
     // nothing should be running.
     halide_profiler_report_unlocked(nullptr, s);
+
+    const char *profile_file = getenv("HL_PROFILER_OUTPUT");
+    if (profile_file) {
+        (void)halide_profiler_write_profile_unlocked(nullptr, s, profile_file);
+    }
+
+    const char *timeline_file = getenv("HL_PROFILER_TIMELINE");
+    if (timeline_file) {
+        (void)halide_profiler_write_timeline_unlocked(nullptr, s, timeline_file);
+    }
+
+    // Freeing memory is still safe here.
+    timeline_free_buffers();
 }
 #endif
 }  // namespace
@@ -51,6 +51,7 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_device_sync,
     (void *)&halide_device_sync_global,
     (void *)&halide_disable_timer_interrupt,
+    (void *)&halide_do_argv_batch,
     (void *)&halide_do_par_for,
     (void *)&halide_do_parallel_tasks,
     (void *)&halide_do_task,
@@ -170,9 +171,14 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_profiler_instance_end,
     (void *)&halide_profiler_memory_allocate,
     (void *)&halide_profiler_memory_free,
+    (void *)&halide_profiler_memory_traffic,
     (void *)&halide_profiler_report,
     (void *)&halide_profiler_reset,
     (void *)&halide_profiler_stack_peak_update,
+    (void *)&halide_profiler_timeline_enable,
+    (void *)&halide_profiler_timeline_event,
+    (void *)&halide_profiler_write_profile,
+    (void *)&halide_profiler_write_timeline,
     (void *)&halide_qurt_hvx_lock,
     (void *)&halide_qurt_hvx_unlock,
     (void *)&halide_qurt_hvx_unlock_as_destructor,
@@ -221,5 +227,10 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_webgpu_initialize_kernels,
     (void *)&halide_webgpu_finalize_kernels,
     (void *)&halide_webgpu_run,
+    (void *)&halide_workspace_create,
+    (void *)&halide_workspace_destroy,
+    (void *)&halide_workspace_free,
+    (void *)&halide_workspace_high_water_mark,
+    (void *)&halide_workspace_malloc,
     (void *)&halide_unused_force_include_types,
 };
@@ -166,6 +166,11 @@ WEAK void halide_profiler_memory_allocate(void *user_context,
                                           halide_profiler_instance_state *instance,
                                           int func_id,
                                           uint64_t incr);
+WEAK int halide_profiler_memory_traffic(void *user_context,
+                                        halide_profiler_instance_state *instance,
+                                        int func_id,
+                                        uint64_t loaded,
+                                        uint64_t stored);
 WEAK void halide_profiler_memory_free(void *user_context,
                                       halide_profiler_instance_state *instance,
                                       int func_id,
@@ -177,6 +182,10 @@ WEAK int halide_profiler_instance_start(void *user_context,
                                         halide_profiler_instance_state *instance);
 WEAK int halide_profiler_instance_end(void *user_context,
                                       halide_profiler_instance_state *instance);
+WEAK int halide_profiler_timeline_enable(void *user_context);
+WEAK int halide_profiler_timeline_event(void *user_context,
+                                        halide_profiler_instance_state *instance,
+                                        int func_id, int begin);
 
 WEAK void halide_start_timer_chain();
 WEAK void halide_disable_timer_interrupt();
@@ -0,0 +1,258 @@
+#include "HalideRuntime.h"
+#include "runtime_internal.h"
+#include "scoped_mutex_lock.h"
+
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+struct WorkspaceBlock {
+    void *ptr;
+    size_t size;
+    // Where the block sits in the workspace's layout: the block's place
+    // in the initial slab, if the slab is big enough to hold it.
+    uint64_t offset;
+    bool in_use;
+    // True if ptr came from halide_malloc, false if it was carved out
+    // of the workspace's initial slab.
+    bool owned;
+};
+
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
+struct halide_workspace_t {
+    void *user_context;
+    char *pipeline_name;
+    Halide::Runtime::Internal::WorkspaceBlock *blocks;
+    int32_t num_blocks;
+    uint64_t blocks_offset;
+    bool blocks_owned;
+    uint8_t *slab;
+    size_t slab_size;
+    // The end of the layout of all the blocks handed out so far. This is
+    // the slab size needed to hold all of them, i.e. the high water mark.
+    uint64_t layout_end;
+    halide_workspace_t *next;
+};
+
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+WEAK halide_mutex workspaces_lock;
+WEAK halide_workspace_t *workspaces = nullptr;
+
+WEAK halide_workspace_t *find_workspace(void *user_context, const char *pipeline_name) {
+    for (halide_workspace_t *w = workspaces; w; w = w->next) {
+        if (w->user_context == user_context &&
+            strcmp(w->pipeline_name, pipeline_name) == 0) {
+            return w;
+        }
+    }
+    return nullptr;
+}
+
+WEAK size_t workspace_round_up(size_t size) {
+    const size_t alignment = ::halide_internal_malloc_alignment();
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+// Make room for num_blocks allocation sites. The array of blocks is
+// laid out along with the blocks themselves (see
+// halide_workspace_malloc), so a pre-sized workspace doesn't have to
+// allocate it either.
+WEAK bool workspace_grow(void *user_context, halide_workspace_t *w, int32_t num_blocks) {
+    const size_t old_size = workspace_round_up(w->num_blocks * sizeof(WorkspaceBlock));
+    const size_t size = workspace_round_up(num_blocks * sizeof(WorkspaceBlock));
+    uint64_t offset = w->layout_end;
+    if (w->blocks && w->blocks_offset + old_size == w->layout_end) {
+        offset = w->blocks_offset;
+    }
+    WorkspaceBlock *blocks;
+    bool owned = false;
+    if (offset + size <= w->slab_size) {
+        blocks = (WorkspaceBlock *)(w->slab + offset);
+    } else {
+        blocks = (WorkspaceBlock *)halide_malloc(user_context, size);
+        if (!blocks) {
+            return false;
+        }
+        owned = true;
+    }
+    if (blocks != w->blocks) {
+        if (w->blocks) {
+            memcpy(blocks, w->blocks, w->num_blocks * sizeof(WorkspaceBlock));
+        }
+        if (w->blocks_owned) {
+            halide_free(user_context, w->blocks);
+        }
+    }
+    memset(blocks + w->num_blocks, 0, (num_blocks - w->num_blocks) * sizeof(WorkspaceBlock));
+    w->blocks = blocks;
+    w->num_blocks = num_blocks;
+    w->blocks_offset = offset;
+    w->blocks_owned = owned;
+    w->layout_end = offset + size;
+    return true;
+}
+
+WEAK void workspace_release_block(void *user_context, halide_workspace_t *w, WorkspaceBlock *b) {
+    if (b->owned) {
+        halide_free(user_context, b->ptr);
+    }
+    b->ptr = nullptr;
+    b->size = 0;
+    b->owned = false;
+}
+
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
+extern "C" {
+
+WEAK halide_workspace_t *halide_workspace_create(void *user_context, const char *pipeline_name,
+                                                 uint64_t initial_bytes) {
+    halide_workspace_t *w = (halide_workspace_t *)halide_malloc(user_context, sizeof(halide_workspace_t));
+    if (!w) {
+        return nullptr;
+    }
+    memset(w, 0, sizeof(halide_workspace_t));
+    w->user_context = user_context;
+
+    size_t name_size = strlen(pipeline_name) + 1;
+    w->pipeline_name = (char *)halide_malloc(user_context, name_size);
+    if (!w->pipeline_name) {
+        halide_free(user_context, w);
+        return nullptr;
+    }
+    memcpy(w->pipeline_name, pipeline_name, name_size);
+
+    if (initial_bytes) {
+        w->slab = (uint8_t *)halide_malloc(user_context, initial_bytes);
+        if (!w->slab) {
+            halide_free(user_context, w->pipeline_name);
+            halide_free(user_context, w);
+            return nullptr;
+        }
+        w->slab_size = initial_bytes;
+    }
+
+    ScopedMutexLock lock(&workspaces_lock);
+    w->next = workspaces;
+    workspaces = w;
+    return w;
+}
+
+WEAK void halide_workspace_destroy(void *user_context, halide_workspace_t *workspace) {
+    if (!workspace) {
+        return;
+    }
+    {
+        ScopedMutexLock lock(&workspaces_lock);
+        halide_workspace_t **prev = &workspaces;
+        while (*prev && *prev != workspace) {
+            prev = &((*prev)->next);
+        }
+        if (*prev) {
+            *prev = workspace->next;
+        }
+    }
+    for (int32_t i = 0; i < workspace->num_blocks; i++) {
+        if (workspace->blocks[i].owned) {
+            halide_free(user_context, workspace->blocks[i].ptr);
+        }
+    }
+    if (workspace->blocks_owned) {
+        halide_free(user_context, workspace->blocks);
+    }
+    if (workspace->slab) {
+        halide_free(user_context, workspace->slab);
+    }
+    halide_free(user_context, workspace->pipeline_name);
+    halide_free(user_context, workspace);
+}
+
+WEAK uint64_t halide_workspace_high_water_mark(const halide_workspace_t *workspace) {
+    return workspace ? workspace->layout_end : 0;
+}
+
+WEAK void *halide_workspace_malloc(void *user_context, const char *pipeline_name, int32_t site, uint64_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    ScopedMutexLock lock(&workspaces_lock);
+    halide_workspace_t *w = find_workspace(user_context, pipeline_name);
+    if (!w || site < 0) {
+        return halide_malloc(user_context, size);
+    }
+
+    if (site >= w->num_blocks &&
+        !workspace_grow(user_context, w, max(site + 1, max(w->num_blocks * 2, 8)))) {
+        return nullptr;
+    }
+
+    WorkspaceBlock *b = w->blocks + site;
+    if (b->in_use) {
+        // The site is live more than once at the same time, which can
+        // only happen if the pipeline is being called concurrently
+        // with the same workspace. Don't share the memory.
+        return halide_malloc(user_context, size);
+    }
+
+    if (b->size < size) {
+        // Blocks are laid out one after another in the order they are
+        // first needed, whether or not the slab can hold them, so that a
+        // workspace whose slab is the size of an earlier run's layout
+        // places every block inside it. A block at the end of the layout
+        // grows in place. Any other block moves to the end, and its old
+        // range stays part of the layout, unused.
+        if (b->size == 0 || b->offset + b->size != w->layout_end) {
+            b->offset = w->layout_end;
+        }
+        workspace_release_block(user_context, w, b);
+        size_t rounded = workspace_round_up(size);
+        if (b->offset + rounded <= w->slab_size) {
+            b->ptr = w->slab + b->offset;
+        } else {
+            b->ptr = halide_malloc(user_context, rounded);
+            if (!b->ptr) {
+                return nullptr;
+            }
+            b->owned = true;
+        }
+        b->size = rounded;
+        w->layout_end = b->offset + rounded;
+    }
+
+    b->in_use = true;
+    return b->ptr;
+}
+
+WEAK void halide_workspace_free(void *user_context, void *ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    {
+        ScopedMutexLock lock(&workspaces_lock);
+        for (halide_workspace_t *w = workspaces; w; w = w->next) {
+            if (w->user_context != user_context) {
+                continue;
+            }
+            for (int32_t i = 0; i < w->num_blocks; i++) {
+                WorkspaceBlock *b = w->blocks + i;
+                if (b->in_use && b->ptr == ptr) {
+                    b->in_use = false;
+                    return;
+                }
+            }
+        }
+    }
+
+    halide_free(user_context, ptr);
+}
+}
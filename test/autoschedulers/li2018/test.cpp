@@ -154,6 +154,68 @@ int main(int argc, char **argv) {
         //           << result.schedule_source << "\n\n";
     }
 
+    {  // Stencil chain under a memory budget. Should store exactly one
+        // intermediate stage, where the unconstrained run stores them all.
+        auto make_chain = [&](const std::string &prefix, std::vector<Func> &stages) {
+            Func in(prefix + "in");
+            in(x, y) = cast<float>(x + y);
+            stages.push_back(in);
+            for (int i = 0; i < 4; i++) {
+                Func f(prefix + "f" + std::to_string(i));
+                f(x, y) = stages.back()(x - 1, y) + stages.back()(x + 1, y) +
+                          stages.back()(x, y - 1) + stages.back()(x, y + 1);
+                stages.push_back(f);
+            }
+            Func out(prefix + "out");
+            out(x, y) = stages.back()(x, y);
+
+            out.set_estimate(x, 0, 1000)
+                .set_estimate(y, 0, 1000);
+            return out;
+        };
+
+        auto count_stored = [](const AutoSchedulerResults &result, const std::vector<Func> &stages) {
+            std::set<std::string> lines;
+            std::istringstream source(result.schedule_source);
+            for (std::string line; std::getline(source, line);) {
+                lines.insert(line);
+            }
+            int stored = 0;
+            for (const Func &f : stages) {
+                stored += lines.count(f.name() + ".compute_root()");
+            }
+            return stored;
+        };
+
+        std::vector<Func> full_stages;
+        Func full_out = make_chain("full_", full_stages);
+        AutoSchedulerResults full_result = Pipeline(full_out).apply_autoscheduler(target, params);
+
+        // The output takes 1000x1000 floats, each stored stage a little more
+        // than that, so this leaves room for exactly one stage.
+        std::vector<Func> budget_stages;
+        Func budget_out = make_chain("budget_", budget_stages);
+        AutoschedulerParams budget_params = params;
+        budget_params.extra["memory_budget"] = std::to_string(2 * 1100 * 1100 * sizeof(float));
+        AutoSchedulerResults budget_result = Pipeline(budget_out).apply_autoscheduler(target, budget_params);
+        // Don't dump to stdout (this is only for debugging)
+        // std::cout << "Schedule for stencil chain under a memory budget:\n"
+        //           << budget_result.schedule_source << "\n\n";
+
+        int full_stored = count_stored(full_result, full_stages);
+        int budget_stored = count_stored(budget_result, budget_stages);
+        if (full_stored <= 1 || budget_stored != 1) {
+            fprintf(stderr, "Expected one stored stage under the memory budget and more without it, "
+                            "got %d and %d\n",
+                    budget_stored, full_stored);
+            return 1;
+        }
+        if (budget_result.schedule_source.find("budget_out.compute_root()") == std::string::npos) {
+            fprintf(stderr, "The output should be stored under the memory budget\n");
+            return 1;
+        }
+    }
+
     printf("Success!\n");
     return 0;
 }
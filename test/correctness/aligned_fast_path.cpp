@@ -0,0 +1,111 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+namespace {
+
+// Counts the loads and stores whose buffer is known to be aligned to
+// at least the given number of bytes.
+class CountAlignedAccesses : public IRMutator {
+    using IRMutator::visit;
+
+    int alignment;
+
+    Expr visit(const Load *op) override {
+        if (op->param.defined() && op->param.host_alignment() >= alignment) {
+            aligned++;
+        }
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const Store *op) override {
+        if (op->param.defined() && op->param.host_alignment() >= alignment) {
+            aligned++;
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    int aligned = 0;
+    CountAlignedAccesses(int alignment)
+        : alignment(alignment) {
+    }
+};
+
+bool check(const Buffer<float> &in, Buffer<float> &out, Callable &c) {
+    if (c(in, out) != 0) {
+        return false;
+    }
+    for (int y = out.dim(1).min(); y <= out.dim(1).max(); y++) {
+        for (int x = out.dim(0).min(); x <= out.dim(0).max(); x++) {
+            float correct = in(x, y) * 2 + in(x + 1, y);
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment().with_feature(Target::AlignedFastPath);
+    const int vector_bytes = t.natural_vector_size<uint8_t>();
+
+    ImageParam input(Float(32), 2, "input");
+    Func f("f");
+    Var x("x"), y("y");
+    f(x, y) = input(x, y) * 2 + input(x + 1, y);
+    f.vectorize(x, t.natural_vector_size<float>());
+
+    // Allow strided inputs and outputs, so the generic path has to
+    // handle them.
+    input.dim(0).set_stride(Expr());
+    f.output_buffer().dim(0).set_stride(Expr());
+
+    CountAlignedAccesses counter(vector_bytes);
+    f.add_custom_lowering_pass(&counter, []() {});
+    Callable c = f.compile_to_callable({input}, t);
+    if (counter.aligned == 0) {
+        printf("Expected the fast path to make aligned loads and stores\n");
+        return 1;
+    }
+
+    Buffer<float> in(272, 100);
+    in.for_each_element([&](int x, int y) { in(x, y) = (float)(x * 3 + y * 7); });
+
+    // Dense and aligned: takes the fast path.
+    Buffer<float> out(256, 100);
+    if (!check(in, out, c)) {
+        return 1;
+    }
+
+    // Misaligned host pointer and min.
+    Buffer<float> cropped_out(256, 100);
+    cropped_out.crop(0, 1, 200);
+    if (!check(in, cropped_out, c)) {
+        return 1;
+    }
+
+    // An odd row stride.
+    Buffer<float> odd_out(253, 100);
+    if (!check(in, odd_out, c)) {
+        return 1;
+    }
+
+    // Strided in the innermost dimension.
+    Buffer<float> in_t(100, 272);
+    in_t.for_each_element([&](int y, int x) { in_t(y, x) = (float)(x * 3 + y * 7); });
+    Buffer<float> transposed_in = in_t.transposed(0, 1);
+    Buffer<float> transposed_out = Buffer<float>(100, 256).transposed(0, 1);
+    if (!check(transposed_in, transposed_out, c)) {
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "Halide.h"
+
+using namespace Halide;
+
+// Runtime-sized allocations, both at the root and inside a loop, whose
+// sizes depend on values defined by the enclosing scopes.
+Func make_pipeline(ImageParam &input, Param<int> &radius) {
+    Var x("x"), y("y");
+    Func clamped = BoundaryConditions::repeat_edge(input);
+
+    Func a("a"), b("b"), c("c"), d("d"), out("out");
+    a(x, y) = clamped(x, y) * 2;
+    b(x, y) = a(x - radius, y) + a(x + radius, y);
+    c(x, y) = b(x, y - radius) + b(x, y + radius);
+    d(x, y) = c(x - 1, y) + c(x + 1, y) + c(x, y);
+    out(x, y) = d(x, y) - a(x, y);
+
+    a.compute_root();
+    b.compute_root();
+    c.compute_at(out, y).store_in(MemoryType::Heap);
+    d.compute_at(out, y).store_in(MemoryType::Heap);
+    return out;
+}
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment();
+
+    Buffer<int> in(97, 61);
+    in.for_each_element([&](int x, int y) {
+        in(x, y) = (x * 17 + y * 31) % 101;
+    });
+
+    for (int r = 1; r <= 5; r += 2) {
+        ImageParam input(Int(32), 2);
+        Param<int> radius;
+        input.set(in);
+        radius.set(r);
+
+        Func out = make_pipeline(input, radius);
+        Buffer<int> expected = out.realize({in.width() - 3, in.height() - 5}, t);
+        Buffer<int> actual = out.realize({in.width() - 3, in.height() - 5},
+                                         t.with_feature(Target::ArenaAllocations));
+
+        for (int y = 0; y < expected.height(); y++) {
+            for (int x = 0; x < expected.width(); x++) {
+                if (actual(x, y) != expected(x, y)) {
+                    printf("actual(%d, %d) = %d instead of %d for radius %d\n",
+                           x, y, actual(x, y), expected(x, y), r);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
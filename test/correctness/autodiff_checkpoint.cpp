@@ -0,0 +1,74 @@
+#include "Halide.h"
+
+#include <cmath>
+#include <stdio.h>
+
+using namespace Halide;
+
+namespace {
+
+const int size = 32;
+
+// Compute the gradient of a three-layer 1D stencil with respect to its
+// input, checkpointing the layers with the given budget. A negative
+// budget stores exactly the middle layer.
+Buffer<float> gradient(const Buffer<float> &input, int64_t memory_budget, size_t *num_stored) {
+    Var x("x");
+    Func clamped = BoundaryConditions::repeat_edge(input);
+    Func layer1("layer1"), layer2("layer2"), layer3("layer3");
+    layer1(x) = tanh(clamped(x - 1) + clamped(x) + clamped(x + 1));
+    layer2(x) = tanh(layer1(x - 1) * 0.5f + layer1(x + 1) * 0.25f);
+    layer3(x) = layer2(x - 1) * layer2(x + 1);
+
+    RDom r(0, size);
+    Func loss("loss");
+    loss() = 0.f;
+    loss() += layer3(r) * layer3(r);
+
+    if (memory_budget >= 0) {
+        *num_stored = checkpoint_adjoints(loss, {}, memory_budget).size();
+    } else {
+        checkpoint_adjoints(loss, {layer2});
+        *num_stored = 1;
+    }
+
+    Derivative d = propagate_adjoints(loss);
+    return d(input).realize({size});
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Buffer<float> input(size);
+    input.for_each_element([&](int x) { input(x) = std::sin(x * 0.37f); });
+
+    // Store everything.
+    size_t num_stored = 0;
+    Buffer<float> correct = gradient(input, 1 << 20, &num_stored);
+    if (num_stored != 4) {
+        printf("Stored %d Funcs instead of 4\n", (int)num_stored);
+        return 1;
+    }
+
+    // Recompute everything, store one layer, and store the layer we ask for.
+    const int64_t one_layer = (size + 8) * sizeof(float);
+    for (int64_t budget : {(int64_t)0, one_layer, (int64_t)-1}) {
+        Buffer<float> result = gradient(input, budget, &num_stored);
+        size_t expected_stored = budget == 0 ? 0 : 1;
+        if (num_stored != expected_stored) {
+            printf("Stored %d Funcs instead of %d with a budget of %d bytes\n",
+                   (int)num_stored, (int)expected_stored, (int)budget);
+            return 1;
+        }
+        for (int x = 0; x < size; x++) {
+            if (std::abs(result(x) - correct(x)) > 1e-5f * std::max(1.f, std::abs(correct(x)))) {
+                printf("With a budget of %d bytes, gradient(%d) = %f instead of %f\n",
+                       (int)budget, x, result(x), correct(x));
+                return 1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -111,6 +111,30 @@ int main(int argc, char **argv) {
             assert(in1.dim(0).extent() == 10);
             assert(in1.dim(1).extent() == 10);
         }
+
+        {
+            // Test pre-bound calls
+            Buffer<uint8_t> out(10, 10);
+            const uint8_t *in1_host = in1.raw_buffer()->host;
+            auto bound = c.bind(in1, 42, 1.0f, out);
+            check(bound());
+            for (int i = 0; i < 10; i++) {
+                for (int j = 0; j < 10; j++) {
+                    assert(out(i, j) == i + j * 10 + 42);
+                }
+            }
+
+            bound.set<1>(16);
+            bound.set_host<0>(in2.data());
+            check(bound());
+            for (int i = 0; i < 10; i++) {
+                for (int j = 0; j < 10; j++) {
+                    assert(out(i, j) == i * 10 + j + 16);
+                }
+            }
+            // The Buffer that was bound is left alone.
+            assert(in1.raw_buffer()->host == in1_host);
+        }
     }
 
     // Override Halide's malloc and free (except under wasm),
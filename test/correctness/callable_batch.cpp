@@ -0,0 +1,93 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+namespace {
+
+bool error_occurred = false;
+void my_error_handler(JITUserContext *user_context, const char *msg) {
+    error_occurred = true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    const Target t = get_jit_target_from_environment();
+
+    ImageParam p_img(UInt(8), 2);
+    Param<int32_t> p_int;
+
+    Var x("x"), y("y");
+    Func f("f");
+    f(x, y) = p_img(x, y) + cast<uint8_t>(p_int);
+
+    Callable c = f.compile_to_callable({p_img, p_int}, t);
+
+    const int batch_size = 64;
+    std::vector<Buffer<uint8_t>> ins, outs;
+    std::vector<std::tuple<Buffer<uint8_t>, int, Buffer<uint8_t>>> batch;
+    for (int i = 0; i < batch_size; i++) {
+        ins.emplace_back(16, 8);
+        outs.emplace_back(16, 8);
+        ins.back().for_each_element([&](int x, int y) { ins.back()(x, y) = (uint8_t)(x + y * 16 + i); });
+        batch.emplace_back(ins.back(), i, outs.back());
+    }
+
+    {
+        std::vector<int> exit_statuses;
+        int result = c.call_batch(batch, &exit_statuses);
+        if (result != 0 || (int)exit_statuses.size() != batch_size) {
+            printf("call_batch failed with %d\n", result);
+            return 1;
+        }
+        for (int i = 0; i < batch_size; i++) {
+            if (exit_statuses[i] != 0) {
+                printf("exit_statuses[%d] = %d\n", i, exit_statuses[i]);
+                return 1;
+            }
+            for (int yy = 0; yy < 8; yy++) {
+                for (int xx = 0; xx < 16; xx++) {
+                    uint8_t correct = (uint8_t)(xx + yy * 16 + i + i);
+                    if (outs[i](xx, yy) != correct) {
+                        printf("outs[%d](%d, %d) = %d instead of %d\n", i, xx, yy, outs[i](xx, yy), correct);
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+
+    {
+        // An entry whose input is too small should fail on its own
+        // without preventing the rest of the batch from running.
+        Buffer<uint8_t> bad_in(4, 4);
+        std::get<0>(batch[3]) = bad_in;
+
+        for (auto &b : outs) {
+            b.fill(0);
+        }
+
+        JITUserContext context;
+        context.handlers.custom_error = my_error_handler;
+        std::vector<int> exit_statuses;
+        int result = c.call_batch(&context, batch, &exit_statuses);
+        if (result == 0 || !error_occurred) {
+            printf("Expected call_batch to fail\n");
+            return 1;
+        }
+        for (int i = 0; i < batch_size; i++) {
+            if ((exit_statuses[i] != 0) != (i == 3)) {
+                printf("Unexpected exit_statuses[%d] = %d\n", i, exit_statuses[i]);
+                return 1;
+            }
+            if (i != 3 && outs[i](15, 7) != (uint8_t)(15 + 7 * 16 + i + i)) {
+                printf("Entry %d of the batch did not run\n", i);
+                return 1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
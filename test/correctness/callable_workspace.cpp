@@ -0,0 +1,157 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+namespace {
+
+int malloc_count = 0;
+int free_count = 0;
+
+void *my_malloc(JITUserContext *user_context, size_t x) {
+    malloc_count++;
+    void *orig = malloc(x + 32);
+    void *ptr = (void *)((((size_t)orig + 32) >> 5) << 5);
+    ((void **)ptr)[-1] = orig;
+    return ptr;
+}
+
+void my_free(JITUserContext *user_context, void *ptr) {
+    free_count++;
+    free(((void **)ptr)[-1]);
+}
+
+bool check_output(const Buffer<float> &out, const Buffer<float> &in) {
+    for (int y = 0; y < out.height(); y++) {
+        for (int x = 0; x < out.width(); x++) {
+            float correct = (in(x, y) + 1) * 2 + (in(x, y) + 1) * 3;
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    const Target t = get_jit_target_from_environment();
+    if (t.arch == Target::WebAssembly) {
+        printf("[SKIP] WebAssembly JIT does not support custom allocators.\n");
+        return 0;
+    }
+
+    ImageParam input(Float(32), 2);
+    Var x("x"), y("y");
+    Func f("f"), g("g"), h("h"), out("out");
+    f(x, y) = input(x, y) + 1;
+    g(x, y) = f(x, y) * 2;
+    h(x, y) = f(x, y) * 3;
+    out(x, y) = g(x, y) + h(x, y);
+    f.compute_root();
+    g.compute_root();
+    h.compute_root();
+
+    Callable c = out.compile_to_callable({input}, t.with_feature(Target::Workspace));
+
+    Buffer<float> in(100, 100);
+    in.for_each_element([&](int x, int y) { in(x, y) = (float)(x + y * 100); });
+    Buffer<float> big(100, 100), small(50, 50);
+
+    JITUserContext ctx;
+    ctx.handlers.custom_malloc = my_malloc;
+    ctx.handlers.custom_free = my_free;
+
+    halide_workspace_t *workspace = c.create_workspace(&ctx);
+
+    // The first call has to allocate the intermediate Funcs.
+    malloc_count = 0;
+    if (c(&ctx, in, big) != 0 || !check_output(big, in)) {
+        return 1;
+    }
+    if (malloc_count == 0) {
+        printf("Expected the first call to allocate\n");
+        return 1;
+    }
+
+    // Later calls with the same or smaller extents reuse the memory.
+    malloc_count = 0;
+    for (int i = 0; i < 3; i++) {
+        if (c(&ctx, in, big) != 0 || !check_output(big, in)) {
+            return 1;
+        }
+        if (c(&ctx, in, small) != 0 || !check_output(small, in)) {
+            return 1;
+        }
+    }
+    if (malloc_count != 0) {
+        printf("Expected no allocations after the first call, got %d\n", malloc_count);
+        return 1;
+    }
+
+    uint64_t high_water_mark = Callable::workspace_high_water_mark(workspace);
+    if (high_water_mark < 3 * 100 * 100 * sizeof(float)) {
+        printf("Unexpected high water mark: %d\n", (int)high_water_mark);
+        return 1;
+    }
+    c.destroy_workspace(&ctx, workspace);
+
+    // A workspace created with the high water mark never allocates
+    // once it exists.
+    workspace = c.create_workspace(&ctx, high_water_mark);
+    malloc_count = 0;
+    if (c(&ctx, in, big) != 0 || !check_output(big, in)) {
+        return 1;
+    }
+    if (malloc_count != 0) {
+        printf("Expected a pre-sized workspace not to allocate, got %d\n", malloc_count);
+        return 1;
+    }
+    c.destroy_workspace(&ctx, workspace);
+
+    // The same goes for calls during which a site outgrows its block:
+    // the high water mark of a small call followed by a big one is
+    // enough for a pre-sized workspace to make those calls again.
+    workspace = c.create_workspace(&ctx);
+    if (c(&ctx, in, small) != 0 || !check_output(small, in) ||
+        c(&ctx, in, big) != 0 || !check_output(big, in)) {
+        return 1;
+    }
+    high_water_mark = Callable::workspace_high_water_mark(workspace);
+    c.destroy_workspace(&ctx, workspace);
+
+    workspace = c.create_workspace(&ctx, high_water_mark);
+    malloc_count = 0;
+    if (c(&ctx, in, small) != 0 || !check_output(small, in) ||
+        c(&ctx, in, big) != 0 || !check_output(big, in)) {
+        return 1;
+    }
+    if (malloc_count != 0) {
+        printf("Expected a pre-sized workspace not to allocate when a site grows, got %d\n", malloc_count);
+        return 1;
+    }
+    c.destroy_workspace(&ctx, workspace);
+
+    // Calls with a context that has no workspace allocate as usual.
+    JITUserContext other_ctx;
+    other_ctx.handlers.custom_malloc = my_malloc;
+    other_ctx.handlers.custom_free = my_free;
+    malloc_count = free_count = 0;
+    if (c(&other_ctx, in, big) != 0 || !check_output(big, in)) {
+        return 1;
+    }
+    if (malloc_count == 0) {
+        printf("Expected a call without a workspace to allocate\n");
+        return 1;
+    }
+
+    if (malloc_count != free_count) {
+        printf("Leaked memory: %d mallocs, %d frees\n", malloc_count, free_count);
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
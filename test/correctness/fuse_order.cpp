@@ -0,0 +1,156 @@
+#include "Halide.h"
+#include <stdio.h>
+
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace Halide;
+
+namespace {
+
+std::vector<std::pair<int, int>> visited;
+
+int record_stores(JITUserContext *, const halide_trace_event_t *e) {
+    if (e->event == halide_trace_store) {
+        visited.emplace_back(e->coordinates[0], e->coordinates[1]);
+    }
+    return 0;
+}
+
+const char *order_name(FuseOrder order) {
+    return order == FuseOrder::Morton ? "Morton" : "Hilbert";
+}
+
+// Fuse x and y directly, and check the order in which the pixels are
+// stored: every pixel exactly once, and for the Hilbert curve over a
+// square of side a power of two, each pixel next to the previous one.
+bool check_traversal(FuseOrder order, int w, int h) {
+    Func f("f");
+    Var x("x"), y("y"), t("t");
+    f(x, y) = x + y;
+    f.fuse(x, y, t, order).trace_stores();
+    f.jit_handlers().custom_trace = record_stores;
+
+    visited.clear();
+    f.realize({w, h});
+
+    if ((int)visited.size() != w * h) {
+        printf("%s %dx%d: %d stores instead of %d\n",
+               order_name(order), w, h, (int)visited.size(), w * h);
+        return false;
+    }
+
+    std::set<std::pair<int, int>> unique(visited.begin(), visited.end());
+    if ((int)unique.size() != w * h) {
+        printf("%s %dx%d: some pixels were computed more than once\n", order_name(order), w, h);
+        return false;
+    }
+
+    if (order == FuseOrder::Hilbert && w == h && (w & (w - 1)) == 0) {
+        for (size_t i = 1; i < visited.size(); i++) {
+            int dx = std::abs(visited[i].first - visited[i - 1].first);
+            int dy = std::abs(visited[i].second - visited[i - 1].second);
+            if (dx + dy != 1) {
+                printf("Hilbert %dx%d: step %d from (%d, %d) to (%d, %d) is not to a neighbour\n",
+                       w, h, (int)i, visited[i - 1].first, visited[i - 1].second,
+                       visited[i].first, visited[i].second);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// A two-stage stencil, tiled, with the tile indices fused along a
+// curve and parallelized, and the producer computed per tile. Bounds
+// inference has to get the footprint of each tile right.
+bool check_stencil(FuseOrder order, int w, int h) {
+    Func input("input"), blur_x("blur_x"), blur_y("blur_y");
+    Var x("x"), y("y"), xo("xo"), yo("yo"), xi("xi"), yi("yi"), t("t");
+
+    input(x, y) = x * 17 + y * 13;
+    blur_x(x, y) = input(x - 1, y) + input(x, y) + input(x + 1, y);
+    blur_y(x, y) = blur_x(x, y - 1) + blur_x(x, y) + blur_x(x, y + 1);
+
+    input.compute_root();
+    blur_y.tile(x, y, xo, yo, xi, yi, 16, 8)
+        .fuse(xo, yo, t, order)
+        .parallel(t)
+        .vectorize(xi, 8);
+    blur_x.compute_at(blur_y, t).vectorize(x, 8);
+
+    Buffer<int> out(w, h);
+    out.set_min(-3, 5);
+    blur_y.realize(out);
+
+    for (int yy = out.dim(1).min(); yy <= out.dim(1).max(); yy++) {
+        for (int xx = out.dim(0).min(); xx <= out.dim(0).max(); xx++) {
+            int correct = 0;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    correct += (xx + dx) * 17 + (yy + dy) * 13;
+                }
+            }
+            if (out(xx, yy) != correct) {
+                printf("%s %dx%d: out(%d, %d) = %d instead of %d\n",
+                       order_name(order), w, h, xx, yy, out(xx, yy), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Fuse two pure RVars of an update along a curve.
+bool check_rvars(FuseOrder order) {
+    Func f("f");
+    Var x("x"), y("y");
+    RDom r(0, 13, 0, 29);
+    RVar t("t");
+
+    f(x, y) = 0;
+    f(r.x, r.y) += r.x * 100 + r.y;
+    f.update().fuse(r.x, r.y, t, order);
+
+    Buffer<int> out = f.realize({13, 29});
+    for (int yy = 0; yy < out.height(); yy++) {
+        for (int xx = 0; xx < out.width(); xx++) {
+            if (out(xx, yy) != xx * 100 + yy) {
+                printf("%s rvars: out(%d, %d) = %d instead of %d\n",
+                       order_name(order), xx, yy, out(xx, yy), xx * 100 + yy);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    for (FuseOrder order : {FuseOrder::Morton, FuseOrder::Hilbert}) {
+        // Square and non-square, powers of two and not, and
+        // degenerate extents.
+        const int sizes[][2] = {{16, 16}, {8, 32}, {32, 8}, {13, 7}, {7, 13}, {1, 9}, {9, 1}, {1, 1}};
+        for (const auto &size : sizes) {
+            if (!check_traversal(order, size[0], size[1])) {
+                return 1;
+            }
+        }
+
+        if (!check_stencil(order, 128, 64) ||
+            !check_stencil(order, 150, 77) ||
+            !check_stencil(order, 20, 200)) {
+            return 1;
+        }
+
+        if (!check_rvars(order)) {
+            return 1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "Halide.h"
+#include "halide_test_dirs.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdlib.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+namespace {
+
+// Every Func and Var is named, so that running the generator again in
+// this process builds an identical pipeline, as a fresh process would.
+class CacheTest : public Generator<CacheTest> {
+public:
+    GeneratorParam<int> scale{"scale", 3};
+
+    Input<Buffer<uint8_t, 2>> input{"input"};
+    Output<Buffer<uint16_t, 2>> output{"output"};
+
+    void generate() {
+        Var x("x"), y("y"), xi("xi");
+        Func blur("blur");
+        blur(x, y) = cast<uint16_t>(input(x, y)) + input(x + 1, y);
+        output(x, y) = blur(x, y) * cast<uint16_t>(scale);
+        output.split(x, x, xi, 8).vectorize(xi);
+    }
+};
+
+int generators_created = 0;
+int compilations = 0;
+
+std::string read_file(const std::string &path) {
+    std::ifstream f(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+int count_entries(const std::string &dir) {
+    int n = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+        n += entry.is_directory();
+    }
+    return n;
+}
+
+// Run the generator, returning the contents of its outputs.
+std::map<std::string, std::string> run(const std::string &output_dir, const std::string &scale) {
+    ExecuteGeneratorArgs args;
+    args.output_dir = output_dir;
+    args.output_types = {OutputFileType::object, OutputFileType::c_header};
+    args.targets = {get_host_target()};
+    args.generator_name = "cache_test";
+    args.function_name = "cache_test";
+    args.file_base_name = "cache_test";
+    args.generator_params = {{"scale", scale}};
+    args.create_generator = [](const std::string &name, const GeneratorContext &context) -> AbstractGeneratorPtr {
+        generators_created++;
+        return CacheTest::create(context);
+    };
+    args.compiler_logger_factory = [](const std::string &, const Target &) -> std::unique_ptr<CompilerLogger> {
+        compilations++;
+        return nullptr;
+    };
+    execute_generator(args);
+
+    std::map<std::string, std::string> outputs;
+    for (const char *ext : {".o", ".h"}) {
+        outputs[ext] = read_file(output_dir + "/cache_test" + ext);
+    }
+    return outputs;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    printf("[SKIP] Windows does not have a working setenv\n");
+#else
+    if (!exceptions_enabled()) {
+        printf("[SKIP] The generator cache needs Halide to be built with exceptions.\n");
+        return 0;
+    }
+
+    const std::string dir = get_test_tmp_dir() + "generator_cache";
+    const std::string cache_dir = dir + "/cache";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(cache_dir);
+    setenv("HL_GENERATOR_CACHE_DIR", cache_dir.c_str(), 1);
+
+    // A miss builds the pipeline once, to compute the key, and compiles it.
+    auto first = run(dir, "3");
+    if (generators_created != 1 || compilations != 1 || count_entries(cache_dir) != 1) {
+        printf("First run: %d generators, %d compilations, %d cache entries\n",
+               generators_created, compilations, count_entries(cache_dir));
+        return 1;
+    }
+
+    // A hit builds the pipeline but doesn't compile it.
+    generators_created = compilations = 0;
+    auto second = run(dir, "3");
+    if (generators_created != 1 || compilations != 0 || count_entries(cache_dir) != 1) {
+        printf("Second run: %d generators, %d compilations, %d cache entries\n",
+               generators_created, compilations, count_entries(cache_dir));
+        return 1;
+    }
+    if (second != first) {
+        printf("The outputs from the cache differ from the compiled ones\n");
+        return 1;
+    }
+
+    // Writing the outputs somewhere else is still a hit, and gives the
+    // same outputs as compiling there, include guards and all.
+    const std::string other_dir = dir + "/other";
+    std::filesystem::create_directories(other_dir);
+    generators_created = compilations = 0;
+    auto elsewhere = run(other_dir, "3");
+    if (compilations != 0 || count_entries(cache_dir) != 1) {
+        printf("Run in another directory: %d compilations, %d cache entries\n",
+               compilations, count_entries(cache_dir));
+        return 1;
+    }
+    unsetenv("HL_GENERATOR_CACHE_DIR");
+    auto compiled_elsewhere = run(other_dir, "3");
+    setenv("HL_GENERATOR_CACHE_DIR", cache_dir.c_str(), 1);
+    if (elsewhere != compiled_elsewhere) {
+        printf("The outputs from the cache differ from the compiled ones in another directory\n");
+        return 1;
+    }
+
+    // Changing a GeneratorParam changes the key.
+    generators_created = compilations = 0;
+    auto third = run(dir, "5");
+    if (compilations != 1 || count_entries(cache_dir) != 2) {
+        printf("Third run: %d compilations, %d cache entries\n",
+               compilations, count_entries(cache_dir));
+        return 1;
+    }
+    if (third[".o"] == first[".o"]) {
+        printf("Changing a GeneratorParam didn't change the object file\n");
+        return 1;
+    }
+
+    std::filesystem::remove_all(dir);
+#endif
+    printf("Success!\n");
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include "Halide.h"
 #include "halide_image_io.h"
 #include "halide_test_dirs.h"
+#include "halide_tiff_writer.h"
 
 #include <fstream>
 
@@ -14,9 +15,6 @@ void test_round_trip(Buffer<T> buf, std::string format) {
     std::string filename = o.str();
     Tools::save_image(buf, filename);
 
-    // TIFF is write-only for now.
-    if (format == "tiff") return;
-
     // Reload it
     Buffer<T> reloaded = Tools::load_image(filename);
 
@@ -25,6 +23,28 @@ void test_round_trip(Buffer<T> buf, std::string format) {
         reloaded.translate(d, buf.dim(d).min() - reloaded.dim(d).min());
     }
 
+    // Formats with uncompressed payloads can be mapped instead of read,
+    // which must give the same pixels.
+    if (format == "npy" || format == "tmp" || format == "mat") {
+        Tools::MappedImageFile mapping;
+        Buffer<T> mapped;
+        if (!Tools::load_mapped(filename, &mapping, &mapped)) {
+            printf("test_round_trip: load_mapped failed for %s\n", filename.c_str());
+            exit(1);
+        }
+        for (int d = 0; d < reloaded.dimensions(); ++d) {
+            mapped.translate(d, reloaded.dim(d).min() - mapped.dim(d).min());
+        }
+        bool same = true;
+        reloaded.for_each_element([&](const int *pos) {
+            same &= (mapped(pos) == reloaded(pos));
+        });
+        if (!same) {
+            printf("test_round_trip: mapped and loaded %s differ\n", filename.c_str());
+            exit(1);
+        }
+    }
+
     o = std::ostringstream();
     o << Internal::get_test_tmp_dir() << "test_" << halide_type_of<T>() << "x" << buf.channels() << ".reloaded." << format;
     filename = o.str();
@@ -268,6 +288,67 @@ void test_mat_header() {
     }
 }
 
+template<typename T>
+void test_tiled_tiff(int channels) {
+    std::cout << "Testing tiled tiff for " << halide_type_of<T>() << "x" << channels << "\n";
+
+    // An image that isn't a multiple of the tile size, written a few
+    // tiles at a time, out of order.
+    const int width = 100, height = 70, tile = 32;
+    Buffer<T> buf = channels == 1 ? Buffer<T>(width, height) : Buffer<T>(width, height, channels);
+    buf.for_each_element([&](const int *pos) {
+        int v = pos[0] + pos[1] * 3 + (channels == 1 ? 0 : pos[2] * 7);
+        buf(pos) = (T)(v % 100);
+    });
+
+    std::ostringstream o;
+    o << Internal::get_test_tmp_dir() << "test_tiled_" << halide_type_of<T>() << "x" << channels << ".tiff";
+    std::string filename = o.str();
+
+    Tools::TiledTiffWriter<Tools::Internal::CheckFail> writer;
+    writer.open(filename, halide_type_of<T>(), width, height, channels, tile, tile, 3);
+    for (int y = (height - 1) / (tile * 2) * tile * 2; y >= 0; y -= tile * 2) {
+        for (int x = 0; x < width; x += tile) {
+            Buffer<T> region(buf.get()->cropped(0, x, std::min(tile, width - x)).cropped(1, y, std::min(tile * 2, height - y)));
+            writer.write(region);
+        }
+    }
+    writer.close();
+
+    halide_type_t type;
+    std::vector<int> extents;
+    Tools::load_tiff_shape<Tools::Internal::CheckFail>(filename, &type, &extents);
+    std::vector<int> expected_extents = {width, height};
+    if (channels > 1) {
+        expected_extents.push_back(channels);
+    }
+    if (type != halide_type_of<T>() || extents != expected_extents) {
+        printf("test_tiled_tiff: wrong shape for %s\n", filename.c_str());
+        exit(1);
+    }
+
+    // Load the whole thing, and a region that straddles several tiles.
+    Buffer<T> reloaded = Tools::load_image(filename);
+    Buffer<T> region;
+    Tools::load_tiff_region<Buffer<T>, Tools::Internal::CheckFail>(filename, 20, 25, 50, 40, &region);
+    if (region.dim(0).min() != 20 || region.dim(0).extent() != 50 ||
+        region.dim(1).min() != 25 || region.dim(1).extent() != 40) {
+        printf("test_tiled_tiff: wrong region bounds for %s\n", filename.c_str());
+        exit(1);
+    }
+    bool same = true;
+    buf.for_each_element([&](const int *pos) {
+        same &= (reloaded(pos) == buf(pos));
+    });
+    region.for_each_element([&](const int *pos) {
+        same &= (region(pos) == buf(pos));
+    });
+    if (!same) {
+        printf("test_tiled_tiff: reloaded %s differs\n", filename.c_str());
+        exit(1);
+    }
+}
+
 int main(int argc, char **argv) {
     do_test<int8_t>();
     do_test<int16_t>();
@@ -283,6 +364,9 @@ int main(int argc, char **argv) {
 #endif
     do_test<double>();
     test_mat_header();
+    test_tiled_tiff<uint8_t>(1);
+    test_tiled_tiff<uint16_t>(3);
+    test_tiled_tiff<float>(4);
     printf("Success!\n");
     return 0;
 }
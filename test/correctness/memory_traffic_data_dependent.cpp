@@ -0,0 +1,99 @@
+#include "Halide.h"
+#include <map>
+#include <stdio.h>
+#include <string.h>
+
+using namespace Halide;
+
+// Check the profiler's memory traffic counts for loops whose extents
+// are loaded from buffers: the counts can't be moved past the code that
+// produces those buffers.
+
+struct Traffic {
+    unsigned long long loaded = 0, stored = 0;
+};
+
+std::map<std::string, Traffic> traffic;
+
+void my_print(JITUserContext *, const char *msg) {
+    char name[64];
+    const char *counts = strstr(msg, " loaded: ");
+    if (counts && sscanf(msg, " %63[^:]:", name) == 1) {
+        Traffic t;
+        if (sscanf(counts, " loaded: %llu stored: %llu", &t.loaded, &t.stored) == 2) {
+            traffic[name] = t;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment().with_feature(Target::Profile).with_feature(Target::ProfileMemoryTraffic);
+    if (t.arch == Target::WebAssembly) {
+        printf("[SKIP] The profiler isn't supported under WebAssembly.\n");
+        return 0;
+    }
+
+    Var x("x");
+    const int n = 1000;
+
+    Buffer<float> in(4 * n);
+    in.fill(1.0f);
+
+    {
+        // The region of f computed for each x of g is [idx(x), 2 * idx(x)],
+        // and idx is computed and freed in that same loop.
+        Func idx("idx_1"), f("f_1"), g("g_1");
+        idx(x) = x % 4;
+        f(x) = in(x) * 2;
+        g(x) = f(idx(x)) + f(2 * idx(x));
+        idx.compute_at(g, x);
+        f.compute_at(g, x);
+
+        g.jit_handlers().custom_print = my_print;
+
+        traffic.clear();
+        Buffer<float> result = g.realize({n}, t);
+        for (int i = 0; i < n; i++) {
+            if (result(i) != 4.0f) {
+                printf("result(%d) = %f instead of 4\n", i, result(i));
+                return 1;
+            }
+        }
+
+        // Each group of 4 xs computes 1 + 2 + 3 + 4 points of f.
+        const unsigned long long f_bytes = (n / 4) * 10 * sizeof(float);
+        if (traffic["f_1"].loaded != f_bytes || traffic["f_1"].stored != f_bytes) {
+            printf("f loaded %llu and stored %llu bytes instead of %llu\n",
+                   traffic["f_1"].loaded, traffic["f_1"].stored, f_bytes);
+            return 1;
+        }
+        if (traffic["idx_1"].stored != n * sizeof(int)) {
+            printf("idx stored %llu bytes instead of %llu\n",
+                   traffic["idx_1"].stored, (unsigned long long)(n * sizeof(int)));
+            return 1;
+        }
+    }
+
+    {
+        // An update whose extent comes from an input buffer.
+        Buffer<int> lengths(1);
+        lengths(0) = 7;
+        RDom r(0, clamp(lengths(0), 0, 16));
+        Func h("h_2");
+        h(x) = 0.0f;
+        h(x) += in(x + r);
+
+        h.jit_handlers().custom_print = my_print;
+
+        traffic.clear();
+        h.realize({n}, t);
+        const unsigned long long h_stored = (unsigned long long)n * (1 + 7) * sizeof(float);
+        if (traffic["h_2"].stored != h_stored) {
+            printf("h stored %llu bytes instead of %llu\n", traffic["h_2"].stored, h_stored);
+            return 1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "Halide.h"
+
+using namespace Halide;
+
+namespace {
+
+bool test_histogram(int num_tasks, int vector_width) {
+    Buffer<uint8_t> in(123, 77);
+    in.for_each_element([&](int x, int y) { in(x, y) = (uint8_t)((x * 17 + y * 31 + x * y) & 255); });
+
+    Func hist("hist");
+    Var x("x");
+    RDom r(in);
+    hist(x) = 0;
+    hist(in(r.x, r.y)) += 1;
+    hist.update().privatize(r.y, num_tasks, vector_width);
+
+    Buffer<int> result = hist.realize({256});
+
+    int correct[256] = {0};
+    in.for_each_value([&](uint8_t v) { correct[v]++; });
+    for (int i = 0; i < 256; i++) {
+        if (result(i) != correct[i]) {
+            printf("hist(%d) = %d instead of %d\n", i, result(i), correct[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_tuple_histogram() {
+    // The count and the sum of the values that land in each bin. Tuple
+    // updates can't use a single atomic instruction.
+    Buffer<int> in(1000);
+    in.for_each_element([&](int x) { in(x) = (x * 7919) % 1009; });
+
+    Func hist("hist");
+    Var x("x");
+    RDom r(in);
+    hist(x) = {0, 0};
+    Expr bin = in(r) % 32;
+    hist(bin) = {hist(bin)[0] + 1, hist(bin)[1] + in(r)};
+    hist.update().privatize(r, 4, 8);
+
+    Realization result = hist.realize({32});
+    Buffer<int> count = result[0], sum = result[1];
+
+    int correct_count[32] = {0}, correct_sum[32] = {0};
+    in.for_each_value([&](int v) {
+        correct_count[v % 32]++;
+        correct_sum[v % 32] += v;
+    });
+    for (int i = 0; i < 32; i++) {
+        if (count(i) != correct_count[i] || sum(i) != correct_sum[i]) {
+            printf("hist(%d) = {%d, %d} instead of {%d, %d}\n",
+                   i, count(i), sum(i), correct_count[i], correct_sum[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_2d_histogram() {
+    Buffer<uint8_t> in(64, 64);
+    in.for_each_element([&](int x, int y) { in(x, y) = (uint8_t)((x * 5 + y * 11) & 255); });
+
+    Func hist("hist");
+    Var x("x"), y("y");
+    RDom r(0, in.width() - 1, 0, in.height());
+    hist(x, y) = 0;
+    hist(in(r.x, r.y) / 16, in(r.x + 1, r.y) / 16) += 1;
+    hist.update().privatize(r.y, 5, 4);
+
+    Buffer<int> result = hist.realize({16, 16});
+
+    int correct[16][16] = {{0}};
+    for (int yy = 0; yy < in.height(); yy++) {
+        for (int xx = 0; xx < in.width() - 1; xx++) {
+            correct[in(xx + 1, yy) / 16][in(xx, yy) / 16]++;
+        }
+    }
+    for (int j = 0; j < 16; j++) {
+        for (int i = 0; i < 16; i++) {
+            if (result(i, j) != correct[j][i]) {
+                printf("hist(%d, %d) = %d instead of %d\n", i, j, result(i, j), correct[j][i]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool test_scalar_sum(int num_tasks) {
+    Buffer<int> in(97, 53);
+    in.for_each_element([&](int x, int y) { in(x, y) = (x * 13 + y * 7) % 101 - 50; });
+
+    Func sum("sum");
+    RDom r(in);
+    sum() = 0;
+    sum() += in(r.x, r.y);
+    sum.update().privatize(r.y, num_tasks);
+
+    Buffer<int> result = sum.realize();
+
+    int correct = 0;
+    in.for_each_value([&](int v) { correct += v; });
+    if (result() != correct) {
+        printf("sum() = %d instead of %d with %d tasks\n", result(), correct, num_tasks);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    // Including a number of tasks that doesn't divide the rows, and more
+    // tasks than rows.
+    for (int num_tasks : {1, 4, 7, 100}) {
+        for (int vector_width : {1, 8}) {
+            if (!test_histogram(num_tasks, vector_width)) {
+                return 1;
+            }
+        }
+    }
+
+    if (!test_tuple_histogram()) {
+        return 1;
+    }
+
+    if (!test_2d_histogram()) {
+        return 1;
+    }
+
+    for (int num_tasks : {1, 6}) {
+        if (!test_scalar_sum(num_tasks)) {
+            return 1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+namespace {
+
+// Counts the loops of each Func, and the allocations of constant size.
+class CountLoopsAndAllocations : public IRMutator {
+    using IRMutator::visit;
+
+    Stmt visit(const For *op) override {
+        loops[op->name.substr(0, op->name.find('.'))]++;
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const Allocate *op) override {
+        if (op->constant_allocation_size() != 0) {
+            constant_allocations.insert(op->name);
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    std::map<std::string, int> loops;
+    std::set<std::string> constant_allocations;
+};
+
+void write_profile(const std::string &filename, const char *contents) {
+    FILE *f = fopen(filename.c_str(), "w");
+    fputs(contents, f);
+    fclose(f);
+}
+
+Callable compile(const Target &t, CountLoopsAndAllocations &counter) {
+    ImageParam input(Float(32), 2, "input");
+    Func clamped = BoundaryConditions::repeat_edge(input);
+    Func cold("pgo_cold"), tmp("pgo_tmp"), out("pgo_out");
+    Var x("x"), y("y");
+
+    cold(x, y) = clamped(x - 1, y) + clamped(x + 1, y);
+    tmp(x, y) = cold(x, y) * 2 + cold(x + 1, y);
+    out(x, y) = tmp(x - 1, y) + tmp(x + 1, y);
+
+    cold.compute_root().vectorize(x, 8);
+    tmp.compute_at(out, y).vectorize(x, 8);
+    out.vectorize(x, 8);
+
+    out.add_custom_lowering_pass(&counter, []() {});
+    return out.compile_to_callable({input}, t);
+}
+
+bool check(Callable &c, int w, int h) {
+    Buffer<float> in(w, h), out(w, h);
+    in.for_each_element([&](int x, int y) { in(x, y) = (float)((x * 7 + y * 3) % 17); });
+    if (c(in, out) != 0) {
+        return false;
+    }
+    auto clamped = [&](int x, int y) {
+        return in(std::min(std::max(x, 0), w - 1), y);
+    };
+    auto cold = [&](int x, int y) {
+        return clamped(x - 1, y) + clamped(x + 1, y);
+    };
+    auto tmp = [&](int x, int y) {
+        return cold(x, y) * 2 + cold(x + 1, y);
+    };
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            float correct = tmp(x - 1, y) + tmp(x + 1, y);
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    printf("[SKIP] Windows does not have a working setenv\n");
+#else
+    Target t = get_jit_target_from_environment();
+    TemporaryFile profile("profile_guided_optimization", "txt");
+
+    CountLoopsAndAllocations baseline;
+    Callable c = compile(t, baseline);
+    if (!check(c, 100, 10)) {
+        return 1;
+    }
+
+    // A profile in which pgo_cold took 0.1% of the time, and no Func
+    // allocated any memory.
+    write_profile(profile.pathname(),
+                  "pipeline 10 1000 1000000000 pgo_out\n"
+                  "func 0 0 0 0 overhead\n"
+                  "func 1000000 0 0 0 pgo_cold\n"
+                  "func 500000000 0 0 0 pgo_tmp\n"
+                  "func 499000000 0 0 0 pgo_out\n");
+    setenv("HL_PGO_PROFILE", profile.pathname().c_str(), 1);
+
+    CountLoopsAndAllocations guided;
+    c = compile(t, guided);
+    if (!check(c, 100, 10)) {
+        return 1;
+    }
+
+    // The loops of the cold Func should no longer be partitioned, and
+    // the others should be unchanged.
+    if (guided.loops["pgo_cold"] >= baseline.loops["pgo_cold"]) {
+        printf("Expected fewer loops for pgo_cold: %d vs %d\n",
+               guided.loops["pgo_cold"], baseline.loops["pgo_cold"]);
+        return 1;
+    }
+    for (const char *f : {"pgo_tmp", "pgo_out"}) {
+        if (guided.loops[f] != baseline.loops[f]) {
+            printf("Expected the same number of loops for %s: %d vs %d\n",
+                   f, guided.loops[f], baseline.loops[f]);
+            return 1;
+        }
+    }
+
+    // A profile with too few samples to say anything about time, in
+    // which pgo_tmp was allocated many times and never used more than
+    // 4096 bytes.
+    write_profile(profile.pathname(),
+                  "pipeline 10 10 1000000000 pgo_out\n"
+                  "func 1000000 0 0 0 pgo_cold\n"
+                  "func 500000000 1000 4096 0 pgo_tmp\n"
+                  "func 499000000 0 0 0 pgo_out\n");
+
+    CountLoopsAndAllocations stack_allocated;
+    c = compile(t, stack_allocated);
+    if (baseline.constant_allocations.count("pgo_tmp.stack") ||
+        !stack_allocated.constant_allocations.count("pgo_tmp.stack")) {
+        printf("Expected a constant-sized allocation of pgo_tmp only when guided by the profile\n");
+        return 1;
+    }
+    // The code that uses the allocation shouldn't be duplicated.
+    for (const char *f : {"pgo_tmp", "pgo_out"}) {
+        if (stack_allocated.loops[f] != baseline.loops[f]) {
+            printf("Expected the same number of loops for %s with a stack allocation: %d vs %d\n",
+                   f, stack_allocated.loops[f], baseline.loops[f]);
+            return 1;
+        }
+    }
+    if (stack_allocated.loops["pgo_cold"] != baseline.loops["pgo_cold"]) {
+        printf("Loop partitioning should ignore a profile with too few samples\n");
+        return 1;
+    }
+
+    // Rows small enough to use the stack, and rows that need the heap.
+    if (!check(c, 100, 10) || !check(c, 2000, 10)) {
+        return 1;
+    }
+
+    printf("Success!\n");
+#endif
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    const int W = 317, H = 203;
+
+    ImageParam input(Int(32), 2, "input");
+    Var x("x"), y("y");
+    Func f("f");
+    f(x, y) = input(x - 1, y) + input(x + 1, y) + input(x, y + 2);
+
+    Pipeline p(f);
+
+    int inputs_requested = 0, tiles_produced = 0;
+    size_t max_input_elems = 0;
+    Buffer<int> result(W, H);
+
+    p.realize_streaming(
+        {W, H}, {64, 32},
+        [&](const std::string &name, Buffer<> &region) {
+            if (name != "input") {
+                printf("Unexpected input name: %s\n", name.c_str());
+                exit(1);
+            }
+            Buffer<int> in = region;
+            in.for_each_element([&](int x, int y) {
+                in(x, y) = x * 3 + y * 7;
+            });
+            max_input_elems = std::max(max_input_elems, in.number_of_elements());
+            inputs_requested++;
+        },
+        [&](Realization &tile) {
+            Buffer<int> t = tile[0];
+            t.for_each_element([&](int x, int y) {
+                result(x, y) = t(x, y);
+            });
+            tiles_produced++;
+        });
+
+    const int expected_tiles = ((W + 63) / 64) * ((H + 31) / 32);
+    if (tiles_produced != expected_tiles || inputs_requested != expected_tiles) {
+        printf("Expected %d tiles, got %d outputs and %d inputs\n",
+               expected_tiles, tiles_produced, inputs_requested);
+        return 1;
+    }
+
+    // Each input region should only cover one tile plus its footprint.
+    if (max_input_elems > (size_t)(64 + 2) * (32 + 2)) {
+        printf("Input region too large: %d elements\n", (int)max_input_elems);
+        return 1;
+    }
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            int correct = ((x - 1) * 3 + y * 7) + ((x + 1) * 3 + y * 7) + (x * 3 + (y + 2) * 7);
+            if (result(x, y) != correct) {
+                printf("result(%d, %d) = %d instead of %d\n", x, y, result(x, y), correct);
+                return 1;
+            }
+        }
+    }
+
+    // The input should be unbound again afterwards.
+    if (input.get().defined()) {
+        printf("input was left bound after realize_streaming\n");
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "Halide.h"
+#include "halide_test_dirs.h"
+
+#include <cstdio>
+
+using namespace Halide;
+
+// Serialize a pipeline with embedded buffers, one small enough to stay
+// inline and one stored in a separate data file, then check that loading
+// it memory-mapped gives the same results as the original and as a copied
+// load.
+int main(int argc, char **argv) {
+    const std::string dir = Internal::get_test_tmp_dir();
+    const std::string pipeline_file = dir + "serialization_mapped.hlpipe";
+    const std::string data_file = "serialization_mapped.weights";
+    Internal::ensure_no_file_exists(pipeline_file);
+    Internal::ensure_no_file_exists(dir + data_file);
+
+    Buffer<uint16_t> lut(256, "lut");
+    lut.for_each_element([&](int i) { lut(i) = (uint16_t)(i * i / 7); });
+    // Interleaved, to check that the payload is used in the right stride order.
+    Buffer<float> weights = Buffer<float>::make_interleaved(3, 5, 4, "weights");
+    weights.for_each_element([&](int x, int y, int c) { weights(x, y, c) = x + y * 0.5f - c * 0.25f; });
+
+    Var x("x"), y("y"), c("c");
+    ImageParam input(UInt(8), 2, "input");
+    Func out("out");
+    Expr v = lut(input(x, y));
+    out(x, y, c) = cast<float>(v) * weights(x % 3, y % 5, c) + cast<float>(lut(c));
+
+    Buffer<uint8_t> in(37, 23);
+    in.for_each_element([&](int x, int y) { in(x, y) = (uint8_t)(x * 13 + y * 29); });
+    input.set(in);
+    Buffer<float> expected = out.realize({in.width(), in.height(), 4});
+
+    // The lookup table takes 512 bytes, the weights 240.
+    serialize_pipeline(Pipeline(out), pipeline_file, data_file, 256);
+    Internal::assert_file_exists(pipeline_file);
+    Internal::assert_file_exists(dir + data_file);
+
+    std::map<std::string, Parameter> params = deserialize_parameters(pipeline_file);
+    params.at("input").set_buffer(in);
+
+    // The buffers of the mapped pipeline keep the files mapped, so they're
+    // still valid once nothing but the pipeline refers to them.
+    Pipeline mapped = deserialize_pipeline_mapped(pipeline_file, params);
+    Buffer<float> mapped_result = mapped.realize({in.width(), in.height(), 4});
+
+    Pipeline copied = deserialize_pipeline(pipeline_file, params);
+    Buffer<float> copied_result = copied.realize({in.width(), in.height(), 4});
+
+    int errors = 0;
+    expected.for_each_element([&](int x, int y, int c) {
+        if (mapped_result(x, y, c) != expected(x, y, c) ||
+            copied_result(x, y, c) != expected(x, y, c)) {
+            if (errors++ < 10) {
+                printf("result(%d, %d, %d) = %f (mapped), %f (copied) instead of %f\n",
+                       x, y, c, mapped_result(x, y, c), copied_result(x, y, c), expected(x, y, c));
+            }
+        }
+    });
+    if (errors) {
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
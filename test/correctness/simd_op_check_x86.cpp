@@ -35,6 +35,7 @@ public:
         use_sse42 = use_avx;
 
         use_avx512_vnni = target.has_feature(Target::AVX512_Zen4);
+        use_avx512_fp16 = target.has_feature(Target::AVX512_SapphireRapids);
         use_avx_vnni = target.has_feature(Target::AVXVNNI);
     }
 
@@ -683,11 +684,21 @@ public:
                 check("vpdpbusds*xmm", 4, saturating_sum(i32(in_i8(4 * x + r)) * in_u8(4 * x + r + 32)));
             }
         }
+        if (use_avx512_fp16) {
+            // Native float16 arithmetic, instead of widening to float32.
+            check("vaddph*zmm", 32, f16_1 + f16_2);
+            check("vaddph*ymm", 16, f16_1 + f16_2);
+            check("vaddph*xmm", 8, f16_1 + f16_2);
+            check("vsubph*zmm", 32, f16_1 - f16_2);
+            check("vmulph*zmm", 32, f16_1 * f16_2);
+            check("vdivph*zmm", 32, f16_1 / f16_2);
+        }
     }
 
 private:
     bool use_avx2{false};
     bool use_avx512{false};
+    bool use_avx512_fp16{false};
     bool use_avx512_vnni{false};
     bool use_avx_vnni{false};
     bool use_avx{false};
@@ -2,6 +2,8 @@
 #include "halide_test_dirs.h"
 
 #include <cstdio>
+#include <fstream>
+#include <sstream>
 
 using namespace Halide;
 
@@ -44,6 +46,31 @@ int main() {
     tuple_func.compile_to_lowered_stmt(result_file_3, {}, Halide::HTML);
     Internal::assert_file_exists(result_file_3);
 
+#ifndef _WIN32
+    // Overlay a profile in which gradient_fast took 90% of the time.
+    std::string profile_file = Internal::get_test_tmp_dir() + "stmt_to_html_profile.txt";
+    {
+        std::ofstream profile(profile_file);
+        profile << "pipeline 10 1000 1000000000 gradient_fast\n"
+                << "func 100000000 0 0 0 overhead\n"
+                << "func 900000000 0 0 0 gradient_fast\n";
+    }
+    setenv("HL_STMT_HTML_PROFILE", profile_file.c_str(), 1);
+    std::string result_file_4 = Internal::get_test_tmp_dir() + "stmt_to_html_dump_4.html";
+    Internal::ensure_no_file_exists(result_file_4);
+    gradient_fast.compile_to_lowered_stmt(result_file_4, {}, Halide::HTML);
+    Internal::assert_file_exists(result_file_4);
+    unsetenv("HL_STMT_HTML_PROFILE");
+
+    std::ifstream html(result_file_4);
+    std::stringstream contents;
+    contents << html.rdbuf();
+    if (contents.str().find("profile-badge tooltip-parent ProfileHeat9'>90.0%") == std::string::npos) {
+        printf("The profile was not overlaid on the stmt html\n");
+        return 1;
+    }
+#endif
+
     printf("Success!\n");
     return 0;
 }
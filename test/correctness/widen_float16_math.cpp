@@ -0,0 +1,72 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+namespace {
+
+template<typename T>
+bool test(const Target &base) {
+    const int size = 1024;
+    Buffer<T> a(size), b(size), c(size);
+    for (int i = 0; i < size; i++) {
+        a(i) = T(1.0f + i / 97.0f);
+        b(i) = T(0.3f + i / 331.0f);
+        c(i) = T(-2.0f + i / 53.0f);
+    }
+
+    // The same chain of arithmetic, computed with and without rounding
+    // the intermediates.
+    Buffer<T> rounded(size), widened(size);
+    for (int i = 0; i < size; i++) {
+        rounded(i) = (a(i) * b(i) + c(i)) * a(i) - b(i);
+        widened(i) = T(((float)a(i) * (float)b(i) + (float)c(i)) * (float)a(i) - (float)b(i));
+    }
+
+    Target t = base.with_feature(Target::WidenFloat16Math);
+    const bool native = Internal::float16_math_is_native(type_of<T>(), t);
+
+    ImageParam in_a(type_of<T>(), 1), in_b(type_of<T>(), 1), in_c(type_of<T>(), 1);
+    Func f;
+    Var x;
+    f(x) = (in_a(x) * in_b(x) + in_c(x)) * in_a(x) - in_b(x);
+    f.vectorize(x, 8);
+
+    Buffer<T> out(size);
+    Callable callable = f.compile_to_callable({in_a, in_b, in_c}, t);
+    if (callable(a, b, c, out) != 0) {
+        return false;
+    }
+
+    // The target's native float16 arithmetic rounds every operation,
+    // so the feature does nothing there.
+    const Buffer<T> &correct = native ? rounded : widened;
+    int differences = 0;
+    for (int i = 0; i < size; i++) {
+        if (out(i).to_bits() != correct(i).to_bits()) {
+            printf("out(%d) = %f instead of %f\n", i, (float)out(i), (float)correct(i));
+            return false;
+        }
+        differences += rounded(i).to_bits() != widened(i).to_bits();
+    }
+
+    // Make sure the test distinguishes the two.
+    if (differences == 0) {
+        printf("Rounding the intermediates made no difference\n");
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment();
+
+    if (!test<float16_t>(t) || !test<bfloat16_t>(t)) {
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,25 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Func f("f");
+    Var x("x"), y("y"), t("t");
+    f(x, y) = x + y;
+
+    // Both extents are larger than the biggest block a space-filling
+    // curve can cover, which should fail when the pipeline runs.
+    f.fuse(x, y, t, FuseOrder::Hilbert);
+
+    // Alias every row of the output to the same storage, so the test
+    // doesn't need gigabytes of memory.
+    const int size = 40000;
+    std::vector<int> storage(size);
+    halide_dimension_t shape[] = {{0, size, 1}, {0, size, 0}};
+    Buffer<int> out(storage.data(), 2, shape);
+    f.realize(out);
+
+    printf("Success!\n");
+    return 0;
+}
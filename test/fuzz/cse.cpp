@@ -11,6 +11,30 @@ using namespace Halide::Internal;
 using std::pair;
 using std::vector;
 
+// Rebuild an Expr from scratch, so that the copy is structurally equal
+// to the original but shares no nodes with it. CSE has to find equal
+// subexpressions like these by their structure, not their identity.
+class DeepCopy : public IRMutator {
+    using IRMutator::visit;
+
+    Expr visit(const IntImm *op) override {
+        return IntImm::make(op->type, op->value);
+    }
+
+    Expr visit(const Variable *op) override {
+        return Variable::make(op->type, op->name);
+    }
+};
+
+int count_lets(Expr e) {
+    int count = 0;
+    while (const Let *let = e.as<Let>()) {
+        count++;
+        e = let->body;
+    }
+    return count;
+}
+
 // Note that this deliberately uses int16 values everywhere --
 // *not* int32 -- because we want to test CSE, not the simplifier's
 // overflow behavior, and using int32 can end up with results
@@ -45,6 +69,24 @@ Expr random_expr(FuzzedDataProvider &fdp, int depth, vector<pair<Expr, int>> &ex
             next += random_expr(fdp, depth - 1, exprs);
             return next;
         },
+        [&]() {
+            Expr next = random_expr(fdp, depth - 1, exprs);
+            next *= random_expr(fdp, depth - 1, exprs);
+            return next;
+        },
+        [&]() {
+            Expr a = random_expr(fdp, depth - 1, exprs);
+            Expr b = random_expr(fdp, depth - 1, exprs);
+            return min(a, b);
+        },
+        [&]() {
+            Expr a = random_expr(fdp, depth - 1, exprs);
+            Expr b = random_expr(fdp, depth - 1, exprs);
+            return max(a, b);
+        },
+        [&]() {
+            return DeepCopy().mutate(random_expr(fdp, depth - 1, exprs));
+        },
         [&]() {
             Expr a = random_expr(fdp, depth - 2, exprs);
             Expr b = random_expr(fdp, depth - 2, exprs);
@@ -83,6 +125,10 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
 
     Expr csed = common_subexpression_elimination(orig);
 
+    // CSE should find every common subexpression the first time.
+    Expr recsed = common_subexpression_elimination(csed);
+    assert(count_lets(recsed) == count_lets(csed));
+
     Expr check = (orig == csed);
     check = Let::make("x", i16(1), check);
     check = Let::make("y", i16(2), check);
@@ -49,6 +49,37 @@ int main(int argc, char **argv) {
     }
     verify(output, arg0, arg1);
 
+    // verify that the _batch entry point runs each set of args
+    // into its own output, and reports a status for each.
+    const int kBatchSize = 4;
+    Buffer<int32_t, 3> outputs[kBatchSize];
+    float batch_f1[kBatchSize], batch_f2[kBatchSize];
+    void *batch_args[kBatchSize][3];
+    void **batch_argvs[kBatchSize];
+    int exit_statuses[kBatchSize];
+    for (int i = 0; i < kBatchSize; i++) {
+        outputs[i] = Buffer<int32_t, 3>(kSize, kSize, 3);
+        batch_f1[i] = 1.5f + i;
+        batch_f2[i] = 2.25f * (i + 1);
+        batch_args[i][0] = &batch_f1[i];
+        batch_args[i][1] = &batch_f2[i];
+        batch_args[i][2] = (halide_buffer_t *)outputs[i];
+        batch_argvs[i] = batch_args[i];
+        exit_statuses[i] = -1;
+    }
+    result = argvcall_batch(nullptr, kBatchSize, batch_argvs, exit_statuses);
+    if (result != 0) {
+        fprintf(stderr, "Result: %d\n", result);
+        exit(1);
+    }
+    for (int i = 0; i < kBatchSize; i++) {
+        if (exit_statuses[i] != 0) {
+            fprintf(stderr, "Exit status %d: %d\n", i, exit_statuses[i]);
+            exit(1);
+        }
+        verify(outputs[i], batch_f1[i], batch_f2[i]);
+    }
+
     printf("Success!\n");
     return 0;
 }
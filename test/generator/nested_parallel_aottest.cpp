@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HalideBuffer.h"
+#include "nested_parallel.h"
+
+using namespace Halide::Runtime;
+
+int main(int argc, char **argv) {
+    const int width = 64, height = 32, depth = 8;
+
+    Buffer<int32_t, 3> input(width, height, depth);
+    input.for_each_element([&](int x, int y, int z) {
+        input(x, y, z) = x * 3 + y * 5 + z * 7;
+    });
+
+    Buffer<int32_t, 3> output(width, height, depth);
+    // Run it a few times to shake out races between the tasks.
+    for (int i = 0; i < 10; i++) {
+        output.fill(0);
+        int result = nested_parallel(input, output);
+        if (result != 0) {
+            printf("nested_parallel failed: %d\n", result);
+            return 1;
+        }
+
+        output.for_each_element([&](int x, int y, int z) {
+            auto in = [&](int xx) {
+                return input(std::min(std::max(xx, 0), width - 1), y, z);
+            };
+            const int correct = in(x - 1) * 2 + in(x + 1) * 2 + in(x) + 3;
+            if (output(x, y, z) != correct) {
+                printf("output(%d, %d, %d) = %d instead of %d\n",
+                       x, y, z, output(x, y, z), correct);
+                exit(1);
+            }
+        });
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,37 @@
+#include "Halide.h"
+
+namespace {
+
+// Parallel loops inside parallel loops, and async producers inside those,
+// to check that the C++ backend emits the same nested tasks as the LLVM
+// backends.
+class NestedParallel : public Halide::Generator<NestedParallel> {
+public:
+    Input<Buffer<int32_t, 3>> input{"input"};
+    Output<Buffer<int32_t, 3>> output{"output"};
+
+    void generate() {
+        Var x("x"), y("y"), z("z");
+
+        Func clamped = Halide::BoundaryConditions::repeat_edge(input);
+
+        Func a("a"), b("b"), c("c");
+        a(x, y, z) = clamped(x, y, z) * 2;
+        b(x, y, z) = a(x - 1, y, z) + a(x + 1, y, z);
+        c(x, y, z) = clamped(x, y, z) + 3;
+        output(x, y, z) = b(x, y, z) + c(x, y, z);
+
+        output.parallel(z).parallel(y);
+        // A parallel producer that runs concurrently with the nested
+        // parallel loop that consumes it.
+        a.compute_at(output, z).parallel(y).async();
+        // Two async producers per iteration of the inner parallel loop,
+        // which fork into separate tasks.
+        b.compute_at(output, y).async();
+        c.compute_at(output, y).async();
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(NestedParallel, nested_parallel)
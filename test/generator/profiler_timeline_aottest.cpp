@@ -0,0 +1,179 @@
+#include <fstream>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+#include "profiler_timeline.h"
+
+using namespace Halide::Runtime;
+
+namespace {
+
+// Pull the value of a field out of one line of the trace.
+std::string field(const std::string &line, const std::string &name) {
+    std::string key = "\"" + name + "\":";
+    size_t start = line.find(key);
+    if (start == std::string::npos) {
+        return "";
+    }
+    start += key.size();
+    size_t end = line.find_first_of(",}", start);
+    std::string value = line.substr(start, end - start);
+    if (!value.empty() && value[0] == '"') {
+        value = value.substr(1, value.size() - 2);
+    }
+    return value;
+}
+
+// Write the timeline, check that it's a well-formed Chrome trace, and
+// count the begin events for each name. Returns false on failure.
+bool check_timeline(const char *filename, std::map<std::string, int> &begins, int *num_threads) {
+    if (halide_profiler_write_timeline(nullptr, filename) != 0) {
+        printf("Failed to write the timeline\n");
+        return false;
+    }
+
+    std::ifstream f(filename);
+    std::string line;
+    if (!std::getline(f, line) || line != "{\"traceEvents\":[") {
+        printf("Bad trace header: %s\n", line.c_str());
+        return false;
+    }
+
+    std::map<std::string, int> depth;
+    std::map<std::string, double> last_ts;
+    bool ended = false;
+    while (std::getline(f, line)) {
+        if (line == "]}") {
+            ended = true;
+            break;
+        }
+        if (line.empty()) {
+            continue;
+        }
+        if (line[0] != '{' || line.find_last_of('}') == std::string::npos) {
+            printf("Malformed event: %s\n", line.c_str());
+            return false;
+        }
+        for (const char *key : {"name", "cat", "ph", "ts", "pid", "tid"}) {
+            if (field(line, key).empty()) {
+                printf("Event is missing \"%s\": %s\n", key, line.c_str());
+                return false;
+            }
+        }
+        std::string tid = field(line, "tid");
+        std::string name = field(line, "name");
+        std::string ph = field(line, "ph");
+
+        // Each thread's events are in the order they happened.
+        double ts = atof(field(line, "ts").c_str());
+        if (last_ts.count(tid) && ts < last_ts[tid]) {
+            printf("Event is out of order: %s\n", line.c_str());
+            return false;
+        }
+        last_ts[tid] = ts;
+
+        // Every begin event must have a matching end event on the same thread.
+        if (ph == "B") {
+            depth[tid]++;
+            begins[name]++;
+            if (name == "task" && (field(line, "min").empty() || field(line, "extent").empty())) {
+                printf("Task event is missing its loop bounds: %s\n", line.c_str());
+                return false;
+            }
+        } else if (ph != "E") {
+            printf("Unexpected event type: %s\n", line.c_str());
+            return false;
+        } else if (--depth[tid] < 0) {
+            printf("Unmatched end event: %s\n", line.c_str());
+            return false;
+        }
+    }
+    if (!ended) {
+        printf("The trace isn't terminated\n");
+        return false;
+    }
+    for (const auto &it : depth) {
+        if (it.second != 0) {
+            printf("Thread %s has %d unmatched begin events\n", it.first.c_str(), it.second);
+            return false;
+        }
+    }
+    *num_threads = (int)depth.size();
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    halide_set_num_threads(4);
+
+    Buffer<float, 2> output(1024, 256);
+    for (int i = 0; i < 10; i++) {
+        int result = profiler_timeline(output);
+        if (result != 0) {
+            printf("Pipeline failed: %d\n", result);
+            return 1;
+        }
+    }
+
+    const char *filename = "profiler_timeline.json";
+    std::map<std::string, int> begins;
+    int num_threads = 0;
+    if (!check_timeline(filename, begins, &num_threads)) {
+        return 1;
+    }
+
+    // One task and one producer of each Func per strip of 16 scanlines.
+    const int strips = 10 * output.height() / 16;
+    for (const char *name : {"producer", "consumer", "output", "task"}) {
+        if (begins[name] < (name[0] == 'o' ? 10 : strips)) {
+            printf("Only %d events for %s\n", begins[name], name);
+            return 1;
+        }
+    }
+    printf("Saw events from %d threads\n", num_threads);
+
+    // The timeline wraps the thread pool's task handler until the
+    // profiler is reset, which puts the original back and drops the
+    // events.
+    halide_do_task_t wrapped = halide_set_custom_do_task(halide_default_do_task);
+    halide_set_custom_do_task(wrapped);
+    if (wrapped == halide_default_do_task) {
+        printf("The timeline didn't wrap the task handler\n");
+        return 1;
+    }
+    halide_profiler_reset();
+    if (halide_set_custom_do_task(halide_default_do_task) != halide_default_do_task) {
+        printf("Resetting the profiler didn't restore the task handler\n");
+        return 1;
+    }
+    begins.clear();
+    if (!check_timeline(filename, begins, &num_threads)) {
+        return 1;
+    }
+    if (!begins.empty()) {
+        printf("Resetting the profiler didn't drop the events\n");
+        return 1;
+    }
+
+    // Pipelines run after a reset are recorded again.
+    if (profiler_timeline(output) != 0) {
+        printf("Pipeline failed after reset\n");
+        return 1;
+    }
+    if (!check_timeline(filename, begins, &num_threads)) {
+        return 1;
+    }
+    if (begins["output"] < 1 || begins["output"] >= 10 || begins["task"] < output.height() / 16) {
+        printf("Expected just the run after the reset, got %d output and %d task events\n",
+               begins["output"], begins["task"]);
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,27 @@
+#include "Halide.h"
+
+namespace {
+
+class ProfilerTimeline : public Halide::Generator<ProfilerTimeline> {
+public:
+    Output<Buffer<float, 2>> output{"output"};
+
+    void generate() {
+        Var x("x"), y("y"), yo("yo"), yi("yi");
+
+        Func producer("producer"), consumer("consumer");
+        producer(x, y) = sin(cast<float>(x * y));
+        consumer(x, y) = producer(x, y) + producer(x + 1, y);
+        output(x, y) = consumer(x, y) * 2;
+
+        // An async producer running alongside its consumer, inside a
+        // parallel loop.
+        output.split(y, yo, yi, 16).parallel(yo);
+        consumer.compute_at(output, yo);
+        producer.compute_at(output, yo).async();
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(ProfilerTimeline, profiler_timeline)
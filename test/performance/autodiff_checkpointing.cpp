@@ -0,0 +1,126 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+namespace {
+
+size_t current_bytes = 0, peak_bytes = 0;
+
+void *my_malloc(JITUserContext *user_context, size_t x) {
+    current_bytes += x;
+    peak_bytes = std::max(peak_bytes, current_bytes);
+    void *orig = malloc(x + 64);
+    void *ptr = (void *)((((size_t)orig + 64) >> 5) << 5);
+    ((void **)ptr)[-1] = orig;
+    ((size_t *)ptr)[-2] = x;
+    return ptr;
+}
+
+void my_free(JITUserContext *user_context, void *ptr) {
+    current_bytes -= ((size_t *)ptr)[-2];
+    free(((void **)ptr)[-1]);
+}
+
+const int size = 512;
+const int num_layers = 4;
+
+// Compute the gradient of the loss of a stack of 3x3 convolutions with
+// respect to its input, storing as many of the layers as fit in the
+// budget. Returns the runtime, and the peak memory use in peak.
+double time_gradient(const Target &target, const Buffer<float> &input, int64_t memory_budget,
+                     Buffer<float> &out, size_t *peak) {
+    Var x("x"), y("y");
+    std::vector<Func> layers;
+    layers.push_back(BoundaryConditions::repeat_edge(input));
+    for (int i = 0; i < num_layers; i++) {
+        const Func &prev = layers.back();
+        Func layer("layer" + std::to_string(i));
+        Expr e = 0.f;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                e += prev(x + dx, y + dy) * (0.1f + 0.01f * (i + dx * 3 + dy));
+            }
+        }
+        layer(x, y) = tanh(e);
+        layers.push_back(layer);
+    }
+
+    RDom r(0, size, 0, size);
+    Func loss("loss");
+    loss() = 0.f;
+    loss() += layers.back()(r.x, r.y) * layers.back()(r.x, r.y);
+
+    std::vector<Func> stored = checkpoint_adjoints(loss, {}, memory_budget);
+
+    Derivative d = propagate_adjoints(loss);
+    for (const Func &layer : layers) {
+        Func adjoint = d(layer);
+        adjoint.compute_root().vectorize(adjoint.args()[0], target.natural_vector_size<float>());
+    }
+
+    Pipeline p(d(input));
+    p.jit_handlers().custom_malloc = my_malloc;
+    p.jit_handlers().custom_free = my_free;
+    p.compile_jit(target);
+
+    peak_bytes = 0;
+    p.realize(out);
+    *peak = peak_bytes;
+    printf("Budget %lld bytes: stored %d of %d layers\n",
+           (long long)memory_budget, (int)stored.size(), (int)layers.size());
+
+    return benchmark([&]() {
+        p.realize(out);
+    });
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    Buffer<float> input(size, size);
+    input.for_each_element([&](int x, int y) {
+        input(x, y) = ((x * 17 + y * 31) % 64) / 64.0f - 0.5f;
+    });
+
+    const int64_t layer_bytes = (int64_t)(size + 2 * num_layers) * (size + 2 * num_layers) * sizeof(float);
+    Buffer<float> stored_out(size, size), budgeted_out(size, size);
+    size_t stored_peak = 0, budgeted_peak = 0;
+    double stored_time = time_gradient(target, input, (num_layers + 1) * layer_bytes, stored_out, &stored_peak);
+    double budgeted_time = time_gradient(target, input, 2 * layer_bytes, budgeted_out, &budgeted_peak);
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            float a = stored_out(x, y), b = budgeted_out(x, y);
+            if (std::abs(a - b) > 1e-4f * std::max(1.f, std::abs(a))) {
+                printf("budgeted_out(%d, %d) = %f instead of %f\n", x, y, b, a);
+                return 1;
+            }
+        }
+    }
+
+    printf("Everything stored: %f ms, peak %f MB\n"
+           "Two layers stored: %f ms, peak %f MB\n",
+           stored_time * 1e3, stored_peak / (1024.0 * 1024.0),
+           budgeted_time * 1e3, budgeted_peak / (1024.0 * 1024.0));
+
+    // Recomputing layers has to save the memory they would have taken.
+    if (budgeted_peak >= stored_peak) {
+        printf("Checkpointing didn't reduce the peak memory use\n");
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Internal;
+using namespace Halide::Tools;
+
+namespace {
+
+// A fully-inlined 1D stencil, built as a tree with no sharing, like the
+// Exprs that inlining an unrolled filter produces. The tree has 3^depth
+// leaves, but only O(depth^2) distinct subexpressions.
+Expr stencil(int depth, int x) {
+    if (depth == 0) {
+        return Variable::make(Int(32), "in") * (x + 3);
+    }
+    return (stencil(depth - 1, x - 1) +
+            stencil(depth - 1, x) * 2 +
+            stencil(depth - 1, x + 1)) /
+           4;
+}
+
+int count_lets(Expr e) {
+    int count = 0;
+    while (const Let *let = e.as<Let>()) {
+        count++;
+        e = let->body;
+    }
+    return count;
+}
+
+double time_cse(int depth) {
+    Expr e = stencil(depth, 0);
+    Expr result;
+    double t = benchmark(5, 1, [&]() {
+        result = common_subexpression_elimination(e);
+    });
+    printf("CSE of depth %d stencil: %f ms, %d lets\n", depth, t * 1e3, count_lets(result));
+    return t;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    // Warm up.
+    time_cse(6);
+
+    // Going two levels deeper makes the tree nine times bigger. CSE
+    // should take roughly nine times longer, not eighty-one.
+    double small_time = time_cse(8);
+    double large_time = time_cse(10);
+    if (large_time > small_time * 30) {
+        printf("CSE time grew superlinearly with the size of the Expr\n");
+        return 1;
+    }
+
+    // The same thing as a pipeline, with every stage inlined into a
+    // 2D output, so that lowering has to CSE a huge Expr.
+    ImageParam input(Int(32), 2, "input");
+    Var x("x"), y("y");
+    Func f = BoundaryConditions::repeat_edge(input);
+    for (int i = 0; i < 7; i++) {
+        Func g("blur_" + std::to_string(i));
+        if (i % 2 == 0) {
+            g(x, y) = (f(x - 1, y) + f(x, y) * 2 + f(x + 1, y)) / 4;
+        } else {
+            g(x, y) = (f(x, y - 1) + f(x, y) * 2 + f(x, y + 1)) / 4;
+        }
+        f = g;
+    }
+    f.vectorize(x, target.natural_vector_size<int>());
+    double compile_time = benchmark(3, 1, [&]() {
+        Pipeline(f).compile_to_module({input}, "inlined_blur", target);
+    });
+    printf("Lowering a pipeline with seven inlined stages: %f ms\n", compile_time * 1e3);
+
+    printf("Success!\n");
+    return 0;
+}
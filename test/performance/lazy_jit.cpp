@@ -0,0 +1,110 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+
+#include <cmath>
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+namespace {
+
+const int num_specializations = 32;
+
+struct Timings {
+    double compile, first_call, second_call;
+};
+
+// A pipeline with one specialization per value of a parameter. Each
+// specialization has its own vectorized loop nest, but a call only ever
+// runs one of them. With a parallel loop, each loop nest is in a closure
+// anyway; without one, lazy compilation outlines the specializations.
+bool run(const Target &target, bool parallel, Timings &timings) {
+    Param<int> p;
+    ImageParam input(Float(32), 2);
+    Func f("f"), g("g");
+    Var x("x"), y("y"), xi("xi"), yi("yi");
+
+    g(x, y) = sqrt(input(x, y) * input(x, y) + 1.0f);
+    f(x, y) = g(x, y) * p + g(x + 1, y) - g(x, y + 1) / (p + 1);
+
+    const int vec = target.natural_vector_size<float>();
+    f.tile(x, y, xi, yi, vec * 4, 8).vectorize(xi, vec).unroll(yi);
+    if (parallel) {
+        f.parallel(y);
+    }
+    g.compute_at(f, x).vectorize(x, vec);
+    for (int i = 0; i < num_specializations; i++) {
+        f.specialize(p == i);
+    }
+
+    Buffer<float> in(1025, 1025), out(1024, 1024);
+    in.fill(2.0f);
+
+    auto start = benchmark_now();
+    Callable c = f.compile_to_callable({p, input}, target);
+    auto compiled = benchmark_now();
+    if (c(3, in, out) != 0) {
+        return false;
+    }
+    auto first = benchmark_now();
+    if (c(5, in, out) != 0) {
+        return false;
+    }
+    auto second = benchmark_now();
+
+    timings.compile = benchmark_duration_seconds(start, compiled);
+    timings.first_call = benchmark_duration_seconds(compiled, first);
+    timings.second_call = benchmark_duration_seconds(first, second);
+
+    const float g_val = std::sqrt(2.0f * 2.0f + 1.0f);
+    const float correct = g_val * 5 + g_val - g_val / 6;
+    for (int yy = 0; yy < out.height(); yy++) {
+        for (int xx = 0; xx < out.width(); xx++) {
+            if (std::abs(out(xx, yy) - correct) > 1e-4f) {
+                printf("out(%d, %d) = %f instead of %f\n", xx, yy, out(xx, yy), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    for (bool parallel : {true, false}) {
+        Timings eager, lazy;
+        if (!run(target, parallel, eager) ||
+            !run(target.with_feature(Target::LazyJIT), parallel, lazy)) {
+            return 1;
+        }
+
+        printf("%s pipeline:\n", parallel ? "Parallel" : "Serial");
+        printf("eager: compile %f ms, first call %f ms, second call %f ms\n",
+               eager.compile * 1e3, eager.first_call * 1e3, eager.second_call * 1e3);
+        printf("lazy:  compile %f ms, first call %f ms, second call %f ms\n",
+               lazy.compile * 1e3, lazy.first_call * 1e3, lazy.second_call * 1e3);
+
+        // Both calls of the lazy version run a specialization that hasn't
+        // been compiled yet, so each compiles one closure. Both versions
+        // lower and optimize the whole pipeline, but the lazy one should
+        // generate machine code for far less of it.
+        double eager_total = eager.compile + eager.first_call + eager.second_call;
+        double lazy_total = lazy.compile + lazy.first_call + lazy.second_call;
+        printf("time to second result: eager %f ms, lazy %f ms\n", eager_total * 1e3, lazy_total * 1e3);
+        if (lazy_total > eager_total) {
+            printf("Lazy JIT compilation was slower than eager compilation\n");
+            return 1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
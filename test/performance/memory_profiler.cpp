@@ -1,5 +1,6 @@
 #include "Halide.h"
 #include <stdio.h>
+#include <string.h>
 
 using namespace Halide;
 
@@ -7,12 +8,16 @@ int heap_peak = 0;
 int num_mallocs = 0;
 int malloc_avg = 0;
 int stack_peak = 0;
+int pipeline_heap_peak = 0;
+int pipeline_num_mallocs = 0;
 
 void reset_stats() {
     heap_peak = 0;
     num_mallocs = 0;
     malloc_avg = 0;
     stack_peak = 0;
+    pipeline_heap_peak = 0;
+    pipeline_num_mallocs = 0;
 }
 
 void my_print(JITUserContext *, const char *msg) {
@@ -22,6 +27,12 @@ void my_print(JITUserContext *, const char *msg) {
     int val;
 
     // printf("%s", msg);
+    const char *pipeline_stats = strstr(msg, " heap allocations: ");
+    if (pipeline_stats) {
+        sscanf(pipeline_stats, " heap allocations: %d  peak heap usage: %d bytes",
+               &pipeline_num_mallocs, &pipeline_heap_peak);
+    }
+
     val = sscanf(msg, " g_%d: %fms (%f%%) threads: %f peak: %d num: %d avg: %d",
                  &idx, &this_ms, &this_percentage, &this_threads, &this_heap_peak,
                  &this_num_mallocs, &this_malloc_avg);
@@ -337,6 +348,60 @@ int main(int argc, char **argv) {
         }
     }
 
+    {
+        printf("Running heap arena test...\n");
+        // A chain of compute_root stages, each of which is only live
+        // until the next one has been computed. Packing them into an
+        // arena should replace all the mallocs with a single one
+        // without increasing the peak heap usage.
+        const int size_x = 1000;
+        const int size_y = 1000;
+        const int num_stages = 6;
+
+        std::vector<Func> stages;
+        for (int i = 0; i < num_stages; i++) {
+            stages.emplace_back("s_" + std::to_string(i));
+        }
+        stages[0](x, y) = x + y;
+        for (int i = 1; i < num_stages; i++) {
+            stages[i](x, y) = stages[i - 1](x, y) + stages[i - 1](x + 1, y);
+            stages[i - 1].compute_root();
+        }
+
+        Func out = stages.back();
+        out.jit_handlers().custom_print = my_print;
+
+        reset_stats();
+        out.realize({size_x, size_y}, t);
+        const int separate_mallocs = pipeline_num_mallocs;
+        const int separate_peak = pipeline_heap_peak;
+
+        reset_stats();
+        out.realize({size_x, size_y}, t.with_feature(Target::ArenaAllocations));
+        const int arena_mallocs = pipeline_num_mallocs;
+        const int arena_peak = pipeline_heap_peak;
+
+        printf("Heap allocations: %d -> %d, peak heap usage: %d -> %d bytes\n",
+               separate_mallocs, arena_mallocs, separate_peak, arena_peak);
+
+        if (separate_mallocs != num_stages - 1) {
+            printf("Num of mallocs without an arena was %d instead of %d\n",
+                   separate_mallocs, num_stages - 1);
+            return 1;
+        }
+        if (arena_mallocs != 1) {
+            printf("Num of mallocs with an arena was %d instead of 1\n", arena_mallocs);
+            return 1;
+        }
+        // Each of the two slots of the arena may be rounded up by less
+        // than 128 bytes.
+        if (arena_peak > separate_peak + 2 * 128) {
+            printf("Peak heap with an arena was %d, which is more than %d\n",
+                   arena_peak, separate_peak + 2 * 128);
+            return 1;
+        }
+    }
+
     printf("Success!\n");
     return 0;
 }
@@ -0,0 +1,87 @@
+#include "Halide.h"
+#include <map>
+#include <stdio.h>
+#include <string.h>
+
+using namespace Halide;
+
+struct Traffic {
+    unsigned long long loaded = 0, stored = 0;
+};
+
+std::map<std::string, Traffic> traffic;
+
+void my_print(JITUserContext *, const char *msg) {
+    char name[64];
+    const char *counts = strstr(msg, " loaded: ");
+    if (counts && sscanf(msg, " %63[^:]:", name) == 1) {
+        Traffic t;
+        if (sscanf(counts, " loaded: %llu stored: %llu", &t.loaded, &t.stored) == 2) {
+            traffic[name] = t;
+        }
+    }
+}
+
+// Return 0 if there is no error found
+int check_traffic(const std::string &name, unsigned long long loaded, unsigned long long stored) {
+    Traffic t = traffic[name];
+    if (t.loaded != loaded || t.stored != stored) {
+        printf("%s loaded %llu and stored %llu bytes instead of %llu and %llu\n",
+               name.c_str(), t.loaded, t.stored, loaded, stored);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    Target t = target.with_feature(Target::Profile).with_feature(Target::ProfileMemoryTraffic);
+
+    Var x("x"), y("y"), xo("xo"), xi("xi");
+
+    Buffer<float> in(1025, 256);
+    in.fill(1.0f);
+
+    {
+        printf("Running vectorized parallel stencil test...\n");
+        Func f("f_1"), g("g_1");
+        f(x, y) = in(x, y) * 2;
+        g(x, y) = f(x, y) + f(x + 1, y);
+        f.compute_root();
+        g.vectorize(x, 8).parallel(y);
+
+        g.jit_handlers().custom_print = my_print;
+
+        traffic.clear();
+        g.realize({1024, 256}, t);
+        if (check_traffic("f_1", 1025 * 256 * 4, 1025 * 256 * 4) != 0 ||
+            check_traffic("g_1", 2 * 1024 * 256 * 4, 1024 * 256 * 4) != 0) {
+            return 1;
+        }
+    }
+
+    {
+        printf("Running guarded loop test...\n");
+        // The guard in the inner loop stops the byte counts from being
+        // hoisted out of it.
+        Func h("h_2");
+        h(x, y) = in(x, y) + 1;
+        h.split(x, xo, xi, 16, TailStrategy::GuardWithIf);
+
+        h.jit_handlers().custom_print = my_print;
+
+        traffic.clear();
+        h.realize({1000, 100}, t);
+        if (check_traffic("h_2", 1000 * 100 * 4, 1000 * 100 * 4) != 0) {
+            return 1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include "halide_test_dirs.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+namespace {
+
+bool assembly_contains(const std::string &filename, const std::string &needle) {
+    std::ifstream f(filename);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str().find(needle) != std::string::npos;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    // A pipeline that streams through much more memory than fits in
+    // the last level cache, and never reads back what it writes.
+    const int size = 64 * 1024 * 1024 / sizeof(float);
+    const int vec = target.natural_vector_size<float>();
+
+    Buffer<float> input(size);
+    input.for_each_element([&](int x) { input(x) = (float)(x & 1023); });
+    Buffer<float> output(size);
+
+    double times[2];
+    for (int streaming = 0; streaming < 2; streaming++) {
+        ImageParam src(Float(32), 1);
+        Var x("x"), xo("xo"), xi("xi");
+        Func dst("dst");
+        dst(x) = src(x) * 2.0f + 1.0f;
+        dst.split(x, xo, xi, vec * 1024, TailStrategy::GuardWithIf)
+            .vectorize(xi, vec, TailStrategy::GuardWithIf)
+            .parallel(xo);
+
+        // Non-temporal stores need to know the destination is aligned.
+        src.set_host_alignment(64);
+        dst.output_buffer().set_host_alignment(64);
+        if (streaming) {
+            dst.store_nontemporal();
+        }
+
+        std::string asm_file = Internal::get_test_tmp_dir() +
+                               (streaming ? "halide_nontemporal_stores.s" : "halide_temporal_stores.s");
+        dst.compile_to_assembly(asm_file, {src}, "nontemporal_stores", target);
+
+        if (streaming) {
+            // Check that we actually got streaming stores on the
+            // architectures that have them.
+            const char *instruction = nullptr;
+            if (target.arch == Target::X86) {
+                instruction = "movnt";
+            } else if (target.arch == Target::ARM && target.bits == 64) {
+                instruction = "stnp";
+            }
+            if (instruction && !assembly_contains(asm_file, instruction)) {
+                printf("Did not find %s in %s\n", instruction, asm_file.c_str());
+                return 1;
+            }
+        }
+
+        src.set(input);
+        dst.compile_jit(target);
+        times[streaming] = benchmark([&]() {
+            dst.realize(output);
+        });
+
+        for (int i = 0; i < size; i++) {
+            float correct = input(i) * 2.0f + 1.0f;
+            if (output(i) != correct) {
+                printf("output(%d) = %f instead of %f\n", i, output(i), correct);
+                return 1;
+            }
+        }
+    }
+
+    // Both versions read and write every byte once.
+    const double bytes = 2.0 * size * sizeof(float);
+    printf("regular stores:      %.3e byte/s\n", bytes / times[0]);
+    printf("non-temporal stores: %.3e byte/s\n", bytes / times[1]);
+
+    // Non-temporal stores save the read-for-ownership of each output
+    // cache line, so they should not be slower. Leave lots of room for
+    // noise, and for machines where the difference is negligible.
+    if (times[1] > times[0] * 1.5) {
+        printf("Non-temporal stores are slower than they should be.\n");
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+namespace {
+
+// Histogram the input into the given number of bins, with the rows
+// split across tasks.
+double time_histogram(const Target &target, const Buffer<uint16_t> &in,
+                      int num_bins, bool privatized, Buffer<int> &out) {
+    ImageParam input(UInt(16), 2);
+    Func hist("hist");
+    Var x("x");
+    RDom r(0, input.width(), 0, input.height());
+    hist(x) = 0;
+    hist(cast<int>(input(r.x, r.y)) % num_bins) += 1;
+
+    const int num_tasks = 16;
+    if (privatized) {
+        hist.update().privatize(r.y, num_tasks, target.natural_vector_size<int>());
+    } else {
+        RVar ro, ri;
+        hist.update()
+            .split(r.y, ro, ri, (input.height() + num_tasks - 1) / num_tasks, TailStrategy::GuardWithIf)
+            .atomic()
+            .parallel(ro);
+    }
+
+    Callable c = hist.compile_to_callable({input}, target);
+    return benchmark([&]() {
+        c(in, out);
+    });
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    Buffer<uint16_t> in(2048, 2048);
+    // A skewed distribution, so that some bins are heavily contended.
+    in.for_each_element([&](int x, int y) {
+        uint32_t h = (uint32_t)(x * 73856093) ^ (uint32_t)(y * 19349663);
+        in(x, y) = (uint16_t)((h & 7) ? (h & 15) : (h >> 8));
+    });
+
+    for (int num_bins : {256, 65536}) {
+        Buffer<int> atomic_out(num_bins), privatized_out(num_bins);
+        double atomic_time = time_histogram(target, in, num_bins, false, atomic_out);
+        double privatized_time = time_histogram(target, in, num_bins, true, privatized_out);
+
+        for (int i = 0; i < num_bins; i++) {
+            if (atomic_out(i) != privatized_out(i)) {
+                printf("privatized_out(%d) = %d instead of %d\n", i, privatized_out(i), atomic_out(i));
+                return 1;
+            }
+        }
+
+        printf("%d bins: atomic %f ms, privatized %f ms, speedup %fx\n",
+               num_bins, atomic_time * 1e3, privatized_time * 1e3, atomic_time / privatized_time);
+
+        // With a few heavily contended bins, every task fights over the
+        // same cache lines when the updates are atomic.
+        if (num_bins == 256 && privatized_time > atomic_time) {
+            printf("Privatized histogram was slower than the atomic one\n");
+            return 1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+
+#include <cstdio>
+#include <string>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+namespace {
+
+const int num_funcs = 10;
+
+// Many small Funcs of dynamic size, computed per row of the output, so
+// the generic code makes ten heap allocations per row.
+double time_pipeline(const Target &target, Buffer<float> &out) {
+    Var x("x"), y("y");
+    std::vector<Func> fs;
+    Expr e = 0.0f;
+    for (int j = 0; j < num_funcs; j++) {
+        Func f("pgo_f" + std::to_string(j));
+        f(x, y) = cast<float>(x * j + y);
+        e += f(x, y) + f(x + 1, y);
+        fs.push_back(f);
+    }
+
+    Func g("pgo_g");
+    g(x, y) = e;
+    for (auto f : fs) {
+        f.compute_at(g, y);
+    }
+
+    Callable c = g.compile_to_callable({}, target);
+    return benchmark([&]() {
+        c(out);
+    });
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    printf("[SKIP] Windows does not have a working setenv\n");
+#else
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    const int w = 16, h = 4096;
+    Buffer<float> generic_out(w, h), guided_out(w, h);
+    double generic_time = time_pipeline(target, generic_out);
+
+    // This is what a profiled run reports: each Func is allocated once
+    // per row, and its peak memory use is a single row.
+    Internal::TemporaryFile profile("profile_guided_optimization", "txt");
+    FILE *f = fopen(profile.pathname().c_str(), "w");
+    fprintf(f, "pipeline 1 10 1000000 pgo_g\n");
+    for (int j = 0; j < num_funcs; j++) {
+        fprintf(f, "func 100000 %d %d 0 pgo_f%d\n", h, (int)((w + 1) * sizeof(float)), j);
+    }
+    fclose(f);
+    setenv("HL_PGO_PROFILE", profile.pathname().c_str(), 1);
+
+    double guided_time = time_pipeline(target, guided_out);
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            if (generic_out(x, y) != guided_out(x, y)) {
+                printf("guided_out(%d, %d) = %f instead of %f\n", x, y, guided_out(x, y), generic_out(x, y));
+                return 1;
+            }
+        }
+    }
+
+    printf("without profile: %f ms\n", generic_time * 1e3);
+    printf("with profile:    %f ms\n", guided_time * 1e3);
+    printf("speedup:         %fx\n", generic_time / guided_time);
+
+    // The profile turns the heap allocations into stack allocations,
+    // which should never be slower.
+    if (guided_time > generic_time * 1.2) {
+        printf("The profile-guided pipeline was slower than the generic one\n");
+        return 1;
+    }
+
+    printf("Success!\n");
+#endif
+    return 0;
+}
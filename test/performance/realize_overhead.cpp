@@ -131,6 +131,59 @@ int main(int argc, char **argv) {
         std::cout << "One argument Pipeline realize reusing Realization/Target time " << t * 1e6 << "us.\n";
     }
 
+    {
+        Func f;
+        Param<int> in;
+
+        f() = in + 42;
+        Callable c = f.compile_to_callable({in});
+
+        const int batch_size = 1000;
+        std::vector<Buffer<int32_t>> bufs;
+        std::vector<std::tuple<int, Buffer<int32_t>>> batch;
+        for (int i = 0; i < batch_size; i++) {
+            bufs.push_back(Buffer<int32_t>::make_scalar());
+            batch.emplace_back(i, bufs.back());
+        }
+
+        double t_loop = benchmark([&]() {
+            for (int i = 0; i < batch_size; i++) {
+                c(i, bufs[i]);
+            }
+        });
+        std::cout << "One argument Callable call in a loop time " << t_loop * 1e6 / batch_size << "us per call.\n";
+
+        double t_batch = benchmark([&]() { c.call_batch(batch); });
+        std::cout << "One argument Callable call_batch time " << t_batch * 1e6 / batch_size << "us per call.\n";
+    }
+
+    {
+        ImageParam in(Int(32), 1);
+        Param<int> offset;
+        Var x;
+        Func f;
+
+        f(x) = in(x) + offset;
+        Callable c = f.compile_to_callable({in, offset});
+
+        Buffer<int32_t> input(16), output(16);
+        input.fill(0);
+
+        double t_call = benchmark([&]() { c(input, 1, output); });
+        std::cout << "Two argument Callable call time " << t_call * 1e6 << "us.\n";
+
+        auto bound = c.bind(input, 1, output);
+        int32_t other_host[16] = {0};
+        int frame = 0;
+        double t_bound = benchmark([&]() {
+            bound.set<1>(frame & 1);
+            bound.set_host<0>((frame++ & 1) ? (void *)other_host : (void *)input.data());
+            bound();
+        });
+        std::cout << "Two argument bound Callable call time " << t_bound * 1e6 << "us ("
+                  << t_call / t_bound << "x faster).\n";
+    }
+
     for (int i = 10; i < 100; i += 10) {
         Func f;
         std::vector<Param<int>> params(i);
@@ -0,0 +1,139 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+namespace {
+
+const char *order_names[] = {"lexicographic", "Morton", "Hilbert"};
+const FuseOrder orders[] = {FuseOrder::Lexicographic, FuseOrder::Morton, FuseOrder::Hilbert};
+
+// A transpose of an image much larger than the cache, one 32x32 tile at
+// a time. In lexicographic order, a row of output tiles reads a column
+// of input tiles, so consecutive tiles share no input cache lines or
+// pages.
+double time_transpose(FuseOrder order, bool parallel, const Buffer<float> &in, Buffer<float> &out) {
+    ImageParam input(Float(32), 2);
+    Func output("output");
+    Var x("x"), y("y"), xo("xo"), yo("yo"), xi("xi"), yi("yi"), t("t");
+
+    output(x, y) = input(y, x);
+
+    const int vec = get_jit_target_from_environment().natural_vector_size<float>();
+    output.tile(x, y, xo, yo, xi, yi, 32, 32)
+        .fuse(xo, yo, t, order)
+        .vectorize(xi, vec);
+    if (parallel) {
+        output.parallel(t);
+    }
+
+    input.set(in);
+    output.compile_jit();
+    return benchmark([&]() {
+        output.realize(out);
+    });
+}
+
+// A chain of stencils, computed per tile. Each tile recomputes a halo
+// of the intermediate stages, and reads a footprint of the input that
+// overlaps its neighbours' in both dimensions.
+double time_stencil_chain(FuseOrder order, bool parallel, const Buffer<float> &in, Buffer<float> &out) {
+    ImageParam input(Float(32), 2);
+    Var x("x"), y("y"), xo("xo"), yo("yo"), xi("xi"), yi("yi"), t("t");
+
+    const int stages = 8;
+    const int vec = get_jit_target_from_environment().natural_vector_size<float>();
+    Func prev = BoundaryConditions::repeat_edge(input);
+    std::vector<Func> funcs;
+    for (int i = 0; i < stages; i++) {
+        Func f("stage_" + std::to_string(i));
+        f(x, y) = (prev(x - 2, y - 2) + prev(x + 2, y - 2) +
+                   prev(x - 2, y + 2) + prev(x + 2, y + 2) + prev(x, y)) * 0.2f;
+        funcs.push_back(f);
+        prev = f;
+    }
+
+    Func output = funcs.back();
+    output.tile(x, y, xo, yo, xi, yi, 64, 64)
+        .fuse(xo, yo, t, order)
+        .vectorize(xi, vec);
+    if (parallel) {
+        output.parallel(t);
+    }
+    for (int i = 0; i < stages - 1; i++) {
+        funcs[i].compute_at(output, t).vectorize(x, vec);
+    }
+
+    input.set(in);
+    output.compile_jit();
+    return benchmark([&]() {
+        output.realize(out);
+    });
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    const int size = 4096;
+    Buffer<float> in(size, size);
+    in.for_each_element([&](int x, int y) { in(x, y) = (float)((x * 7 + y * 3) & 255); });
+    Buffer<float> out(size, size), reference(size, size);
+
+    for (int parallel = 0; parallel < 2; parallel++) {
+        double transpose_times[3], stencil_times[3];
+        for (int i = 0; i < 3; i++) {
+            transpose_times[i] = time_transpose(orders[i], parallel, in, out);
+            for (int y = 0; y < size; y++) {
+                for (int x = 0; x < size; x++) {
+                    if (out(x, y) != in(y, x)) {
+                        printf("%s transpose: out(%d, %d) = %f instead of %f\n",
+                               order_names[i], x, y, out(x, y), in(y, x));
+                        return 1;
+                    }
+                }
+            }
+
+            stencil_times[i] = time_stencil_chain(orders[i], parallel, in, i == 0 ? reference : out);
+            if (i > 0) {
+                for (int y = 0; y < size; y++) {
+                    for (int x = 0; x < size; x++) {
+                        if (out(x, y) != reference(x, y)) {
+                            printf("%s stencil chain: out(%d, %d) = %f instead of %f\n",
+                                   order_names[i], x, y, out(x, y), reference(x, y));
+                            return 1;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < 3; i++) {
+            printf("%s %s: transpose %f ms, stencil chain %f ms\n",
+                   parallel ? "parallel" : "serial", order_names[i],
+                   transpose_times[i] * 1e3, stencil_times[i] * 1e3);
+        }
+
+        // The curve orders do a little more arithmetic per tile, and
+        // how much they help depends on the cache hierarchy, so only
+        // check they aren't dramatically slower.
+        for (int i = 1; i < 3; i++) {
+            if (transpose_times[i] > transpose_times[0] * 2 ||
+                stencil_times[i] > stencil_times[0] * 2) {
+                printf("%s order is much slower than lexicographic order\n", order_names[i]);
+                return 1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -8,6 +8,7 @@
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <random>
 #include <set>
@@ -472,15 +473,41 @@ inline Buffer<> adjust_buffer_dims(const std::string &title, const std::string &
     return b;
 }
 
+// The files mapped by load_input_from_file(). They are never unmapped,
+// since the input Buffers that point into them live as long as the RunGen.
+inline std::vector<std::unique_ptr<Halide::Tools::MappedImageFile>> &mapped_input_files() {
+    static std::vector<std::unique_ptr<Halide::Tools::MappedImageFile>> files;
+    return files;
+}
+
 // Load a buffer from a pathname, adjusting the type and dimensions to
-// fit the metadata's requirements as needed.
+// fit the metadata's requirements as needed. Formats with uncompressed
+// payloads (e.g. .npy) are mapped rather than read, so even huge inputs
+// load instantly, as long as the payload is as aligned as a buffer
+// allocated by Halide would be.
 inline Buffer<> load_input_from_file(const std::string &pathname,
                                      const halide_filter_argument_t &metadata) {
     Buffer<> b = Buffer<>(metadata.type, 0);
     info() << "Loading input " << metadata.name << " from " << pathname << " ...";
-    if (!Halide::Tools::load<Buffer<>, IOCheckFail>(pathname, &b)) {
+    auto mapping = std::make_unique<Halide::Tools::MappedImageFile>();
+    if (!Halide::Tools::load_mapped<Buffer<>, IOCheckFail>(pathname, mapping.get(), &b)) {
         fail() << "Unable to load input: " << pathname;
     }
+    if (mapping->is_mapped()) {
+        // Mapped payloads are only naturally aligned (a .npy header is
+        // padded to a multiple of 64 bytes, for example), but pipelines may
+        // assume the alignment of buffers allocated by Halide, and
+        // unaligned inputs would skew the benchmarks. Copy those instead.
+        if ((uintptr_t)b.data() % HALIDE_RUNTIME_BUFFER_ALLOCATION_ALIGNMENT != 0) {
+            info() << "Copying input " << metadata.name << " from " << pathname
+                   << ", because its payload isn't " << HALIDE_RUNTIME_BUFFER_ALLOCATION_ALIGNMENT << "-byte aligned";
+            b = b.copy();
+            b.set_host_dirty();
+        } else {
+            info() << "Mapped input " << metadata.name << " from " << pathname;
+            mapped_input_files().push_back(std::move(mapping));
+        }
+    }
     if (b.dimensions() != metadata.dimensions) {
         b = adjust_buffer_dims("Input", metadata.name, metadata.dimensions, b);
     }
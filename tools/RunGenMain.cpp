@@ -59,13 +59,15 @@ Arguments:
         some_input_buffer=/path/to/existing/file.png
         some_output_buffer=/path/to/create/output/file.png
 
-    We currently support JPG, PGM, PNG, PPM format. If the type or dimensions
-    of the input or output file type can't support the data (e.g., your filter
-    uses float32 input and output, and you load/save to PNG), we'll use the most
-    robust approximation within the format and issue a warning to stdout.
-
-    (We anticipate adding other image formats in the future, in particular,
-    TIFF and TMP.)
+    We currently support JPG, PGM, PNG, PPM, and uncompressed TIFF format. If
+    the type or dimensions of the input or output file type can't support the
+    data (e.g., your filter uses float32 input and output, and you load/save to
+    PNG), we'll use the most robust approximation within the format and issue a
+    warning to stdout.
+
+    Inputs in NPY, TMP, or MAT format are memory-mapped rather than read, so
+    large inputs cost nothing to load; pages are read as the filter touches
+    them.
 
     For inputs, there are also "pseudo-file" specifiers you can use; currently
     supported are
@@ -5,6 +5,7 @@
 #define HALIDE_IMAGE_IO_H
 
 #include <algorithm>
+#include <cassert>
 #include <cctype>
 #include <cmath>
 #include <cstdarg>
@@ -21,13 +22,19 @@
 #include "png.h"
 #endif
 
-#ifndef HALIDE_NO_JPEG
 #ifdef _WIN32
 #ifndef NOMINMAX
 #define NOMINMAX
 #endif
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
+
+#ifndef HALIDE_NO_JPEG
 #include "jpeglib.h"
 #endif
 
@@ -60,6 +67,94 @@ struct FormatInfo {
     }
 };
 
+// A whole file mapped into memory, so that load_mapped() can point
+// images directly at the pixels in it. The mapping is copy-on-write:
+// writes to it are private to this process and never reach the file.
+class MappedImageFile {
+public:
+    MappedImageFile() = default;
+    MappedImageFile(const MappedImageFile &) = delete;
+    MappedImageFile &operator=(const MappedImageFile &) = delete;
+
+    ~MappedImageFile() {
+        unmap();
+    }
+
+    // Map the given file, replacing any previous mapping. Returns false
+    // if the file can't be mapped (including if it is empty).
+    bool map(const std::string &filename) {
+        unmap();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER file_size;
+        HANDLE mapping = nullptr;
+        if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        }
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            return false;
+        }
+        void *ptr = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        CloseHandle(mapping);
+        if (ptr == nullptr) {
+            return false;
+        }
+        size_ = (size_t)file_size.QuadPart;
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        void *ptr = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (ptr == MAP_FAILED) {
+            return false;
+        }
+        size_ = (size_t)st.st_size;
+#endif
+        data_ = (uint8_t *)ptr;
+        return true;
+    }
+
+    void unmap() {
+        if (data_ == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+#else
+        munmap(data_, size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    bool is_mapped() const {
+        return data_ != nullptr;
+    }
+
+    uint8_t *data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+private:
+    uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+};
+
 namespace Internal {
 
 typedef bool (*CheckFunc)(bool condition, const char *msg);
@@ -785,6 +880,15 @@ struct FileOpener {
         return fread(data, 1, count, f) == count;
     }
 
+    // Seek to an absolute position, which may be beyond 2GB.
+    bool seek(uint64_t offset) {
+#ifdef _WIN32
+        return _fseeki64(f, (__int64)offset, SEEK_SET) == 0;
+#else
+        return fseeko(f, (off_t)offset, SEEK_SET) == 0;
+#endif
+    }
+
     template<typename T, size_t N>
     bool read_array(T (&data)[N]) {
         return read_bytes(&data[0], sizeof(T) * N);
@@ -1292,15 +1396,9 @@ bool buffer_is_compact_planar(ImageType &im) {
     return true;
 }
 
-template<typename ImageType, CheckFunc check = CheckReturn>
-bool load_npy(const std::string &filename, ImageType *im) {
-    static_assert(!ImageType::has_static_halide_type, "");
-
-    FileOpener f(filename, "rb");
-    if (!check(f.f != nullptr, "File could not be opened for reading")) {
-        return false;
-    }
-
+// Read the header of a .npy file, leaving f at the start of the payload.
+template<CheckFunc check = CheckReturn>
+bool read_npy_header(FileOpener &f, halide_type_t *im_type, std::vector<int> *extents) {
     char magic_and_version[8];
     if (!check(f.read_bytes(magic_and_version, 8), "Could not read .npy header")) {
         return false;
@@ -1341,18 +1439,37 @@ bool load_npy(const std::string &filename, ImageType *im) {
         return false;
     }
 
-    halide_type_t im_type((halide_type_code_t)0, 0, 0);
+    *im_type = halide_type_t((halide_type_code_t)0, 0, 0);
     for (const auto &d : npy_dtypes) {
         if (h.type_code == d.second.type_code && h.type_bytes == d.second.type_bytes) {
-            im_type = d.first;
+            *im_type = d.first;
             break;
         }
     }
-    if (!check(im_type.bits != 0, "Unsupported type in load_npy")) {
+    if (!check(im_type->bits != 0, "Unsupported type in load_npy")) {
+        return false;
+    }
+
+    *extents = h.extents;
+    return true;
+}
+
+template<typename ImageType, CheckFunc check = CheckReturn>
+bool load_npy(const std::string &filename, ImageType *im) {
+    static_assert(!ImageType::has_static_halide_type, "");
+
+    FileOpener f(filename, "rb");
+    if (!check(f.f != nullptr, "File could not be opened for reading")) {
+        return false;
+    }
+
+    halide_type_t im_type;
+    std::vector<int> extents;
+    if (!read_npy_header<check>(f, &im_type, &extents)) {
         return false;
     }
 
-    *im = ImageType(im_type, h.extents);
+    *im = ImageType(im_type, extents);
 
     // This should never fail unless the default Buffer<> constructor behavior changes.
     if (!check(buffer_is_compact_planar(*im), "load_npy() requires compact planar images")) {
@@ -1604,6 +1721,25 @@ inline const halide_type_t *tmp_code_to_halide_type() {
     return tmp_code_to_halide_type_;
 }
 
+// Read the header of a .tmp file, leaving f at the start of the payload.
+template<CheckFunc check = CheckReturn>
+bool read_tmp_header(FileOpener &f, halide_type_t *im_type, std::vector<int> *extents) {
+    int32_t header[5];
+    if (!check(f.read_array(header), "Count not read .tmp header")) {
+        return false;
+    }
+
+    if (!check(header[0] > 0 && header[1] > 0 && header[2] > 0 && header[3] > 0 &&
+                   header[4] >= 0 && header[4] < kNumTmpCodes,
+               "Bad header on .tmp file")) {
+        return false;
+    }
+
+    *im_type = tmp_code_to_halide_type()[header[4]];
+    *extents = {header[0], header[1], header[2], header[3]};
+    return true;
+}
+
 // ".tmp" is a file format used by the ImageStack tool (see https://github.com/abadams/ImageStack)
 template<typename ImageType, CheckFunc check = CheckReturn>
 bool load_tmp(const std::string &filename, ImageType *im) {
@@ -1614,20 +1750,13 @@ bool load_tmp(const std::string &filename, ImageType *im) {
         return false;
     }
 
-    int32_t header[5];
-    if (!check(f.read_array(header), "Count not read .tmp header")) {
-        return false;
-    }
-
-    if (!check(header[0] > 0 && header[1] > 0 && header[2] > 0 && header[3] > 0 &&
-                   header[4] >= 0 && header[4] < kNumTmpCodes,
-               "Bad header on .tmp file")) {
+    halide_type_t im_type;
+    std::vector<int> extents;
+    if (!read_tmp_header<check>(f, &im_type, &extents)) {
         return false;
     }
 
-    const halide_type_t im_type = tmp_code_to_halide_type()[header[4]];
-    std::vector<int> im_dimensions = {header[0], header[1], header[2], header[3]};
-    *im = ImageType(im_type, im_dimensions);
+    *im = ImageType(im_type, extents);
 
     // This should never fail unless the default Buffer<> constructor behavior changes.
     if (!check(buffer_is_compact_planar(*im), "load_tmp() requires compact planar images")) {
@@ -1733,15 +1862,9 @@ enum MatlabClassCode {
     mxUINT64_CLASS = 15
 };
 
-template<typename ImageType, CheckFunc check = CheckReturn>
-bool load_mat(const std::string &filename, ImageType *im) {
-    static_assert(!ImageType::has_static_halide_type, "");
-
-    FileOpener f(filename, "rb");
-    if (!check(f.f != nullptr, "File could not be opened for reading")) {
-        return false;
-    }
-
+// Read the header of a .mat file, leaving f at the start of the payload.
+template<CheckFunc check = CheckReturn>
+bool read_mat_header(FileOpener &f, halide_type_t *im_type, std::vector<int> *extents) {
     uint8_t header[128];
     if (!check(f.read_array(header), "Could not read .mat header\n")) {
         return false;
@@ -1774,8 +1897,8 @@ bool load_mat(const std::string &filename, ImageType *im) {
         return false;
     }
     int dims = shape_header[1] / 4;
-    std::vector<int> extents(dims);
-    if (!check(f.read_vector(&extents), "Could not read .mat header\n")) {
+    extents->resize(dims);
+    if (!check(f.read_vector(extents), "Could not read .mat header\n")) {
         return false;
     }
     if (dims & 1) {
@@ -1809,7 +1932,7 @@ bool load_mat(const std::string &filename, ImageType *im) {
     if (!check(f.read_array(payload_header), "Could not read .mat header\n")) {
         return false;
     }
-    halide_type_t type;
+    halide_type_t &type = *im_type;
     switch (payload_header[0]) {
     case miINT8:
         type = halide_type_of<int8_t>();
@@ -1845,6 +1968,23 @@ bool load_mat(const std::string &filename, ImageType *im) {
         check(false, "Unknown header");
         return false;
     }
+    return true;
+}
+
+template<typename ImageType, CheckFunc check = CheckReturn>
+bool load_mat(const std::string &filename, ImageType *im) {
+    static_assert(!ImageType::has_static_halide_type, "");
+
+    FileOpener f(filename, "rb");
+    if (!check(f.f != nullptr, "File could not be opened for reading")) {
+        return false;
+    }
+
+    halide_type_t type;
+    std::vector<int> extents;
+    if (!read_mat_header<check>(f, &type, &extents)) {
+        return false;
+    }
 
     *im = ImageType(type, extents);
 
@@ -2076,11 +2216,274 @@ bool save_mat(ImageType &im, const std::string &filename) {
     return true;
 }
 
+// Everything needed to find the pixels of an uncompressed TIFF.
+struct TiffLayout {
+    halide_type_t type;
+    int width, height, channels;
+    // True if each channel is stored separately (PlanarConfiguration 2),
+    // rather than interleaved.
+    bool planar;
+    // True if the file's byte order isn't the host's.
+    bool swap_bytes;
+    // The size of each strip or tile. Strips are as wide as the image.
+    int block_width, block_height;
+    int blocks_across, blocks_down;
+    // The file offset and size of each strip or tile, by plane, then row,
+    // then column.
+    std::vector<uint64_t> offsets, byte_counts;
+};
+
+// Read the header and first IFD of a TIFF or BigTIFF file.
+template<CheckFunc check = CheckReturn>
+bool read_tiff_layout(FileOpener &f, TiffLayout *layout) {
+    uint8_t header[16];
+    if (!check(f.read_bytes(header, 8), "Could not read TIFF header")) {
+        return false;
+    }
+    if (!check((header[0] == 'I' && header[1] == 'I') || (header[0] == 'M' && header[1] == 'M'),
+               "Bad TIFF byte order marker")) {
+        return false;
+    }
+    const bool file_is_big_endian = (header[0] == 'M');
+    const auto get = [file_is_big_endian](const uint8_t *p, size_t bytes) -> uint64_t {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            if (file_is_big_endian) {
+                value = (value << 8) | p[i];
+            } else {
+                value |= (uint64_t)p[i] << (8 * i);
+            }
+        }
+        return value;
+    };
+
+    const uint64_t version = get(header + 2, 2);
+    const bool big_tiff = (version == 43);
+    if (!check(version == 42 || big_tiff, "Bad TIFF version")) {
+        return false;
+    }
+    uint64_t ifd_offset;
+    if (big_tiff) {
+        if (!check(f.read_bytes(header + 8, 8) && get(header + 4, 2) == 8, "Bad BigTIFF header")) {
+            return false;
+        }
+        ifd_offset = get(header + 8, 8);
+    } else {
+        ifd_offset = get(header + 4, 4);
+    }
+
+    // In a BigTIFF, counts and offsets are 64-bit rather than 32-bit.
+    const size_t offset_bytes = big_tiff ? 8 : 4;
+    const size_t entry_bytes = 4 + 2 * offset_bytes;
+    uint8_t count_bytes[8];
+    if (!check(f.seek(ifd_offset) && f.read_bytes(count_bytes, big_tiff ? 8 : 2), "Could not read TIFF IFD")) {
+        return false;
+    }
+    const uint64_t entry_count = get(count_bytes, big_tiff ? 8 : 2);
+    if (!check(entry_count < 4096, "Bad TIFF IFD")) {
+        return false;
+    }
+    std::vector<uint8_t> entries(entry_count * entry_bytes);
+    if (!check(f.read_vector(&entries), "Could not read TIFF IFD")) {
+        return false;
+    }
+
+    std::map<uint16_t, std::vector<uint64_t>> tags;
+    for (size_t i = 0; i < entry_count; i++) {
+        const uint8_t *entry = &entries[i * entry_bytes];
+        const uint16_t tag = (uint16_t)get(entry, 2);
+        const uint16_t type = (uint16_t)get(entry + 2, 2);
+        const uint64_t count = get(entry + 4, offset_bytes);
+        // We only need integer-valued tags; skip the rest.
+        size_t elem_bytes = 0;
+        switch (type) {
+        case 1:  // BYTE
+        case 6:  // SBYTE
+            elem_bytes = 1;
+            break;
+        case 3:  // SHORT
+        case 8:  // SSHORT
+            elem_bytes = 2;
+            break;
+        case 4:  // LONG
+        case 9:  // SLONG
+            elem_bytes = 4;
+            break;
+        case 16:  // LONG8
+        case 17:  // SLONG8
+            elem_bytes = 8;
+            break;
+        default:
+            continue;
+        }
+        if (!check(count < (1 << 28), "Bad TIFF tag")) {
+            return false;
+        }
+        // Values that fit are stored in the entry itself.
+        std::vector<uint8_t> raw(count * elem_bytes);
+        if (raw.size() <= offset_bytes) {
+            memcpy(raw.data(), entry + 4 + offset_bytes, raw.size());
+        } else if (!check(f.seek(get(entry + 4 + offset_bytes, offset_bytes)) && f.read_vector(&raw),
+                          "Could not read TIFF tag")) {
+            return false;
+        }
+        std::vector<uint64_t> &values = tags[tag];
+        for (size_t j = 0; j < count; j++) {
+            values.push_back(get(&raw[j * elem_bytes], elem_bytes));
+        }
+    }
+
+    const auto tag = [&tags](uint16_t t, uint64_t default_value) -> uint64_t {
+        auto it = tags.find(t);
+        return (it == tags.end() || it->second.empty()) ? default_value : it->second[0];
+    };
+    const auto all_equal = [&tags](uint16_t t) -> bool {
+        auto it = tags.find(t);
+        return it == tags.end() || std::all_of(it->second.begin(), it->second.end(), [&](uint64_t v) {
+                   return v == it->second[0];
+               });
+    };
+
+    layout->width = (int)tag(256, 0);        // ImageWidth
+    layout->height = (int)tag(257, 0);       // ImageLength
+    layout->channels = (int)tag(277, 1);     // SamplesPerPixel
+    const uint64_t bits = tag(258, 1);       // BitsPerSample
+    const uint64_t sample_format = tag(339, 1);  // SampleFormat
+    if (!check(layout->width > 0 && layout->height > 0 && layout->channels > 0, "Bad TIFF image size")) {
+        return false;
+    }
+    if (!check(tag(259, 1) == 1, "Only uncompressed TIFF files can be loaded")) {  // Compression
+        return false;
+    }
+    if (!check(tag(32997, 1) == 1, "TIFF files with an ImageDepth can't be loaded")) {
+        return false;
+    }
+    if (!check(all_equal(258) && all_equal(339), "TIFF files with mixed sample types can't be loaded")) {
+        return false;
+    }
+
+    // TIFF sample formats are 1 => unsigned int, 2 => signed int, 3 => float
+    const bool is_float = (sample_format == 3);
+    if (!check(sample_format >= 1 && sample_format <= 3 &&
+                   (bits == 8 || bits == 16 || bits == 32 || bits == 64) &&
+                   !(is_float && bits == 8),
+               "Unsupported TIFF sample type")) {
+        return false;
+    }
+    layout->type = halide_type_t(sample_format == 1 ? halide_type_uint :
+                                 sample_format == 2 ? halide_type_int :
+                                                      halide_type_float,
+                                 (int)bits);
+    layout->planar = (tag(284, 1) == 2 && layout->channels > 1);  // PlanarConfiguration
+    layout->swap_bytes = (file_is_big_endian != host_is_big_endian);
+
+    if (tags.count(322)) {
+        layout->block_width = (int)tag(322, 0);   // TileWidth
+        layout->block_height = (int)tag(323, 0);  // TileLength
+        layout->offsets = tags[324];              // TileOffsets
+        layout->byte_counts = tags[325];          // TileByteCounts
+    } else {
+        layout->block_width = layout->width;
+        layout->block_height = (int)std::min<uint64_t>(tag(278, layout->height), layout->height);  // RowsPerStrip
+        layout->offsets = tags[273];      // StripOffsets
+        layout->byte_counts = tags[279];  // StripByteCounts
+    }
+    if (!check(layout->block_width > 0 && layout->block_height > 0, "Bad TIFF tile size")) {
+        return false;
+    }
+    layout->blocks_across = (layout->width + layout->block_width - 1) / layout->block_width;
+    layout->blocks_down = (layout->height + layout->block_height - 1) / layout->block_height;
+    const size_t blocks = (size_t)layout->blocks_across * layout->blocks_down * (layout->planar ? layout->channels : 1);
+    return check(layout->offsets.size() == blocks && layout->byte_counts.size() == blocks,
+                 "TIFF strips or tiles don't match the image size");
+}
+
+// Read a region of a TIFF into a newly allocated image, reading only the
+// rows of the strips or tiles that overlap it.
+template<typename ImageType, CheckFunc check = CheckReturn>
+bool read_tiff_region(FileOpener &f, const TiffLayout &layout, int x, int y, int width, int height, ImageType *im) {
+    static_assert(!ImageType::has_static_halide_type, "");
+
+    if (!check(width > 0 && height > 0 && x >= 0 && y >= 0 &&
+                   x + width <= layout.width && y + height <= layout.height,
+               "Region is outside the TIFF image")) {
+        return false;
+    }
+
+    std::vector<int> extents = {width, height};
+    if (layout.channels > 1) {
+        extents.push_back(layout.channels);
+    }
+    *im = ImageType(layout.type, extents);
+    im->translate(0, x);
+    im->translate(1, y);
+
+    uint8_t *dst = (uint8_t *)im->data();
+    const size_t elem_bytes = layout.type.bytes();
+    const int64_t stride_y = im->dim(1).stride();
+    const int64_t stride_c = layout.channels > 1 ? im->dim(2).stride() : 0;
+    const int planes = layout.planar ? layout.channels : 1;
+    const int samples_per_pixel = layout.planar ? 1 : layout.channels;
+    const int bw = layout.block_width, bh = layout.block_height;
+
+    std::vector<uint8_t> row;
+    for (int plane = 0; plane < planes; plane++) {
+        for (int by = y / bh; by * bh < y + height; by++) {
+            for (int bx = x / bw; bx * bw < x + width; bx++) {
+                const size_t block = ((size_t)plane * layout.blocks_down + by) * layout.blocks_across + bx;
+                const int x_min = std::max(x, bx * bw);
+                const int x_max = std::min(x + width, (bx + 1) * bw);
+                const int y_max = std::min(y + height, (by + 1) * bh);
+                row.resize((size_t)(x_max - x_min) * samples_per_pixel * elem_bytes);
+                for (int r = std::max(y, by * bh); r < y_max; r++) {
+                    const uint64_t pos = ((uint64_t)(r - by * bh) * bw + (x_min - bx * bw)) * samples_per_pixel * elem_bytes;
+                    if (!check(pos + row.size() <= layout.byte_counts[block], "TIFF strip or tile is too small")) {
+                        return false;
+                    }
+                    if (!check(f.seek(layout.offsets[block] + pos) && f.read_vector(&row), "Could not read TIFF payload")) {
+                        return false;
+                    }
+                    if (layout.swap_bytes) {
+                        for (size_t i = 0; i < row.size(); i += elem_bytes) {
+                            std::reverse(&row[i], &row[i] + elem_bytes);
+                        }
+                    }
+                    uint8_t *dst_row = dst + ((r - y) * stride_y + (x_min - x)) * elem_bytes;
+                    if (samples_per_pixel == 1) {
+                        memcpy(dst_row + plane * stride_c * elem_bytes, row.data(), row.size());
+                    } else {
+                        // Deinterleave the channels.
+                        const uint8_t *src = row.data();
+                        for (int i = 0; i < x_max - x_min; i++) {
+                            for (int c = 0; c < layout.channels; c++) {
+                                memcpy(dst_row + (i + c * stride_c) * elem_bytes, src, elem_bytes);
+                                src += elem_bytes;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    im->set_host_dirty();
+    return true;
+}
+
 template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
 bool load_tiff(const std::string &filename, ImageType *im) {
     static_assert(!ImageType::has_static_halide_type, "");
-    check(false, "Reading TIFF is not yet supported");
-    return false;
+
+    FileOpener f(filename, "rb");
+    if (!check(f.f != nullptr, "File could not be opened for reading")) {
+        return false;
+    }
+
+    TiffLayout layout;
+    if (!read_tiff_layout<check>(f, &layout)) {
+        return false;
+    }
+    return read_tiff_region<ImageType, check>(f, layout, 0, 0, layout.width, layout.height, im);
 }
 
 inline const std::set<FormatInfo> &query_tiff() {
@@ -2190,10 +2593,76 @@ struct ElemWriter {
     bool ok = true;
 };
 
+// A TIFF field to be written by make_tiff_header().
+struct TiffField {
+    uint16_t tag;
+    uint16_t type;  // 3 => SHORT, 4 => LONG, 5 => RATIONAL, 16 => LONG8
+    std::vector<uint64_t> values;  // Each RATIONAL takes two values
+};
+
+// Make the header and IFD of a TIFF or BigTIFF file with the given
+// fields, in the host's byte order. Values that don't fit in their
+// entries are placed after the IFD.
+inline std::vector<uint8_t> make_tiff_header(std::vector<TiffField> fields, bool big_tiff) {
+    std::sort(fields.begin(), fields.end(), [](const TiffField &a, const TiffField &b) {
+        return a.tag < b.tag;
+    });
+
+    const size_t offset_bytes = big_tiff ? 8 : 4;
+    const size_t entry_bytes = 4 + 2 * offset_bytes;
+    const size_t ifd_offset = big_tiff ? 16 : 8;
+    const size_t count_bytes = big_tiff ? 8 : 2;
+    std::vector<uint8_t> header(ifd_offset + count_bytes + fields.size() * entry_bytes + offset_bytes, 0);
+
+    const auto put = [&header](size_t pos, uint64_t value, size_t bytes) {
+        if (header.size() < pos + bytes) {
+            header.resize(pos + bytes, 0);
+        }
+        const uint8_t u8 = (uint8_t)value;
+        const uint16_t u16 = (uint16_t)value;
+        const uint32_t u32 = (uint32_t)value;
+        const void *src = bytes == 1 ? (const void *)&u8 :
+                          bytes == 2 ? (const void *)&u16 :
+                          bytes == 4 ? (const void *)&u32 :
+                                       (const void *)&value;
+        memcpy(&header[pos], src, bytes);
+    };
+
+    header[0] = header[1] = host_is_big_endian ? 'M' : 'I';
+    put(2, big_tiff ? 43 : 42, 2);
+    if (big_tiff) {
+        put(4, 8, 2);
+        put(8, ifd_offset, 8);
+    } else {
+        put(4, ifd_offset, 4);
+    }
+    put(ifd_offset, fields.size(), count_bytes);
+
+    size_t entry = ifd_offset + count_bytes;
+    for (const TiffField &field : fields) {
+        const size_t elem_bytes = field.type == 3 ? 2 : field.type == 16 ? 8 : 4;
+        put(entry, field.tag, 2);
+        put(entry + 2, field.type, 2);
+        put(entry + 4, field.type == 5 ? field.values.size() / 2 : field.values.size(), offset_bytes);
+        size_t pos = entry + 4 + offset_bytes;
+        if (field.values.size() * elem_bytes > offset_bytes) {
+            const size_t out_of_line = (header.size() + 7) & ~(size_t)7;
+            put(pos, out_of_line, offset_bytes);
+            pos = out_of_line;
+        }
+        for (uint64_t v : field.values) {
+            put(pos, v, elem_bytes);
+            pos += elem_bytes;
+        }
+        entry += entry_bytes;
+    }
+    // The offset of the next IFD is left as zero.
+    return header;
+}
+
 // Note that this is a fairly simpleminded TIFF writer that doesn't
 // do any compression. It would be desirable to (optionally) support using libtiff
-// here instead, which would also allow us to provide a useful implementation
-// for TIFF reading.
+// here instead, which would also allow us to read compressed TIFFs.
 template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
 bool save_tiff(ImageType &im, const std::string &filename) {
     static_assert(!ImageType::has_static_halide_type, "");
@@ -2370,6 +2839,57 @@ struct ImageTypeWithConstElemType {
     using type = decltype(std::declval<ImageType>().template as<typename std::add_const<ElemType>::type, AnyDims>());
 };
 
+// If filename is a .npy, .tmp, or .mat file whose payload is suitably
+// aligned, map it and point im at the payload, and set *mapped to true.
+// Otherwise (or if the file can't be mapped) leave *mapped false, so the
+// caller can fall back to reading it. Returns false only for malformed files.
+template<typename ImageType, CheckFunc check = CheckReturn>
+bool map_image_payload(const std::string &filename, MappedImageFile *mapping, ImageType *im, bool *mapped) {
+    static_assert(!ImageType::has_static_halide_type, "");
+
+    *mapped = false;
+    const std::string ext = get_lowercase_extension(filename);
+    if (ext != "npy" && ext != "tmp" && ext != "mat") {
+        return true;
+    }
+
+    halide_type_t im_type;
+    std::vector<int> extents;
+    size_t offset;
+    {
+        FileOpener f(filename, "rb");
+        if (!check(f.f != nullptr, "File could not be opened for reading")) {
+            return false;
+        }
+        const bool ok = (ext == "npy") ? read_npy_header<check>(f, &im_type, &extents) :
+                        (ext == "tmp") ? read_tmp_header<check>(f, &im_type, &extents) :
+                                         read_mat_header<check>(f, &im_type, &extents);
+        if (!ok) {
+            return false;
+        }
+        offset = (size_t)ftell(f.f);
+    }
+
+    // All three formats store the payload densely in planar order, so
+    // it has exactly the layout of a freshly allocated image. Mappings are
+    // page-aligned, so the elements are naturally aligned iff the offset is.
+    size_t size_in_bytes = im_type.bytes();
+    for (int e : extents) {
+        size_in_bytes *= e;
+    }
+    if (size_in_bytes == 0 || offset % im_type.bytes() != 0 || !mapping->map(filename)) {
+        return true;
+    }
+    if (!check(offset + size_in_bytes <= mapping->size(), "File is too short for its payload")) {
+        mapping->unmap();
+        return false;
+    }
+
+    *im = ImageType(im_type, mapping->data() + offset, extents);
+    *mapped = true;
+    return true;
+}
+
 template<typename ImageType, Internal::CheckFunc check>
 struct ImageIO {
     using ConstImageType = typename ImageTypeWithConstElemType<ImageType, typename ImageType::ElemType>::type;
@@ -2657,6 +3177,38 @@ bool load(const std::string &filename, ImageType *im) {
     return true;
 }
 
+// Load the Image from the given file, mapping the file into memory rather
+// than reading it where possible: for .npy, .tmp, and .mat files, the
+// loaded Image points directly at the pixels in the mapping, so loading
+// takes no time and pages are only read from disk as they are touched.
+// The Image must not outlive the MappedImageFile. Other formats, and files
+// that can't be mapped, are simply read. If output Image has a static type
+// that doesn't match the file, the pixels are converted, as with
+// load_and_convert_image().
+// Returns false upon failure.
+template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
+bool load_mapped(const std::string &filename, MappedImageFile *mapping, ImageType *im) {
+    using DynamicImageType = typename Internal::ImageTypeWithElemType<ImageType, void>::type;
+    DynamicImageType im_d;
+    bool mapped = false;
+    if (!Internal::map_image_payload<DynamicImageType, check>(filename, mapping, &im_d, &mapped)) {
+        return false;
+    }
+    if (!mapped && !load<DynamicImageType, check>(filename, &im_d)) {
+        return false;
+    }
+    if (ImageType::has_static_halide_type) {
+        const halide_type_t expected_type = ImageType::static_halide_type();
+        if (im_d.type() != expected_type) {
+            im_d = ImageTypeConversion::convert_image(im_d, expected_type);
+            mapping->unmap();
+        }
+    }
+    *im = im_d.template as<typename ImageType::ElemType, Internal::AnyDims>();
+    im->set_host_dirty();
+    return true;
+}
+
 // Save the Image in the format associated with the filename's extension.
 // If the format can't represent the Image without losing data, fail.
 // Returns false upon failure.
@@ -2691,6 +3243,58 @@ bool save_query(const std::string &filename, std::set<FormatInfo> *info) {
     return true;
 }
 
+// Get the type and extents of the image in a TIFF file without loading it;
+// the extents are those of the Image that load() would produce.
+// Returns false upon failure.
+template<Internal::CheckFunc check = Internal::CheckReturn>
+bool load_tiff_shape(const std::string &filename, halide_type_t *type, std::vector<int> *extents) {
+    Internal::FileOpener f(filename, "rb");
+    if (!check(f.f != nullptr, "File could not be opened for reading")) {
+        return false;
+    }
+    Internal::TiffLayout layout;
+    if (!Internal::read_tiff_layout<check>(f, &layout)) {
+        return false;
+    }
+    *type = layout.type;
+    *extents = {layout.width, layout.height};
+    if (layout.channels > 1) {
+        extents->push_back(layout.channels);
+    }
+    return true;
+}
+
+// Load the region of a TIFF file with the given origin and size, reading
+// only the parts of the strips or tiles that overlap it, so that pieces of
+// very large images can be loaded without decoding the rest. The Image
+// has its mins at (x, y), and a third dimension for the channels if there
+// is more than one. Only uncompressed TIFFs are supported.
+// Returns false upon failure.
+template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
+bool load_tiff_region(const std::string &filename, int x, int y, int width, int height, ImageType *im) {
+    using DynamicImageType = typename Internal::ImageTypeWithElemType<ImageType, void>::type;
+    Internal::FileOpener f(filename, "rb");
+    if (!check(f.f != nullptr, "File could not be opened for reading")) {
+        return false;
+    }
+    Internal::TiffLayout layout;
+    if (!Internal::read_tiff_layout<check>(f, &layout)) {
+        return false;
+    }
+    DynamicImageType im_d;
+    if (!Internal::read_tiff_region<DynamicImageType, check>(f, layout, x, y, width, height, &im_d)) {
+        return false;
+    }
+    if (ImageType::has_static_halide_type) {
+        const halide_type_t expected_type = ImageType::static_halide_type();
+        if (!check(im_d.type() == expected_type, "Image loaded did not match the expected type")) {
+            return false;
+        }
+    }
+    *im = im_d.template as<typename ImageType::ElemType, Internal::AnyDims>();
+    return true;
+}
+
 // Fancy wrapper to call load() with CheckFail, inferring the return type;
 // this allows you to simply use
 //
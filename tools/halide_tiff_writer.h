@@ -0,0 +1,250 @@
+// A writer for tiled TIFF files that encodes tiles in parallel. This
+// is kept apart from halide_image_io.h so that the basic image loading
+// and saving doesn't depend on threads; users of this header need
+// Halide::ThreadPool as well as Halide::ImageIO.
+
+#ifndef HALIDE_TIFF_WRITER_H
+#define HALIDE_TIFF_WRITER_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "halide_image_io.h"
+#include "halide_thread_pool.h"
+
+namespace Halide {
+namespace Tools {
+
+// Writes an uncompressed tiled TIFF one piece at a time, e.g. as a
+// pipeline produces its output tile by tile, so that the whole image
+// never has to be in memory. Each call to write() takes a region that
+// covers whole TIFF tiles (or reaches the right or bottom edge of the
+// image), and returns once its tiles have been encoded, in parallel on a
+// thread pool, and written to the file. Regions can be written in any
+// order; tiles that are never written read back as zero. Images too big
+// for a classic TIFF are written as BigTIFFs.
+template<Internal::CheckFunc check = Internal::CheckReturn>
+class TiledTiffWriter {
+public:
+    TiledTiffWriter() = default;
+    TiledTiffWriter(const TiledTiffWriter &) = delete;
+    TiledTiffWriter &operator=(const TiledTiffWriter &) = delete;
+
+    ~TiledTiffWriter() {
+        close();
+    }
+
+    // Create the file and write its header. Images with more than one
+    // channel are stored with each channel in separate tiles, as Halide
+    // images usually are. Tile sizes must be multiples of 16. Uses one
+    // thread per core if num_threads is zero.
+    bool open(const std::string &filename, halide_type_t type, int width, int height, int channels = 1,
+              int tile_width = 256, int tile_height = 256, int num_threads = 0) {
+        if (!check(!f, "TiledTiffWriter is already open")) {
+            return false;
+        }
+        if (!check(width > 0 && height > 0 && channels > 0, "Bad TIFF image size")) {
+            return false;
+        }
+        if (!check(tile_width > 0 && tile_height > 0 && tile_width % 16 == 0 && tile_height % 16 == 0,
+                   "TIFF tile sizes must be multiples of 16")) {
+            return false;
+        }
+        const int bits = type.bits;
+        if (!check(type.lanes == 1 && type.code <= halide_type_float &&
+                       (bits == 8 || bits == 16 || bits == 32 || bits == 64) &&
+                       !(type.code == halide_type_float && bits == 8),
+                   "Unsupported image type")) {
+            return false;
+        }
+
+        this->type = type;
+        this->width = width;
+        this->height = height;
+        this->channels = channels;
+        this->tile_width = tile_width;
+        this->tile_height = tile_height;
+        tiles_across = (width + tile_width - 1) / tile_width;
+        tiles_down = (height + tile_height - 1) / tile_height;
+        tile_bytes = (uint64_t)tile_width * tile_height * type.bytes();
+        const uint64_t tiles = (uint64_t)tiles_across * tiles_down * channels;
+
+        // The tiles are all the same size, so where each one goes is
+        // known up front, and they can be written in any order.
+        const bool big_tiff = tiles * (tile_bytes + 16) + 4096 > 0xffffffffULL;
+        static const uint64_t type_code_to_tiff_sample_format[] = {2, 1, 3};
+        std::vector<Internal::TiffField> fields = {
+            {256, 4, {(uint64_t)width}},                                              // ImageWidth
+            {257, 4, {(uint64_t)height}},                                             // ImageLength
+            {258, 3, std::vector<uint64_t>(channels, (uint64_t)bits)},                // BitsPerSample
+            {259, 3, {1}},                                                            // Compression -- none
+            {262, 3, {channels >= 3 ? 2u : 1u}},                                      // PhotometricInterpretation -- black is zero or RGB
+            {277, 3, {(uint64_t)channels}},                                           // SamplesPerPixel
+            {282, 5, {1, 1}},                                                         // XResolution
+            {283, 5, {1, 1}},                                                         // YResolution
+            {284, 3, {channels == 1 ? 1u : 2u}},                                      // PlanarConfiguration -- contig or planar
+            {296, 3, {1}},                                                            // ResolutionUnit -- none
+            {322, 4, {(uint64_t)tile_width}},                                         // TileWidth
+            {323, 4, {(uint64_t)tile_height}},                                        // TileLength
+            {324, uint16_t(big_tiff ? 16 : 4), std::vector<uint64_t>(tiles, 0)},      // TileOffsets
+            {325, uint16_t(big_tiff ? 16 : 4), std::vector<uint64_t>(tiles, tile_bytes)},  // TileByteCounts
+            {339, 3, std::vector<uint64_t>(channels, type_code_to_tiff_sample_format[type.code])},  // SampleFormat
+        };
+        if (channels == 2 || channels > 3) {
+            // ExtraSamples -- unspecified
+            fields.push_back({338, 3, std::vector<uint64_t>(channels == 2 ? 1 : channels - 3, 0)});
+        }
+        data_offset = (Internal::make_tiff_header(fields, big_tiff).size() + 15) & ~(uint64_t)15;
+        for (uint64_t i = 0; i < tiles; i++) {
+            fields[12].values[i] = data_offset + i * tile_bytes;
+        }
+        const std::vector<uint8_t> header = Internal::make_tiff_header(fields, big_tiff);
+        assert(header.size() <= data_offset);
+
+        f = std::make_unique<Internal::FileOpener>(filename, "wb");
+        if (!check(f->f != nullptr, "File could not be opened for writing")) {
+            f.reset();
+            return false;
+        }
+        if (!check(f->write_vector(header), "TIFF write failed")) {
+            f.reset();
+            return false;
+        }
+        end_written = header.size();
+        pool = std::make_unique<ThreadPool<bool>>(num_threads > 0 ? num_threads : ThreadPool<bool>::num_processors_online());
+        return true;
+    }
+
+    // Write the tiles covered by a region of the image, with its mins
+    // giving its position. The region has two dimensions, or three if
+    // the image has more than one channel, in which case it must
+    // include all of them.
+    template<typename ImageType>
+    bool write(ImageType &im) {
+        if (!check(f != nullptr, "TiledTiffWriter is not open")) {
+            return false;
+        }
+        if (!check(im.copy_to_host() == halide_error_code_success, "copy_to_host() failed.")) {
+            return false;
+        }
+        if (!check(im.type() == type, "Image has the wrong type for this TIFF")) {
+            return false;
+        }
+        const bool has_channels = im.dimensions() == 3 && im.dim(2).min() == 0 && im.dim(2).extent() == channels;
+        if (!check(im.dimensions() == 2 ? channels == 1 : has_channels, "Image has the wrong channels for this TIFF")) {
+            return false;
+        }
+        const int x_min = im.dim(0).min(), x_max = x_min + im.dim(0).extent();
+        const int y_min = im.dim(1).min(), y_max = y_min + im.dim(1).extent();
+        if (!check(x_min >= 0 && y_min >= 0 && x_max <= width && y_max <= height &&
+                       x_min % tile_width == 0 && y_min % tile_height == 0 &&
+                       (x_max % tile_width == 0 || x_max == width) &&
+                       (y_max % tile_height == 0 || y_max == height),
+                   "Regions written to a tiled TIFF must cover whole tiles")) {
+            return false;
+        }
+
+        Region region;
+        region.data = (const uint8_t *)im.data();
+        region.x_min = x_min;
+        region.y_min = y_min;
+        for (int d = 0; d < im.dimensions(); d++) {
+            region.stride[d] = im.dim(d).stride();
+        }
+
+        std::vector<std::future<bool>> results;
+        for (int c = 0; c < channels; c++) {
+            for (int ty = y_min / tile_height; ty * tile_height < y_max; ty++) {
+                for (int tx = x_min / tile_width; tx * tile_width < x_max; tx++) {
+                    results.push_back(pool->async([this, &region, c, tx, ty]() {
+                        return write_tile(region, c, tx, ty);
+                    }));
+                }
+            }
+        }
+        bool ok = true;
+        for (auto &r : results) {
+            ok &= r.get();
+        }
+        return check(ok, "TIFF write failed");
+    }
+
+    // Finish the file. Called by the destructor if need be.
+    bool close() {
+        if (!f) {
+            return true;
+        }
+        pool.reset();
+        // Make sure the file is long enough to hold any tiles that were
+        // never written.
+        const uint64_t file_size = data_offset + (uint64_t)tiles_across * tiles_down * channels * tile_bytes;
+        bool ok = true;
+        if (end_written < file_size) {
+            const uint8_t zero = 0;
+            ok = f->seek(file_size - 1) && f->write_bytes(&zero, 1);
+        }
+        ok &= (fflush(f->f) == 0);
+        f.reset();
+        return check(ok, "TIFF write failed");
+    }
+
+private:
+    struct Region {
+        const uint8_t *data;
+        int x_min, y_min;
+        int64_t stride[3] = {0, 0, 0};
+    };
+
+    bool write_tile(const Region &region, int c, int tx, int ty) {
+        // Copy the tile into a dense, zero-padded block, then write it.
+        std::vector<uint8_t> tile(tile_bytes, 0);
+        const size_t elem_bytes = type.bytes();
+        const int x0 = tx * tile_width, y0 = ty * tile_height;
+        const int w = std::min(tile_width, width - x0);
+        const int h = std::min(tile_height, height - y0);
+        for (int y = 0; y < h; y++) {
+            const uint8_t *src = region.data + ((x0 - region.x_min) * region.stride[0] +
+                                                (y0 + y - region.y_min) * region.stride[1] +
+                                                c * region.stride[2]) *
+                                                   (int64_t)elem_bytes;
+            uint8_t *dst = &tile[(size_t)y * tile_width * elem_bytes];
+            if (region.stride[0] == 1) {
+                memcpy(dst, src, w * elem_bytes);
+            } else {
+                for (int x = 0; x < w; x++) {
+                    memcpy(dst + x * elem_bytes, src + x * region.stride[0] * (int64_t)elem_bytes, elem_bytes);
+                }
+            }
+        }
+
+        const uint64_t index = ((uint64_t)c * tiles_down + ty) * tiles_across + tx;
+        const uint64_t offset = data_offset + index * tile_bytes;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!f->seek(offset) || !f->write_vector(tile)) {
+            return false;
+        }
+        end_written = std::max(end_written, offset + tile_bytes);
+        return true;
+    }
+
+    std::unique_ptr<Internal::FileOpener> f;
+    std::unique_ptr<ThreadPool<bool>> pool;
+    // Protects the file and end_written.
+    std::mutex mutex;
+    halide_type_t type;
+    int width = 0, height = 0, channels = 0;
+    int tile_width = 0, tile_height = 0;
+    int tiles_across = 0, tiles_down = 0;
+    uint64_t tile_bytes = 0, data_offset = 0, end_written = 0;
+};
+
+}  // namespace Tools
+}  // namespace Halide
+
+#endif  // HALIDE_TIFF_WRITER_H
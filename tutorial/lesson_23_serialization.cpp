@@ -27,6 +27,7 @@
 
 #include "Halide.h"
 #include <algorithm>
+#include <cmath>
 #include <stdio.h>
 using namespace Halide;
 
@@ -123,6 +124,52 @@ int main(int argc, char **argv) {
         Pipeline deserialized = deserialize_pipeline(data, params);
     }
 
+    // Pipelines can also contain Buffers, like lookup tables or weights, whose contents are stored
+    // along with the pipeline. When those are large, copying them all into memory when the pipeline
+    // is loaded can take longer than everything else put together.
+    {
+        // Lets build a pipeline that applies a tone curve, stored in a lookup table, to the blurred image
+        Buffer<uint8_t> curve(256, "curve");
+        for (int i = 0; i < 256; i++) {
+            curve(i) = (uint8_t)(255.0f * std::sqrt(i / 255.0f));
+        }
+
+        std::map<std::string, Parameter> params = deserialize_parameters("blur.hlpipe");
+        Pipeline blur_pipeline = deserialize_pipeline("blur.hlpipe", params);
+        Func blurred = blur_pipeline.outputs()[0];
+        Func toned("toned");
+        toned(x, y, c) = curve(cast<int>(blurred(x, y, c)));
+
+        // We can ask for the contents of any buffer with at least a given number of bytes to be
+        // stored in a separate file (relative to the directory of the pipeline), which is handy when
+        // the same weights are shared by several pipelines.
+        serialize_pipeline(Pipeline(toned), "toned.hlpipe", "toned.weights", 64);
+    }
+
+    {
+        Buffer<uint8_t> rgb_image = Halide::Tools::load_image("images/rgb.png");
+        std::map<std::string, Parameter> params = deserialize_parameters("toned.hlpipe");
+        params.at("input").set_buffer(rgb_image);
+
+        // Loading the pipeline this way memory-maps the files, rather than reading them, and uses
+        // the contents of the buffers in place. Only the parts of the buffers that the pipeline
+        // actually touches are ever read from disk. The files stay mapped for as long as the pipeline's
+        // buffers are in use.
+        Pipeline toned_pipeline = deserialize_pipeline_mapped("toned.hlpipe", params);
+        Buffer<uint8_t> result = toned_pipeline.realize({rgb_image.width(), rgb_image.height(), 3});
+
+        // Loading the pipeline the usual way copies the buffers instead, with the same results.
+        Pipeline copied_pipeline = deserialize_pipeline("toned.hlpipe", params);
+        Buffer<uint8_t> copied_result = copied_pipeline.realize({rgb_image.width(), rgb_image.height(), 3});
+        result.for_each_element([&](int xi, int yi, int ci) {
+            if (result(xi, yi, ci) != copied_result(xi, yi, ci)) {
+                printf("result(%d, %d, %d) = %d instead of %d\n",
+                       xi, yi, ci, result(xi, yi, ci), copied_result(xi, yi, ci));
+                exit(1);
+            }
+        });
+    }
+
     printf("Success!\n");
     return 0;
 }